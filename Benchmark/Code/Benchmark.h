@@ -0,0 +1,32 @@
+//==============================================================================================================================================================================
+/// \file
+/// \brief     serialization benchmark application interface
+/// \copyright Copyright (c) Gustavo Goedert. All rights reserved.
+//==============================================================================================================================================================================
+#pragma once
+
+#include "lApplication.h"
+
+CLASS_PTR_DEF(Benchmark);
+
+/// Benchmark class, a headless application that owns the benchmark scenes
+class Benchmark : public Lumen::Application
+{
+    CLASS_NO_DEFAULT_CTOR(Benchmark);
+    CLASS_NO_COPY_MOVE(Benchmark);
+    CLASS_PTR_MAKER(Benchmark);
+
+public:
+    /// get window size, there is no window
+    void GetWindowSize(int &width, int &height) override { width = 0; height = 0; }
+
+    /// not used
+    void New() override {}
+
+    /// not used
+    void Open() override {}
+
+private:
+    /// constructor
+    explicit Benchmark(std::string_view name, const int version) : Lumen::Application() {}
+};
@@ -0,0 +1,177 @@
+//==============================================================================================================================================================================
+/// \file
+/// \brief     synthetic benchmark components
+/// \copyright Copyright (c) Gustavo Goedert. All rights reserved.
+//==============================================================================================================================================================================
+
+#include "BenchmarkComponents.h"
+
+#include "lSceneManager.h"
+
+DEFINE_COMPONENT_TYPEINFO(BenchmarkBody);
+
+/// constructs a benchmark body
+BenchmarkBody::BenchmarkBody(const Lumen::EntityWeakPtr &entity) :
+    Component(Type(), Name(), entity) {}
+
+/// creates a smart pointer version of the benchmark body component
+Lumen::ComponentPtr BenchmarkBody::MakePtr(const Lumen::EngineWeakPtr &engine, const Lumen::EntityWeakPtr &entity)
+{
+    return Lumen::ComponentPtr(new BenchmarkBody(entity));
+}
+
+/// serialize
+void BenchmarkBody::Serialize(Lumen::Serialized::Type &out, bool packed) const
+{
+    Lumen::Serialized::SerializeFields(out, packed, *this, SerializedFields());
+
+    // if empty, set to object
+    if (out.empty())
+    {
+        out = Lumen::Serialized::Type::object();
+    }
+}
+
+/// deserialize
+void BenchmarkBody::Deserialize(const Lumen::Serialized::Type &in, bool packed)
+{
+    Lumen::Serialized::DeserializeFields(in, packed, *this, SerializedFields(), "BenchmarkBody");
+}
+
+/// write the text data of a body with values derived from seed
+void BenchmarkBody::Synthesize(Lumen::Serialized::Type &out, size_t seed)
+{
+    BenchmarkBody body(Lumen::EntityWeakPtr {});
+    float value = static_cast<float>(seed % 1000) * 0.01f;
+    body.mVelocity = Lumen::Math::Vector3(value, -value, value * 0.5f);
+    body.mColor = Lumen::Math::Vector4(value * 0.1f, 0.5f, 1.f - value * 0.1f, 1.f);
+    body.mLocal = Lumen::Math::Matrix44(1.f, 0.f, 0.f, 0.f, 0.f, 1.f, 0.f, 0.f, 0.f, 0.f, 1.f, 0.f, value, value * 2.f, value * 3.f, 1.f);
+    body.Serialize(out, false);
+}
+
+//==============================================================================================================================================================================
+
+DEFINE_COMPONENT_TYPEINFO(BenchmarkTag);
+
+/// constructs a benchmark tag
+BenchmarkTag::BenchmarkTag(const Lumen::EntityWeakPtr &entity) :
+    Component(Type(), Name(), entity) {}
+
+/// creates a smart pointer version of the benchmark tag component
+Lumen::ComponentPtr BenchmarkTag::MakePtr(const Lumen::EngineWeakPtr &engine, const Lumen::EntityWeakPtr &entity)
+{
+    return Lumen::ComponentPtr(new BenchmarkTag(entity));
+}
+
+/// serialize
+void BenchmarkTag::Serialize(Lumen::Serialized::Type &out, bool packed) const
+{
+    Lumen::Serialized::SerializeFields(out, packed, *this, SerializedFields());
+
+    // if empty, set to object
+    if (out.empty())
+    {
+        out = Lumen::Serialized::Type::object();
+    }
+}
+
+/// deserialize
+void BenchmarkTag::Deserialize(const Lumen::Serialized::Type &in, bool packed)
+{
+    Lumen::Serialized::DeserializeFields(in, packed, *this, SerializedFields(), "BenchmarkTag");
+}
+
+/// write the text data of a tag with values derived from seed
+void BenchmarkTag::Synthesize(Lumen::Serialized::Type &out, size_t seed)
+{
+    BenchmarkTag tag(Lumen::EntityWeakPtr {});
+    tag.mLayer = static_cast<int>(seed % 32) + 1;
+    tag.mWeight = static_cast<float>(seed % 100) * 0.25f + 0.5f;
+    tag.mVisible = (seed % 7) != 0;
+    tag.Serialize(out, false);
+}
+
+//==============================================================================================================================================================================
+
+DEFINE_COMPONENT_TYPEINFO(BenchmarkBounds);
+
+/// constructs benchmark bounds
+BenchmarkBounds::BenchmarkBounds(const Lumen::EntityWeakPtr &entity) :
+    Component(Type(), Name(), entity) {}
+
+/// creates a smart pointer version of the benchmark bounds component
+Lumen::ComponentPtr BenchmarkBounds::MakePtr(const Lumen::EngineWeakPtr &engine, const Lumen::EntityWeakPtr &entity)
+{
+    return Lumen::ComponentPtr(new BenchmarkBounds(entity));
+}
+
+/// serialize
+void BenchmarkBounds::Serialize(Lumen::Serialized::Type &out, bool packed) const
+{
+    Lumen::Serialized::SerializeFields(out, packed, *this, SerializedFields());
+
+    // if empty, set to object
+    if (out.empty())
+    {
+        out = Lumen::Serialized::Type::object();
+    }
+}
+
+/// deserialize
+void BenchmarkBounds::Deserialize(const Lumen::Serialized::Type &in, bool packed)
+{
+    Lumen::Serialized::DeserializeFields(in, packed, *this, SerializedFields(), "BenchmarkBounds");
+}
+
+/// write the text data of bounds with values derived from seed
+void BenchmarkBounds::Synthesize(Lumen::Serialized::Type &out, size_t seed)
+{
+    BenchmarkBounds bounds(Lumen::EntityWeakPtr {});
+    float extent = static_cast<float>(seed % 50) * 0.1f + 0.5f;
+    bounds.mMin = Lumen::Math::Vector3(-extent, -extent * 2.f, -extent);
+    bounds.mMax = Lumen::Math::Vector3(extent, extent * 2.f, extent);
+    bounds.Serialize(out, false);
+}
+
+//==============================================================================================================================================================================
+
+DEFINE_COMPONENT_TYPEINFO(BenchmarkLight);
+
+/// constructs a benchmark light
+BenchmarkLight::BenchmarkLight(const Lumen::EntityWeakPtr &entity) :
+    Component(Type(), Name(), entity) {}
+
+/// creates a smart pointer version of the benchmark light component
+Lumen::ComponentPtr BenchmarkLight::MakePtr(const Lumen::EngineWeakPtr &engine, const Lumen::EntityWeakPtr &entity)
+{
+    return Lumen::ComponentPtr(new BenchmarkLight(entity));
+}
+
+/// serialize
+void BenchmarkLight::Serialize(Lumen::Serialized::Type &out, bool packed) const
+{
+    Lumen::Serialized::SerializeFields(out, packed, *this, SerializedFields());
+
+    // if empty, set to object
+    if (out.empty())
+    {
+        out = Lumen::Serialized::Type::object();
+    }
+}
+
+/// deserialize
+void BenchmarkLight::Deserialize(const Lumen::Serialized::Type &in, bool packed)
+{
+    Lumen::Serialized::DeserializeFields(in, packed, *this, SerializedFields(), "BenchmarkLight");
+}
+
+/// write the text data of a light with values derived from seed
+void BenchmarkLight::Synthesize(Lumen::Serialized::Type &out, size_t seed)
+{
+    BenchmarkLight light(Lumen::EntityWeakPtr {});
+    float value = static_cast<float>(seed % 100) * 0.01f;
+    light.mColor = Lumen::Math::Vector4(1.f, value, 1.f - value, 1.f);
+    light.mIntensity = value * 4.f + 0.25f;
+    light.mRange = static_cast<float>(seed % 20) + 5.f;
+    light.Serialize(out, false);
+}
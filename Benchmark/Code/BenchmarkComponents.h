@@ -0,0 +1,176 @@
+//==============================================================================================================================================================================
+/// \file
+/// \brief     synthetic benchmark components interface
+/// \copyright Copyright (c) Gustavo Goedert. All rights reserved.
+//==============================================================================================================================================================================
+#pragma once
+
+#include "lComponent.h"
+
+/// BenchmarkBody class, float block heavy component
+class BenchmarkBody : public Lumen::Component
+{
+    CLASS_NO_DEFAULT_CTOR(BenchmarkBody);
+    CLASS_NO_COPY_MOVE(BenchmarkBody);
+    COMPONENT_TYPEINFO;
+
+public:
+    /// serialize
+    void Serialize(Lumen::Serialized::Type &out, bool packed) const override;
+
+    /// deserialize
+    void Deserialize(const Lumen::Serialized::Type &in, bool packed) override;
+
+    /// only changed by deserialize
+    [[nodiscard]] bool TracksChanges() const override { return true; }
+
+    /// write the text data of a body with values derived from seed
+    static void Synthesize(Lumen::Serialized::Type &out, size_t seed);
+
+private:
+    /// constructs a benchmark body
+    explicit BenchmarkBody(const Lumen::EntityWeakPtr &entity);
+
+    /// creates a smart pointer version of the benchmark body component
+    static Lumen::ComponentPtr MakePtr(const Lumen::EngineWeakPtr &engine, const Lumen::EntityWeakPtr &entity);
+
+    /// serialized fields
+    SERIALIZED_FIELDS(
+        SERIALIZED_FIELD(BenchmarkBody, mVelocity, "Velocity", Lumen::Math::Vector3(0.f, 0.f, 0.f)),
+        SERIALIZED_FIELD(BenchmarkBody, mColor, "Color", Lumen::Math::Vector4(1.f, 1.f, 1.f, 1.f)),
+        SERIALIZED_FIELD(BenchmarkBody, mLocal, "Local", Lumen::Math::Matrix44(1.f, 0.f, 0.f, 0.f, 0.f, 1.f, 0.f, 0.f, 0.f, 0.f, 1.f, 0.f, 0.f, 0.f, 0.f, 1.f)));
+
+    /// velocity
+    Lumen::Math::Vector3 mVelocity;
+
+    /// color
+    Lumen::Math::Vector4 mColor;
+
+    /// local matrix
+    Lumen::Math::Matrix44 mLocal;
+};
+
+/// BenchmarkTag class, scalar value component
+class BenchmarkTag : public Lumen::Component
+{
+    CLASS_NO_DEFAULT_CTOR(BenchmarkTag);
+    CLASS_NO_COPY_MOVE(BenchmarkTag);
+    COMPONENT_TYPEINFO;
+
+public:
+    /// serialize
+    void Serialize(Lumen::Serialized::Type &out, bool packed) const override;
+
+    /// deserialize
+    void Deserialize(const Lumen::Serialized::Type &in, bool packed) override;
+
+    /// only changed by deserialize
+    [[nodiscard]] bool TracksChanges() const override { return true; }
+
+    /// write the text data of a tag with values derived from seed
+    static void Synthesize(Lumen::Serialized::Type &out, size_t seed);
+
+private:
+    /// constructs a benchmark tag
+    explicit BenchmarkTag(const Lumen::EntityWeakPtr &entity);
+
+    /// creates a smart pointer version of the benchmark tag component
+    static Lumen::ComponentPtr MakePtr(const Lumen::EngineWeakPtr &engine, const Lumen::EntityWeakPtr &entity);
+
+    /// serialized fields
+    SERIALIZED_FIELDS(
+        SERIALIZED_FIELD(BenchmarkTag, mLayer, "Layer", 0),
+        SERIALIZED_FIELD(BenchmarkTag, mWeight, "Weight", 0.f),
+        SERIALIZED_FIELD(BenchmarkTag, mVisible, "Visible", true));
+
+    /// layer
+    int mLayer = 0;
+
+    /// weight
+    float mWeight = 0.f;
+
+    /// visible flag
+    bool mVisible = true;
+};
+
+/// BenchmarkBounds class, vector pair component
+class BenchmarkBounds : public Lumen::Component
+{
+    CLASS_NO_DEFAULT_CTOR(BenchmarkBounds);
+    CLASS_NO_COPY_MOVE(BenchmarkBounds);
+    COMPONENT_TYPEINFO;
+
+public:
+    /// serialize
+    void Serialize(Lumen::Serialized::Type &out, bool packed) const override;
+
+    /// deserialize
+    void Deserialize(const Lumen::Serialized::Type &in, bool packed) override;
+
+    /// only changed by deserialize
+    [[nodiscard]] bool TracksChanges() const override { return true; }
+
+    /// write the text data of bounds with values derived from seed
+    static void Synthesize(Lumen::Serialized::Type &out, size_t seed);
+
+private:
+    /// constructs benchmark bounds
+    explicit BenchmarkBounds(const Lumen::EntityWeakPtr &entity);
+
+    /// creates a smart pointer version of the benchmark bounds component
+    static Lumen::ComponentPtr MakePtr(const Lumen::EngineWeakPtr &engine, const Lumen::EntityWeakPtr &entity);
+
+    /// serialized fields
+    SERIALIZED_FIELDS(
+        SERIALIZED_FIELD(BenchmarkBounds, mMin, "Min", Lumen::Math::Vector3(0.f, 0.f, 0.f)),
+        SERIALIZED_FIELD(BenchmarkBounds, mMax, "Max", Lumen::Math::Vector3(0.f, 0.f, 0.f)));
+
+    /// minimum corner
+    Lumen::Math::Vector3 mMin;
+
+    /// maximum corner
+    Lumen::Math::Vector3 mMax;
+};
+
+/// BenchmarkLight class, mixed float block and scalar component
+class BenchmarkLight : public Lumen::Component
+{
+    CLASS_NO_DEFAULT_CTOR(BenchmarkLight);
+    CLASS_NO_COPY_MOVE(BenchmarkLight);
+    COMPONENT_TYPEINFO;
+
+public:
+    /// serialize
+    void Serialize(Lumen::Serialized::Type &out, bool packed) const override;
+
+    /// deserialize
+    void Deserialize(const Lumen::Serialized::Type &in, bool packed) override;
+
+    /// only changed by deserialize
+    [[nodiscard]] bool TracksChanges() const override { return true; }
+
+    /// write the text data of a light with values derived from seed
+    static void Synthesize(Lumen::Serialized::Type &out, size_t seed);
+
+private:
+    /// constructs a benchmark light
+    explicit BenchmarkLight(const Lumen::EntityWeakPtr &entity);
+
+    /// creates a smart pointer version of the benchmark light component
+    static Lumen::ComponentPtr MakePtr(const Lumen::EngineWeakPtr &engine, const Lumen::EntityWeakPtr &entity);
+
+    /// serialized fields
+    SERIALIZED_FIELDS(
+        SERIALIZED_FIELD(BenchmarkLight, mColor, "Color", Lumen::Math::Vector4(1.f, 1.f, 1.f, 1.f)),
+        SERIALIZED_FIELD(BenchmarkLight, mIntensity, "Intensity", 1.f),
+        SERIALIZED_FIELD(BenchmarkLight, mRange, "Range", 10.f));
+
+    /// color
+    Lumen::Math::Vector4 mColor;
+
+    /// intensity
+    float mIntensity = 1.f;
+
+    /// range
+    float mRange = 10.f;
+};
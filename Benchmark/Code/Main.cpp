@@ -0,0 +1,582 @@
+//==============================================================================================================================================================================
+/// \file
+/// \brief     serialization benchmark entry point
+/// \copyright Copyright (c) Gustavo Goedert. All rights reserved.
+//==============================================================================================================================================================================
+
+#include "Benchmark.h"
+#include "BenchmarkComponents.h"
+#include "MemoryFileSystem.h"
+
+#include "lEntity.h"
+#include "lScene.h"
+#include "lSceneManager.h"
+#include "lTransform.h"
+#include "lThreadPool.h"
+#include "lAsyncIo.h"
+#include "lFolderFileSystem.h"
+#ifdef __linux__
+#include "lIoUringBackend.h"
+#endif
+#if defined(__linux__) && defined(EDITOR)
+#include "lFolderWatcher.h"
+#endif
+
+/// \cond
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#if defined(_WIN32)
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+/// \endcond
+
+using namespace Lumen;
+
+/// number of global allocations
+static std::atomic<size_t> gAllocationCount = 0;
+
+/// count every global allocation
+void *operator new(size_t size)
+{
+    gAllocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void *ptr = std::malloc(size ? size : 1))
+    {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+/// release a global allocation
+void operator delete(void *ptr) noexcept
+{
+    std::free(ptr);
+}
+
+/// release a sized global allocation
+void operator delete(void *ptr, size_t) noexcept
+{
+    std::free(ptr);
+}
+
+/// text scene path
+constexpr std::string_view cTextScenePath = "Text/Bench.lumen";
+
+/// packed scene path
+constexpr std::string_view cPackedScenePath = "Packed/Bench.lumen";
+
+/// packed scene path on the unpacked mount, packed by its extension like an editor scene on the folder file system
+constexpr std::string_view cFolderPackedScenePath = "Text/Bench.lumenpack";
+
+/// text scene path on the folder file system
+constexpr std::string_view cDiskTextScenePath = "Folder/Bench.lumen";
+
+/// packed scene path on the folder file system, packed by its extension
+constexpr std::string_view cDiskPackedScenePath = "Folder/Bench.lumenpack";
+
+/// packed serialized data path
+constexpr std::string_view cPackedDataPath = "Packed/Bench.cbor";
+
+/// chunk size of the async reads
+constexpr size_t cReadChunkSize = 64 * 1024;
+
+/// options struct, the shape of the synthetic scene and how long to measure
+struct Options
+{
+    /// number of entities
+    size_t mEntityCount = 10000;
+
+    /// timed iterations of each measurement
+    size_t mIterations = 10;
+
+    /// components on each entity
+    size_t mComponentCount = 2;
+
+    /// levels of each hierarchy tree, one is a flat scene
+    size_t mDepth = 4;
+
+    /// children of each parent
+    size_t mFanOut = 4;
+};
+
+/// component synthesizer struct, writes the text data of one benchmark component type
+struct ComponentSynthesizer
+{
+    /// get the component name
+    std::string_view (*mName)();
+
+    /// write the text data of a component with values derived from seed
+    void (*mSynthesize)(Serialized::Type &out, size_t seed);
+};
+
+/// benchmark component types, an entity with M components carries the first M
+constexpr std::array<ComponentSynthesizer, 4> cComponentSynthesizers = { {
+    { BenchmarkBody::Name, BenchmarkBody::Synthesize },
+    { BenchmarkTag::Name, BenchmarkTag::Synthesize },
+    { BenchmarkBounds::Name, BenchmarkBounds::Synthesize },
+    { BenchmarkLight::Name, BenchmarkLight::Synthesize } } };
+
+/// peak resident set size of the process in bytes
+static size_t PeakResidentBytes()
+{
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters = {};
+    GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters));
+    return counters.PeakWorkingSetSize;
+#elif defined(__APPLE__)
+    rusage usage = {};
+    getrusage(RUSAGE_SELF, &usage);
+    return static_cast<size_t>(usage.ru_maxrss);
+#else
+    rusage usage = {};
+    getrusage(RUSAGE_SELF, &usage);
+    return static_cast<size_t>(usage.ru_maxrss) * 1024;
+#endif
+}
+
+/// scratch folder on disk the folder file system is mounted on
+static std::filesystem::path ScratchFolder()
+{
+    return std::filesystem::temp_directory_path() / "LumenBenchmark";
+}
+
+/// size of a file in bytes
+static size_t FileBytes(const std::filesystem::path &path)
+{
+    Id::Type file = FileSystem::Open(path, false, true);
+    if (file == Id::Invalid)
+    {
+        return 0;
+    }
+    size_t size = FileSystem::Size(file);
+    FileSystem::Close(file);
+    return size;
+}
+
+/// build a synthetic text scene document
+static Serialized::Type SynthesizeScene(size_t entityCount, size_t componentCount)
+{
+    Serialized::Type scene = Serialized::Type::object();
+
+    // transforms are written by a detached transform, so their keys come from the transform field table
+    TransformPtr transformWriter = Transform::MakePtr({});
+    for (size_t i = 0; i < entityCount; ++i)
+    {
+        float value = static_cast<float>(i % 1000);
+
+        // transform
+        Serialized::Type transform;
+        transformWriter->SetPosition(Math::Vector3(value, value * 0.5f, -value));
+        transformWriter->SetRotation(Math::Quaternion(0.f, 0.38268343f, 0.f, 0.92387953f));
+        transformWriter->SetScale(Math::Vector3(1.f, 2.f, 1.f));
+        transformWriter->Serialize(transform, false);
+
+        // components
+        Serialized::Type components = Serialized::Type::object();
+        for (size_t c = 0; c < componentCount; ++c)
+        {
+            cComponentSynthesizers[c].mSynthesize(components[std::string(cComponentSynthesizers[c].mName())], i);
+        }
+
+        Serialized::Type entity;
+        Serialized::SerializeValue(entity, false, Serialized::cTransformToken, Serialized::cTransformTokenPacked, transform);
+        Serialized::SerializeValue(entity, false, Serialized::cComponentsToken, Serialized::cComponentsTokenPacked, components);
+        scene[std::format("Entity{}", i)] = std::move(entity);
+    }
+    return scene;
+}
+
+/// number of entities in each hierarchy tree
+static size_t TreeSize(const Options &options)
+{
+    size_t size = 1;
+    for (size_t level = 1, width = 1; level < options.mDepth; ++level)
+    {
+        width *= options.mFanOut;
+        size += width;
+    }
+    return size;
+}
+
+/// parent the entities of a scene into trees, the scene formats do not store parents so this follows every load
+/// entities are numbered breadth first in each tree, so the children of tree entity j are j * fan-out + 1 to j * fan-out + fan-out
+static void LinkHierarchy(const Scene &scene, const Options &options)
+{
+    if (options.mDepth < 2)
+    {
+        return;
+    }
+    size_t treeSize = TreeSize(options);
+    for (size_t i = 0; i < scene.EntityCount(); ++i)
+    {
+        size_t local = i % treeSize;
+        if (local != 0)
+        {
+            EntityPtr parent = scene.GetEntity(i - local + (local - 1) / options.mFanOut).lock();
+            scene.GetEntity(i).lock()->Transform().lock()->SetParent(parent->Transform());
+        }
+    }
+}
+
+/// move entities of a scene so they are saved again, starting at offset and wrapping around
+static void TouchEntities(const Scene &scene, size_t count, size_t offset = 0)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        scene.GetEntity((offset + i) % scene.EntityCount()).lock()->Transform().lock()->Translate(1.f, 0.f, 0.f);
+    }
+}
+
+/// run body once to warm up, then time it over iterations and report throughput, allocations and peak memory
+template<typename Body>
+static void Measure(std::string_view name, size_t iterations, size_t bytes, size_t entities, Body &&body)
+{
+    body();
+    size_t allocations = gAllocationCount.load(std::memory_order_relaxed);
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; ++i)
+    {
+        body();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / static_cast<double>(iterations);
+    allocations = (gAllocationCount.load(std::memory_order_relaxed) - allocations) / iterations;
+
+    std::cout << std::format("{:<34} {:>9.3f} ms {:>10.1f} MB/s {:>12.0f} entities/s {:>10} allocs {:>8.1f} MB peak\n",
+        name, seconds * 1000.0, static_cast<double>(bytes) / (1024.0 * 1024.0) / seconds, static_cast<double>(entities) / seconds,
+        allocations, static_cast<double>(PeakResidentBytes()) / (1024.0 * 1024.0));
+}
+
+/// run the benchmarks
+static void Run(Application &application, const Options &options)
+{
+    size_t entityCount = options.mEntityCount;
+    size_t iterations = options.mIterations;
+    std::cout << std::format("{} entities, {} components each, hierarchy depth {} fan-out {}, {} iterations, {} worker threads\n\n",
+        entityCount, options.mComponentCount, options.mDepth, options.mFanOut, iterations, ThreadPool::ThreadCount());
+
+    // text serialized data
+    Serialized::Type document = SynthesizeScene(entityCount, options.mComponentCount);
+    FileSystem::WriteSerializedData(cTextScenePath, document);
+    size_t textBytes = FileBytes(cTextScenePath);
+    Measure("WriteSerializedData text", iterations, textBytes, entityCount, [&]()
+    {
+        FileSystem::WriteSerializedData(cTextScenePath, document);
+    });
+    Measure("ReadSerializedData text", iterations, textBytes, entityCount, [&]()
+    {
+        Serialized::Type data;
+        FileSystem::ReadSerializedData(cTextScenePath, data);
+    });
+
+    // text scene
+    ScenePtr textScene = Scene::MakePtr(application, cTextScenePath);
+    Measure("Scene::Load text", iterations, textBytes, entityCount, [&]()
+    {
+        textScene->Release();
+        textScene->Load();
+        LinkHierarchy(*textScene, options);
+    });
+    Measure("Scene::Save text", iterations, textBytes, entityCount, [&]()
+    {
+        TouchEntities(*textScene, entityCount);
+        textScene->Save();
+    });
+
+    // in memory scene documents
+    Serialized::Type textData;
+    textScene->Serialize(textData, false);
+    Measure("Scene::Serialize text", iterations, textBytes, entityCount, [&]()
+    {
+        Serialized::Type data;
+        textScene->Serialize(data, false);
+    });
+    Measure("Scene::Deserialize text", iterations, textBytes, entityCount, [&]()
+    {
+        textScene->Release();
+        textScene->Deserialize(textData, false);
+        LinkHierarchy(*textScene, options);
+    });
+    Serialized::Type packedData;
+    textScene->Serialize(packedData, true);
+    size_t packedDataBytes = Serialized::Type::to_cbor(packedData).size();
+    Measure("Scene::Serialize packed", iterations, packedDataBytes, entityCount, [&]()
+    {
+        Serialized::Type data;
+        textScene->Serialize(data, true);
+    });
+    Measure("Scene::Deserialize packed", iterations, packedDataBytes, entityCount, [&]()
+    {
+        textScene->Release();
+        textScene->Deserialize(packedData, true);
+        LinkHierarchy(*textScene, options);
+    });
+
+    // world matrices walk up to the root of each tree
+    Measure("Transform::GetWorldMatrix", iterations, 0, entityCount, [&]()
+    {
+        Math::Matrix44 world;
+        for (size_t i = 0; i < textScene->EntityCount(); ++i)
+        {
+            textScene->GetEntity(i).lock()->Transform().lock()->GetWorldMatrix(world);
+        }
+    });
+
+    // packed serialized data
+    Measure("WriteSerializedData packed", iterations, packedDataBytes, entityCount, [&]()
+    {
+        FileSystem::WriteSerializedData(cPackedDataPath, packedData);
+    });
+    Measure("ReadSerializedData packed", iterations, packedDataBytes, entityCount, [&]()
+    {
+        Serialized::Type data;
+        FileSystem::ReadSerializedData(cPackedDataPath, data);
+    });
+
+    // packed scene, converted from a plain cbor scene by loading and saving it
+    textScene->Release();
+    FileSystem::WriteSerializedData(cPackedScenePath, packedData);
+    ScenePtr packedScene = Scene::MakePtr(application, cPackedScenePath);
+    packedScene->Load();
+    LinkHierarchy(*packedScene, options);
+    packedScene->Save();
+    size_t packedBytes = FileBytes(cPackedScenePath);
+    Measure("Scene::Load packed", iterations, packedBytes, entityCount, [&]()
+    {
+        packedScene->Release();
+        packedScene->Load();
+        LinkHierarchy(*packedScene, options);
+    });
+    Measure("Scene::Save packed", iterations, packedBytes, entityCount, [&]()
+    {
+        TouchEntities(*packedScene, entityCount);
+        packedScene->Save();
+    });
+
+    // incremental packed saves, a few entities change between saves and are appended to the journal
+    size_t touchCount = std::max<size_t>(entityCount / 1000, 1);
+    size_t touchOffset = 0;
+    Measure("Scene::Save packed incremental", iterations, packedBytes, touchCount, [&]()
+    {
+        TouchEntities(*packedScene, touchCount, touchOffset);
+        touchOffset += touchCount;
+        packedScene->Save();
+    });
+    std::cout << std::format("packed scene journal {} bytes\n", FileBytes(std::format("{}.journal", cPackedScenePath)));
+
+    // the same scene stored packed on the unpacked mount, chosen by its extension
+    packedScene->Release();
+    ScenePtr folderPackedScene = Scene::MakePtr(application, cFolderPackedScenePath);
+    FileSystem::WriteBinaryData(cFolderPackedScenePath, Serialized::Type::to_cbor(packedData));
+    folderPackedScene->Load();
+    LinkHierarchy(*folderPackedScene, options);
+    folderPackedScene->Save();
+    size_t folderPackedBytes = FileBytes(cFolderPackedScenePath);
+    Measure("Scene::Load packed by extension", iterations, folderPackedBytes, entityCount, [&]()
+    {
+        folderPackedScene->Release();
+        folderPackedScene->Load();
+        LinkHierarchy(*folderPackedScene, options);
+    });
+    touchOffset = 0;
+    Measure("Scene::Save extension incremental", iterations, folderPackedBytes, touchCount, [&]()
+    {
+        TouchEntities(*folderPackedScene, touchCount, touchOffset);
+        touchOffset += touchCount;
+        folderPackedScene->Save();
+    });
+    folderPackedScene->Release();
+    packedScene->Load();
+    LinkHierarchy(*packedScene, options);
+
+    // async reads of the packed scene in chunks, adjacent chunks are merged into larger reads
+    std::vector<byte> readBuffer(packedBytes);
+    std::vector<Id::Type> reads;
+    Measure("AsyncIo::Read packed", iterations, packedBytes, entityCount, [&]()
+    {
+        reads.clear();
+        for (size_t offset = 0; offset < packedBytes; offset += cReadChunkSize)
+        {
+            std::span<byte> chunk = std::span<byte>(readBuffer).subspan(offset, std::min(cReadChunkSize, packedBytes - offset));
+            reads.push_back(AsyncIo::Read(cPackedScenePath, offset, chunk));
+        }
+        for (Id::Type read : reads)
+        {
+            AsyncIo::Wait(read);
+        }
+    });
+
+    // compressed packed scene, throughput is measured against the uncompressed size
+    FileSystem::SetCompressPacked(true);
+    TouchEntities(*packedScene, entityCount);
+    packedScene->Save();
+    std::cout << std::format("packed scene {} bytes, compressed {} bytes\n", packedBytes, FileBytes(cPackedScenePath));
+    Measure("Scene::Load packed compressed", iterations, packedBytes, entityCount, [&]()
+    {
+        packedScene->Release();
+        packedScene->Load();
+        LinkHierarchy(*packedScene, options);
+    });
+    Measure("Scene::Save packed compressed", iterations, packedBytes, entityCount, [&]()
+    {
+        TouchEntities(*packedScene, entityCount);
+        packedScene->Save();
+    });
+    FileSystem::SetCompressPacked(false);
+    packedScene->Release();
+
+    // scenes on disk through the folder file system, the folder watcher reports the writes while they are measured
+#if defined(__linux__) && defined(EDITOR)
+    Linux::FolderWatcherPtr watcher = Linux::FolderWatcher::MakePtr(ScratchFolder());
+    watcher->Start();
+#endif
+    ScenePtr diskTextScene = Scene::MakePtr(application, cDiskTextScenePath);
+    diskTextScene->Deserialize(packedData, true);
+    LinkHierarchy(*diskTextScene, options);
+    diskTextScene->Save();
+    size_t diskTextBytes = FileBytes(cDiskTextScenePath);
+    Measure("Scene::Save folder text", iterations, diskTextBytes, entityCount, [&]()
+    {
+        TouchEntities(*diskTextScene, entityCount);
+        diskTextScene->Save();
+    });
+    Measure("Scene::Load folder text", iterations, diskTextBytes, entityCount, [&]()
+    {
+        diskTextScene->Release();
+        diskTextScene->Load();
+        LinkHierarchy(*diskTextScene, options);
+    });
+    diskTextScene->Release();
+    ScenePtr diskPackedScene = Scene::MakePtr(application, cDiskPackedScenePath);
+    diskPackedScene->Deserialize(packedData, true);
+    LinkHierarchy(*diskPackedScene, options);
+    diskPackedScene->Save();
+    size_t diskPackedBytes = FileBytes(cDiskPackedScenePath);
+    Measure("Scene::Load folder packed", iterations, diskPackedBytes, entityCount, [&]()
+    {
+        diskPackedScene->Release();
+        diskPackedScene->Load();
+        LinkHierarchy(*diskPackedScene, options);
+    });
+    touchOffset = 0;
+    Measure("Scene::Save folder incremental", iterations, diskPackedBytes, touchCount, [&]()
+    {
+        TouchEntities(*diskPackedScene, touchCount, touchOffset);
+        touchOffset += touchCount;
+        diskPackedScene->Save();
+    });
+
+    // async reads of the packed scene on disk, through io_uring on linux, checked against a plain read
+    readBuffer.resize(diskPackedBytes);
+    Measure("AsyncIo::Read folder", iterations, diskPackedBytes, entityCount, [&]()
+    {
+        reads.clear();
+        for (size_t offset = 0; offset < diskPackedBytes; offset += cReadChunkSize)
+        {
+            std::span<byte> chunk = std::span<byte>(readBuffer).subspan(offset, std::min(cReadChunkSize, diskPackedBytes - offset));
+            reads.push_back(AsyncIo::Read(cDiskPackedScenePath, offset, chunk));
+        }
+        for (Id::Type read : reads)
+        {
+            AsyncIo::Wait(read);
+        }
+    });
+    std::vector<byte> diskPackedData(diskPackedBytes);
+    if (FileSystem::ReadAt(cDiskPackedScenePath, 0, diskPackedData) != diskPackedBytes || diskPackedData != readBuffer)
+    {
+        throw std::runtime_error("AsyncIo::Read folder read different data");
+    }
+    diskPackedScene->Release();
+#if defined(__linux__) && defined(EDITOR)
+    watcher->Stop();
+#endif
+
+#ifdef EDITOR
+    // play mode snapshots of the current scene, a few entities change while playing
+    SceneManager::Load(textScene);
+    LinkHierarchy(*textScene, options);
+    Measure("CaptureSnapshot", iterations, packedDataBytes, entityCount, [&]()
+    {
+        SceneManager::CaptureSnapshot();
+    });
+    Measure("CaptureSnapshot + RestoreSnapshot", iterations, packedDataBytes, entityCount, [&]()
+    {
+        SceneManager::CaptureSnapshot();
+        TouchEntities(*textScene, touchCount, touchOffset);
+        touchOffset += touchCount;
+        SceneManager::RestoreSnapshot();
+    });
+    SceneManager::Unload();
+#endif
+}
+
+/// benchmark entry point, usage: Benchmark [entity count] [iterations] [components per entity] [hierarchy depth] [hierarchy fan-out]
+int main(int argc, char *argv[])
+{
+    Options options;
+    size_t *values[] = { &options.mEntityCount, &options.mIterations, &options.mComponentCount, &options.mDepth, &options.mFanOut };
+    for (int i = 1; i < argc && i <= static_cast<int>(std::size(values)); ++i)
+    {
+        *values[i - 1] = std::strtoull(argv[i], nullptr, 10);
+    }
+    if (options.mEntityCount == 0 || options.mIterations == 0 || options.mComponentCount > cComponentSynthesizers.size() || options.mDepth == 0 ||
+        (options.mDepth > 1 && options.mFanOut == 0))
+    {
+        std::cerr << std::format("usage: Benchmark [entity count] [iterations] [components per entity, 0 to {}] [hierarchy depth, 1 is flat] [hierarchy fan-out]\n",
+            cComponentSynthesizers.size());
+        return 1;
+    }
+
+    // only errors are reported, the scene info logs would be measured otherwise
+    DebugLog::SetCallback([](DebugLog::LogLevel level, std::string_view message)
+    {
+        if (level == DebugLog::LogLevel::Error)
+        {
+            std::cerr << message << '\n';
+        }
+    });
+
+    // headless setup, scenes live in memory file systems, and in a scratch folder on disk
+    FileSystem::Initialize({});
+    SceneManager::Initialize();
+    ThreadPool::Initialize();
+#ifdef __linux__
+    AsyncIo::Initialize(Linux::IoUringBackend::MakePtr());
+#else
+    AsyncIo::Initialize();
+#endif
+    FileSystem::RegisterFileSystem("Text", MemoryFileSystem::MakePtr(false));
+    FileSystem::RegisterFileSystem("Packed", MemoryFileSystem::MakePtr(true));
+    std::error_code error;
+    std::filesystem::remove_all(ScratchFolder(), error);
+    std::filesystem::create_directories(ScratchFolder(), error);
+    IFileSystemPtr folderFileSystem = FolderFileSystem::MakePtr(ScratchFolder());
+    folderFileSystem->Initialize();
+    FileSystem::RegisterFileSystem("Folder", folderFileSystem);
+
+    int result = 0;
+    {
+        BenchmarkPtr application = Benchmark::MakePtr("Benchmark", 1);
+        try
+        {
+            Run(*application, options);
+        }
+        catch (const std::exception &e)
+        {
+            std::cerr << std::format("Benchmark failed, {}\n", e.what());
+            result = 1;
+        }
+    }
+
+    SceneManager::Shutdown();
+    AsyncIo::Shutdown();
+    ThreadPool::Shutdown();
+    FileSystem::Shutdown();
+    std::filesystem::remove_all(ScratchFolder(), error);
+    return result;
+}
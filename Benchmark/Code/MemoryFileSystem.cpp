@@ -0,0 +1,371 @@
+//==============================================================================================================================================================================
+/// \file
+/// \brief     MemoryFileSystem
+/// \copyright Copyright (c) Gustavo Goedert. All rights reserved.
+//==============================================================================================================================================================================
+
+#include "MemoryFileSystem.h"
+
+/// \cond
+#include <mutex>
+#include <unordered_map>
+/// \endcond
+
+/// MemoryFileSystem::Impl class
+class MemoryFileSystem::Impl
+{
+    CLASS_NO_DEFAULT_CTOR(Impl);
+    CLASS_NO_COPY_MOVE(Impl);
+    CLASS_PTR_UNIQUEMAKER(Impl);
+    friend class MemoryFileSystem;
+
+public:
+    /// constructs a memory file system implementation
+    explicit Impl(bool packed) : mPacked(packed) {}
+
+    /// whether this file system is packed
+    bool Packed() const
+    {
+        return mPacked;
+    }
+
+    /// whether this file system handles the specified file handle
+    bool Handles(Lumen::Id::Type handle)
+    {
+        return mOpenFiles.find(handle) != mOpenFiles.end();
+    }
+
+    /// check if a file exists
+    bool Exists(const std::filesystem::path &path)
+    {
+        return mFiles.find(path.generic_string()) != mFiles.end();
+    }
+
+    /// list files in a directory, the memory file system is flat
+    std::vector<Lumen::FileSystem::FileEntry> ListFiles(const std::filesystem::path &path)
+    {
+        std::vector<Lumen::FileSystem::FileEntry> files;
+        for (const auto &[name, data] : mFiles)
+        {
+            files.push_back({ Lumen::FileSystem::Flag::File, name });
+        }
+        return files;
+    }
+
+    /// opens a file on the specified path, write truncates and creates
+    Lumen::Id::Type Open(const std::filesystem::path &path, bool write, bool binary)
+    {
+        std::string name = path.generic_string();
+        auto it = mFiles.find(name);
+        if (write)
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            it = mFiles.insert_or_assign(name, std::vector<char>()).first;
+        }
+        else if (it == mFiles.end())
+        {
+            return Lumen::Id::Invalid;
+        }
+        Lumen::Id::Type fileId = Lumen::FileSystem::GenerateFileId();
+        mOpenFiles.emplace(fileId, FileState { &it->second, 0 });
+        return fileId;
+    }
+
+    /// closes a file handle
+    void Close(const Lumen::Id::Type handle)
+    {
+        mOpenFiles.erase(handle);
+    }
+
+    /// maps a whole file read-only as a view of the stored data, the data stays valid until the file is written
+    Lumen::Id::Type Map(const std::filesystem::path &path, std::span<const Lumen::byte> &data)
+    {
+        auto it = mFiles.find(path.generic_string());
+        if (it == mFiles.end())
+        {
+            return Lumen::Id::Invalid;
+        }
+        Lumen::Id::Type fileId = Lumen::FileSystem::GenerateFileId();
+        mOpenFiles.emplace(fileId, FileState { &it->second, 0 });
+        data = std::span<const Lumen::byte>(reinterpret_cast<const Lumen::byte *>(it->second.data()), it->second.size());
+        return fileId;
+    }
+
+    /// reads bytes at an offset of a file without a handle
+    size_t ReadAt(const std::filesystem::path &path, size_t offset, std::span<Lumen::byte> buffer)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        auto it = mFiles.find(path.generic_string());
+        if (it == mFiles.end())
+        {
+            return SIZE_MAX;
+        }
+        size_t count = std::min(buffer.size(), it->second.size() - std::min(offset, it->second.size()));
+        memcpy(buffer.data(), it->second.data() + offset, count);
+        return count;
+    }
+
+    /// reads bytes from a file handle
+    size_t ReadBytes(const Lumen::Id::Type handle, void *buffer, const size_t size)
+    {
+        auto it = mOpenFiles.find(handle);
+        if (it == mOpenFiles.end())
+        {
+            return 0;
+        }
+        FileState &file = it->second;
+        size_t count = std::min(size, file.mData->size() - file.mPosition);
+        memcpy(buffer, file.mData->data() + file.mPosition, count);
+        file.mPosition += count;
+        return count;
+    }
+
+    /// writes bytes to a file handle
+    bool WriteBytes(const Lumen::Id::Type handle, const void *buffer, const size_t size)
+    {
+        auto it = mOpenFiles.find(handle);
+        if (it == mOpenFiles.end())
+        {
+            return false;
+        }
+        FileState &file = it->second;
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (file.mPosition + size > file.mData->size())
+        {
+            file.mData->resize(file.mPosition + size);
+        }
+        memcpy(file.mData->data() + file.mPosition, buffer, size);
+        file.mPosition += size;
+        return true;
+    }
+
+    /// reads text from a file handle, a negative line count reads to the end
+    std::string ReadText(const Lumen::Id::Type handle, int lineCount)
+    {
+        auto it = mOpenFiles.find(handle);
+        if (it == mOpenFiles.end())
+        {
+            return {};
+        }
+        FileState &file = it->second;
+        size_t end = file.mPosition;
+        while (end < file.mData->size() && lineCount != 0)
+        {
+            if ((*file.mData)[end++] == '\n')
+            {
+                --lineCount;
+            }
+        }
+        std::string text(file.mData->data() + file.mPosition, end - file.mPosition);
+        file.mPosition = end;
+        return text;
+    }
+
+    /// writes text to a file handle
+    bool WriteText(const Lumen::Id::Type handle, const std::string &text)
+    {
+        return WriteBytes(handle, text.data(), text.size());
+    }
+
+    /// write a whole file aside of its path
+    bool WriteAside(const std::filesystem::path &path, std::span<const Lumen::byte> data)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mFiles.insert_or_assign(path.generic_string() + std::string(Lumen::FileSystem::cAsideSuffix),
+            std::vector<char>(reinterpret_cast<const char *>(data.data()), reinterpret_cast<const char *>(data.data()) + data.size()));
+        return true;
+    }
+
+    /// replace files with the files written aside of them
+    bool CommitAside(std::span<const std::filesystem::path> paths)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        bool result = true;
+        for (const std::filesystem::path &path : paths)
+        {
+            std::string name = path.generic_string();
+            auto it = mFiles.find(name + std::string(Lumen::FileSystem::cAsideSuffix));
+            if (it == mFiles.end())
+            {
+                result = false;
+                continue;
+            }
+            mFiles.insert_or_assign(name, std::move(it->second));
+            mFiles.erase(it);
+        }
+        return result;
+    }
+
+    /// gets the current position in the file by handle
+    size_t Tell(const Lumen::Id::Type handle)
+    {
+        auto it = mOpenFiles.find(handle);
+        if (it == mOpenFiles.end())
+        {
+            return 0;
+        }
+        return it->second.mPosition;
+    }
+
+    /// seeks to a position in the file by handle
+    void Seek(const Lumen::Id::Type handle, const size_t position)
+    {
+        auto it = mOpenFiles.find(handle);
+        if (it == mOpenFiles.end())
+        {
+            return;
+        }
+        it->second.mPosition = std::min(position, it->second.mData->size());
+    }
+
+    /// gets the size of the file by handle
+    size_t Size(const Lumen::Id::Type handle)
+    {
+        auto it = mOpenFiles.find(handle);
+        if (it == mOpenFiles.end())
+        {
+            return static_cast<size_t>(-1);
+        }
+        return it->second.mData->size();
+    }
+
+private:
+    /// file state struct
+    struct FileState
+    {
+        /// file data
+        std::vector<char> *mData;
+
+        /// current position
+        size_t mPosition;
+    };
+
+    /// packed flag
+    const bool mPacked;
+
+    /// files by path, node based so open files keep their data pointer
+    std::unordered_map<std::string, std::vector<char>> mFiles;
+
+    /// open files
+    std::unordered_map<Lumen::Id::Type, FileState> mOpenFiles;
+
+    /// mutex protecting the files against reads from io threads, only writes lock it on the calling thread
+    std::mutex mMutex;
+};
+
+//==============================================================================================================================================================================
+
+/// constructs a memory file system
+MemoryFileSystem::MemoryFileSystem(bool packed) :
+    IFileSystem(), mImpl(MemoryFileSystem::Impl::MakeUniquePtr(packed)) {}
+
+/// creates a smart pointer version of the memory file system
+Lumen::IFileSystemPtr MemoryFileSystem::MakePtr(bool packed)
+{
+    return Lumen::IFileSystemPtr(new MemoryFileSystem(packed));
+}
+
+/// initialize file system, there are no files to report
+void MemoryFileSystem::Initialize() {}
+
+/// whether this file system is packed
+bool MemoryFileSystem::Packed() const
+{
+    return mImpl->Packed();
+}
+
+/// whether this file system handles the specified file handle
+bool MemoryFileSystem::Handles(Lumen::Id::Type handle)
+{
+    return mImpl->Handles(handle);
+}
+
+/// check if a file exists
+bool MemoryFileSystem::Exists(const std::filesystem::path &path)
+{
+    return mImpl->Exists(path);
+}
+
+/// list files in a directory
+std::vector<Lumen::FileSystem::FileEntry> MemoryFileSystem::ListFiles(const std::filesystem::path &path)
+{
+    return mImpl->ListFiles(path);
+}
+
+/// opens a file on the specified path
+Lumen::Id::Type MemoryFileSystem::Open(const std::filesystem::path &path, bool write, bool binary)
+{
+    return mImpl->Open(path, write, binary);
+}
+
+/// closes a file handle
+void MemoryFileSystem::Close(const Lumen::Id::Type handle)
+{
+    mImpl->Close(handle);
+}
+
+/// maps a whole file read-only as a view of the stored data
+Lumen::Id::Type MemoryFileSystem::Map(const std::filesystem::path &path, std::span<const Lumen::byte> &data)
+{
+    return mImpl->Map(path, data);
+}
+
+/// reads bytes at an offset of a file without a handle
+size_t MemoryFileSystem::ReadAt(const std::filesystem::path &path, size_t offset, std::span<Lumen::byte> buffer)
+{
+    return mImpl->ReadAt(path, offset, buffer);
+}
+
+/// reads bytes from a file handle
+size_t MemoryFileSystem::ReadBytes(const Lumen::Id::Type handle, void *buffer, const size_t size)
+{
+    return mImpl->ReadBytes(handle, buffer, size);
+}
+
+/// writes bytes to a file handle
+bool MemoryFileSystem::WriteBytes(const Lumen::Id::Type handle, const void *buffer, const size_t size)
+{
+    return mImpl->WriteBytes(handle, buffer, size);
+}
+
+/// reads text from a file handle
+std::string MemoryFileSystem::ReadText(const Lumen::Id::Type handle, const int lineCount)
+{
+    return mImpl->ReadText(handle, lineCount);
+}
+
+/// writes text to a file handle
+bool MemoryFileSystem::WriteText(const Lumen::Id::Type handle, const std::string &text)
+{
+    return mImpl->WriteText(handle, text);
+}
+
+/// write a whole file aside of its path
+bool MemoryFileSystem::WriteAside(const std::filesystem::path &path, std::span<const Lumen::byte> data)
+{
+    return mImpl->WriteAside(path, data);
+}
+
+/// replace files with the files written aside of them, memory has no durability to honor
+bool MemoryFileSystem::CommitAside(std::span<const std::filesystem::path> paths, Lumen::FileSystem::Durability durability)
+{
+    return mImpl->CommitAside(paths);
+}
+
+/// gets the current position in the file by handle
+size_t MemoryFileSystem::Tell(const Lumen::Id::Type handle)
+{
+    return mImpl->Tell(handle);
+}
+
+/// seeks to a position in the file by handle
+void MemoryFileSystem::Seek(const Lumen::Id::Type handle, const size_t position)
+{
+    mImpl->Seek(handle, position);
+}
+
+/// gets the size of the file by handle
+size_t MemoryFileSystem::Size(const Lumen::Id::Type handle)
+{
+    return mImpl->Size(handle);
+}
@@ -0,0 +1,80 @@
+//==============================================================================================================================================================================
+/// \file
+/// \brief     MemoryFileSystem interface
+/// \copyright Copyright (c) Gustavo Goedert. All rights reserved.
+//==============================================================================================================================================================================
+#pragma once
+
+#include "lFileSystem.h"
+
+/// MemoryFileSystem class, keeps files in memory so benchmarks do not measure the disk
+class MemoryFileSystem : public Lumen::IFileSystem
+{
+    CLASS_NO_DEFAULT_CTOR(MemoryFileSystem);
+    CLASS_NO_COPY_MOVE(MemoryFileSystem);
+
+public:
+    /// creates a smart pointer version of the memory file system
+    static Lumen::IFileSystemPtr MakePtr(bool packed);
+
+    /// initialize file system
+    void Initialize() override;
+
+    /// whether this file system is packed
+    bool Packed() const override;
+
+    /// whether this file system handles the specified file handle
+    bool Handles(Lumen::Id::Type handle) override;
+
+    /// check if a file exists
+    bool Exists(const std::filesystem::path &path) override;
+
+    /// list files in a directory
+    std::vector<Lumen::FileSystem::FileEntry> ListFiles(const std::filesystem::path &path) override;
+
+    /// opens a file on the specified path
+    Lumen::Id::Type Open(const std::filesystem::path &path, bool write, bool binary) override;
+
+    /// closes a file handle
+    void Close(const Lumen::Id::Type handle) override;
+
+    /// maps a whole file read-only as a view of the stored data
+    Lumen::Id::Type Map(const std::filesystem::path &path, std::span<const Lumen::byte> &data) override;
+
+    /// reads bytes at an offset of a file without a handle
+    size_t ReadAt(const std::filesystem::path &path, size_t offset, std::span<Lumen::byte> buffer) override;
+
+    /// reads bytes from a file handle
+    size_t ReadBytes(const Lumen::Id::Type handle, void *buffer, const size_t size = SIZE_MAX) override;
+
+    /// writes bytes to a file handle
+    bool WriteBytes(const Lumen::Id::Type handle, const void *buffer, const size_t size) override;
+
+    /// reads text from a file handle
+    std::string ReadText(const Lumen::Id::Type handle, const int lineCount = -1) override;
+
+    /// writes text to a file handle
+    bool WriteText(const Lumen::Id::Type handle, const std::string &text) override;
+
+    /// write a whole file aside of its path
+    bool WriteAside(const std::filesystem::path &path, std::span<const Lumen::byte> data) override;
+
+    /// replace files with the files written aside of them, memory has no durability to honor
+    bool CommitAside(std::span<const std::filesystem::path> paths, Lumen::FileSystem::Durability durability) override;
+
+    /// gets the current position in the file by handle
+    size_t Tell(const Lumen::Id::Type handle) override;
+
+    /// seeks to a position in the file by handle
+    void Seek(const Lumen::Id::Type handle, const size_t position) override;
+
+    /// gets the size of the file by handle
+    size_t Size(const Lumen::Id::Type handle) override;
+
+private:
+    /// constructs a memory file system
+    explicit MemoryFileSystem(bool packed);
+
+    /// private implementation
+    CLASS_PIMPL_DEF(Impl);
+};
@@ -0,0 +1,503 @@
+//==============================================================================================================================================================================
+/// \file
+/// \brief     ArchiveFileSystem
+/// \copyright Copyright (c) Gustavo Goedert. All rights reserved.
+//==============================================================================================================================================================================
+
+#include "lArchiveFileSystem.h"
+#include "lPackedArchive.h"
+#include "lCompression.h"
+#include "lHandleMap.h"
+
+/// \cond
+#include <set>
+/// \endcond
+
+using namespace Lumen;
+
+/// ArchiveFileSystem::Impl class
+class ArchiveFileSystem::Impl
+{
+    CLASS_NO_DEFAULT_CTOR(Impl);
+    CLASS_NO_COPY_MOVE(Impl);
+    CLASS_PTR_UNIQUEMAKER(Impl);
+    friend class ArchiveFileSystem;
+
+public:
+    /// constructs an archive file system implementation, mapping the archive from the source file system
+    explicit Impl(const IFileSystemPtr &source, const std::filesystem::path &archivePath, const std::filesystem::path &root) :
+        mSource(source), mRoot(root)
+    {
+        // file systems that cannot map the archive read it into a copy, opening a missing file would create it
+        std::span<const byte> data;
+        mArchiveHandle = mSource->Map(archivePath, data);
+        if (mArchiveHandle == Id::Invalid && mSource->Exists(archivePath))
+        {
+            Id::Type file = mSource->Open(archivePath, false, true);
+            if (file != Id::Invalid)
+            {
+                mArchiveCopy.resize(mSource->Size(file));
+                mArchiveCopy.resize(mSource->ReadBytes(file, mArchiveCopy.data(), mArchiveCopy.size()));
+                mSource->Close(file);
+            }
+            data = mArchiveCopy;
+        }
+        if (!mView.Open(data))
+        {
+            Lumen::DebugLog::Error("Unable to open packed archive {}", archivePath.string());
+        }
+        BuildFolders();
+    }
+
+    /// destroys the archive file system implementation, unmapping the archive
+    ~Impl()
+    {
+        if (mArchiveHandle != Id::Invalid)
+        {
+            mSource->Close(mArchiveHandle);
+        }
+    }
+
+    /// initialize file system, reports every file and directory of the archive as added
+    void Initialize()
+    {
+        std::vector<FileSystem::FileChange> fileBatch;
+        std::set<std::string_view> directories;
+        for (size_t i = 0; i < mView.EntryCount(); ++i)
+        {
+            std::string_view name = mView.Name(mView.GetEntry(i));
+            for (size_t slash = name.find('/'); slash != std::string_view::npos; slash = name.find('/', slash + 1))
+            {
+                if (directories.insert(name.substr(0, slash)).second)
+                {
+                    fileBatch.push_back({ FileSystem::Change::Added, FileSystem::Flag::Directory, (mRoot / name.substr(0, slash)).generic_string(), "" });
+                }
+            }
+            fileBatch.push_back({ FileSystem::Change::Added, FileSystem::Flag::File, (mRoot / name).generic_string(), "" });
+        }
+        if (!fileBatch.empty())
+        {
+            FileSystem::PushFileChangeBatch(std::move(fileBatch));
+        }
+    }
+
+    /// whether this file system is packed
+    bool Packed() const
+    {
+        return true;
+    }
+
+    /// whether this file system handles the specified file handle
+    bool Handles(Id::Type handle)
+    {
+        return mOpenFiles.Contains(handle);
+    }
+
+    /// check if a file or directory exists
+    bool Exists(const std::filesystem::path &path)
+    {
+        std::string name = path.generic_string();
+        return name.empty() || mView.Find(name) || FindFolder(name);
+    }
+
+    /// list files in a directory, directories are derived from the file paths
+    std::vector<FileSystem::FileEntry> ListFiles(const std::filesystem::path &path)
+    {
+        std::vector<FileSystem::FileEntry> files;
+        const Folder *folder = FindFolder(path.generic_string());
+        if (folder)
+        {
+            files.reserve(folder->mChildCount);
+            for (size_t i = folder->mFirstChild; i < folder->mFirstChild + folder->mChildCount; ++i)
+            {
+                files.push_back({ mChildren[i].mFlags, std::string(mChildren[i].mName) });
+            }
+        }
+        return files;
+    }
+
+    /// opens a file on the specified path, the archive is read-only
+    Id::Type Open(const std::filesystem::path &path, bool write, bool binary)
+    {
+        std::span<const byte> data;
+        return write ? Id::Invalid : Map(path, data);
+    }
+
+    /// closes a file handle
+    void Close(const Id::Type handle)
+    {
+        mOpenFiles.Erase(handle);
+    }
+
+    /// maps a whole file read-only, stored entries are a view of the archive, compressed entries are decompressed
+    Id::Type Map(const std::filesystem::path &path, std::span<const byte> &data)
+    {
+        const PackedArchive::Entry *entry = mView.Find(path.generic_string());
+        if (!entry)
+        {
+            return Id::Invalid;
+        }
+        FileState file;
+        file.mData = mView.Data(*entry);
+        if (entry->mFlags & PackedArchive::cCompressedEntry)
+        {
+            if (!Compression::Decompress(file.mData, file.mBuffer))
+            {
+                Lumen::DebugLog::Error("Unable to decompress archive entry {}", path.string());
+                return Id::Invalid;
+            }
+            file.mData = file.mBuffer;
+        }
+        data = file.mData;
+        Id::Type fileId = FileSystem::GenerateFileId();
+        mOpenFiles.Emplace(fileId, std::move(file));
+        return fileId;
+    }
+
+    /// reads bytes at an offset of a file without a handle, only the compressed blocks covering the range are decompressed
+    size_t ReadAt(const std::filesystem::path &path, size_t offset, std::span<byte> buffer)
+    {
+        const PackedArchive::Entry *entry = mView.Find(path.generic_string());
+        if (!entry)
+        {
+            return SIZE_MAX;
+        }
+        size_t size = std::min<size_t>(buffer.size(), entry->mSize - std::min<size_t>(offset, entry->mSize));
+        if (!(entry->mFlags & PackedArchive::cCompressedEntry))
+        {
+            memcpy(buffer.data(), mView.Data(*entry).data() + offset, size);
+            return size;
+        }
+
+        // decompress the blocks covering the range
+        Compression::View view;
+        if (!view.Open(mView.Data(*entry)))
+        {
+            return SIZE_MAX;
+        }
+        size_t blockSize = view.BlockCount() > 1 ? view.BlockOffset(1) : view.Size();
+        std::vector<byte> block;
+        for (size_t position = offset; position < offset + size;)
+        {
+            size_t index = position / blockSize;
+            block.resize(view.BlockSize(index));
+            if (!view.DecompressBlock(index, block))
+            {
+                return SIZE_MAX;
+            }
+            size_t begin = position - view.BlockOffset(index);
+            size_t count = std::min(block.size() - begin, offset + size - position);
+            memcpy(buffer.data() + (position - offset), block.data() + begin, count);
+            position += count;
+        }
+        return size;
+    }
+
+    /// reads bytes from a file handle
+    size_t ReadBytes(const Id::Type handle, void *buffer, const size_t size)
+    {
+        FileState *state = mOpenFiles.Find(handle);
+        if (!state)
+        {
+            return 0;
+        }
+        FileState &file = *state;
+        size_t count = std::min(size, file.mData.size() - file.mPosition);
+        memcpy(buffer, file.mData.data() + file.mPosition, count);
+        file.mPosition += count;
+        return count;
+    }
+
+    /// reads text from a file handle, a negative line count reads to the end
+    std::string ReadText(const Id::Type handle, int lineCount)
+    {
+        FileState *state = mOpenFiles.Find(handle);
+        if (!state)
+        {
+            return {};
+        }
+        FileState &file = *state;
+        size_t end = file.mPosition;
+        while (end < file.mData.size() && lineCount != 0)
+        {
+            if (file.mData[end++] == '\n')
+            {
+                --lineCount;
+            }
+        }
+        std::string text(reinterpret_cast<const char *>(file.mData.data()) + file.mPosition, end - file.mPosition);
+        file.mPosition = end;
+        return text;
+    }
+
+    /// gets the current position in the file by handle
+    size_t Tell(const Id::Type handle)
+    {
+        FileState *state = mOpenFiles.Find(handle);
+        if (!state)
+        {
+            return 0;
+        }
+        return state->mPosition;
+    }
+
+    /// seeks to a position in the file by handle
+    void Seek(const Id::Type handle, const size_t position)
+    {
+        FileState *state = mOpenFiles.Find(handle);
+        if (!state)
+        {
+            return;
+        }
+        state->mPosition = std::min(position, state->mData.size());
+    }
+
+    /// gets the size of the file by handle
+    size_t Size(const Id::Type handle)
+    {
+        FileState *state = mOpenFiles.Find(handle);
+        if (!state)
+        {
+            return static_cast<size_t>(-1);
+        }
+        return state->mData.size();
+    }
+
+private:
+    /// folder record, folders are derived from the file paths when the archive opens
+    struct Folder
+    {
+        /// hash of the folder path
+        Hash64 mHash;
+
+        /// folder path, without a trailing slash, empty for the root
+        std::string_view mPath;
+
+        /// first child in the child table
+        size_t mFirstChild;
+
+        /// number of children
+        size_t mChildCount;
+    };
+
+    /// folder child record
+    struct Child
+    {
+        /// file or folder name
+        std::string_view mName;
+
+        /// flags
+        FileSystem::Flags mFlags;
+    };
+
+    /// build the folder table sorted by path hash, with the files and folders directly in each folder
+    void BuildFolders()
+    {
+        // one link per folder level of every file, the links of a folder sort together
+        std::vector<std::tuple<Hash64, std::string_view, std::string_view, bool>> links;
+        for (size_t i = 0; i < mView.EntryCount(); ++i)
+        {
+            std::string_view name = mView.Name(mView.GetEntry(i));
+            for (size_t begin = 0;;)
+            {
+                size_t slash = name.find('/', begin);
+                std::string_view parent = name.substr(0, begin == 0 ? 0 : begin - 1);
+                bool directory = slash != std::string_view::npos;
+                links.emplace_back(HashString64(parent), parent, name.substr(begin, directory ? slash - begin : std::string_view::npos), directory);
+                if (!directory)
+                {
+                    break;
+                }
+                begin = slash + 1;
+            }
+        }
+        std::sort(links.begin(), links.end());
+        links.erase(std::unique(links.begin(), links.end()), links.end());
+
+        for (size_t i = 0; i < links.size();)
+        {
+            Folder &folder = mFolders.emplace_back(Folder { std::get<0>(links[i]), std::get<1>(links[i]), mChildren.size(), 0 });
+            for (; i < links.size() && std::get<0>(links[i]) == folder.mHash && std::get<1>(links[i]) == folder.mPath; ++i)
+            {
+                mChildren.push_back({ std::get<2>(links[i]), std::get<3>(links[i]) ? FileSystem::Flag::Directory : FileSystem::Flag::File });
+            }
+            folder.mChildCount = mChildren.size() - folder.mFirstChild;
+        }
+    }
+
+    /// find a folder, a binary search on the path hash
+    [[nodiscard]] const Folder *FindFolder(std::string_view path) const
+    {
+        if (path.ends_with('/'))
+        {
+            path.remove_suffix(1);
+        }
+        Hash64 hash = HashString64(path);
+        auto it = std::lower_bound(mFolders.begin(), mFolders.end(), hash, [](const Folder &folder, Hash64 value) { return folder.mHash < value; });
+        for (; it != mFolders.end() && it->mHash == hash; ++it)
+        {
+            if (it->mPath == path)
+            {
+                return &*it;
+            }
+        }
+        return nullptr;
+    }
+
+    /// file state struct
+    struct FileState
+    {
+        /// file data, a view of the archive or of the buffer
+        std::span<const byte> mData;
+
+        /// decompressed data of compressed entries
+        std::vector<byte> mBuffer;
+
+        /// current position
+        size_t mPosition = 0;
+    };
+
+    /// source file system of the archive
+    const IFileSystemPtr mSource;
+
+    /// root of the reported file names
+    const std::filesystem::path mRoot;
+
+    /// archive handle in the source file system, invalid if the archive was copied
+    Id::Type mArchiveHandle = Id::Invalid;
+
+    /// archive copy, used when the source cannot map it
+    std::vector<byte> mArchiveCopy;
+
+    /// archive view
+    PackedArchive::View mView;
+
+    /// folders sorted by path hash
+    std::vector<Folder> mFolders;
+
+    /// files and folders directly in each folder, a range per folder
+    std::vector<Child> mChildren;
+
+    /// open files
+    HandleMap<FileState> mOpenFiles;
+};
+
+//==============================================================================================================================================================================
+
+/// constructs an archive file system
+ArchiveFileSystem::ArchiveFileSystem(const IFileSystemPtr &source, const std::filesystem::path &archivePath, const std::filesystem::path &root) :
+    IFileSystem(), mImpl(ArchiveFileSystem::Impl::MakeUniquePtr(source, archivePath, FileSystem::NormalizeDirPath(root))) {}
+
+/// creates a smart pointer version of the archive file system
+IFileSystemPtr ArchiveFileSystem::MakePtr(const IFileSystemPtr &source, const std::filesystem::path &archivePath, const std::filesystem::path &root)
+{
+    return IFileSystemPtr(new ArchiveFileSystem(source, archivePath, root));
+}
+
+/// initialize file system
+void ArchiveFileSystem::Initialize()
+{
+    mImpl->Initialize();
+}
+
+/// whether this file system is packed
+bool ArchiveFileSystem::Packed() const
+{
+    return mImpl->Packed();
+}
+
+/// whether this file system handles the specified file handle
+bool ArchiveFileSystem::Handles(Id::Type handle)
+{
+    return mImpl->Handles(handle);
+}
+
+/// check if a file exists
+bool ArchiveFileSystem::Exists(const std::filesystem::path &path)
+{
+    return mImpl->Exists(path);
+}
+
+/// list files in a directory
+std::vector<FileSystem::FileEntry> ArchiveFileSystem::ListFiles(const std::filesystem::path &path)
+{
+    return mImpl->ListFiles(path);
+}
+
+/// opens a file on the specified path
+Id::Type ArchiveFileSystem::Open(const std::filesystem::path &path, bool write, bool binary)
+{
+    return mImpl->Open(path, write, binary);
+}
+
+/// closes a file handle
+void ArchiveFileSystem::Close(const Id::Type handle)
+{
+    mImpl->Close(handle);
+}
+
+/// maps a whole file read-only, the data stays valid until the handle is closed
+Id::Type ArchiveFileSystem::Map(const std::filesystem::path &path, std::span<const byte> &data)
+{
+    return mImpl->Map(path, data);
+}
+
+/// reads bytes at an offset of a file without a handle
+size_t ArchiveFileSystem::ReadAt(const std::filesystem::path &path, size_t offset, std::span<byte> buffer)
+{
+    return mImpl->ReadAt(path, offset, buffer);
+}
+
+/// reads bytes from a file handle
+size_t ArchiveFileSystem::ReadBytes(const Id::Type handle, void *buffer, const size_t size)
+{
+    return mImpl->ReadBytes(handle, buffer, size);
+}
+
+/// writes bytes to a file handle, the archive is read-only
+bool ArchiveFileSystem::WriteBytes(const Id::Type handle, const void *buffer, const size_t size)
+{
+    return false;
+}
+
+/// reads text from a file handle
+std::string ArchiveFileSystem::ReadText(const Id::Type handle, const int lineCount)
+{
+    return mImpl->ReadText(handle, lineCount);
+}
+
+/// writes text to a file handle, the archive is read-only
+bool ArchiveFileSystem::WriteText(const Id::Type handle, const std::string &text)
+{
+    return false;
+}
+
+/// write a whole file aside of its path, the archive is read-only
+bool ArchiveFileSystem::WriteAside(const std::filesystem::path &path, std::span<const byte> data)
+{
+    return false;
+}
+
+/// replace files with the files written aside of them, the archive is read-only
+bool ArchiveFileSystem::CommitAside(std::span<const std::filesystem::path> paths, FileSystem::Durability durability)
+{
+    return paths.empty();
+}
+
+/// gets the current position in the file by handle
+size_t ArchiveFileSystem::Tell(const Id::Type handle)
+{
+    return mImpl->Tell(handle);
+}
+
+/// seeks to a position in the file by handle
+void ArchiveFileSystem::Seek(const Id::Type handle, const size_t position)
+{
+    mImpl->Seek(handle, position);
+}
+
+/// gets the size of the file by handle
+size_t ArchiveFileSystem::Size(const Id::Type handle)
+{
+    return mImpl->Size(handle);
+}
@@ -5,11 +5,17 @@
 //==============================================================================================================================================================================
 
 #include "lFileSystem.h"
+#include "lBatchWriter.h"
+#include "lPathId.h"
 #include "lStringMap.h"
 #include "lAssetInfo.h"
 
 #include "lMesh.h"
 
+/// \cond
+#include <charconv>
+/// \endcond
+
 using namespace Lumen;
 
 /// AssetInfo::Impl class
@@ -23,18 +29,22 @@ public:
     /// constructs a assetinfo
     explicit Impl(const std::filesystem::path &path) : mPath(path), mUUID(UUID_INVALID) {}
 
-    /// initialize assetinfo
+    /// initialize assetinfo, with the content hash of the asset file so its first touch is not reimported
     void Initialize()
     {
         mUUID = UUIDGenerate();
         mType = Mesh::Type();
+        if (!FileSystem::ContentHash(mPath, mContentHash))
+        {
+            mContentHash = 0;
+        }
     }
 
     /// register assetinfo name / path
     static void Register(std::string_view name, std::string_view path)
     {
         // register asset
-        mAssetPaths.insert_or_assign(std::string(name), path);
+        mAssetPaths.insert_or_assign(std::string(name), PathId::Intern(path));
     }
 
     /// find assetinfo path from name
@@ -44,7 +54,7 @@ public:
         auto it = mAssetPaths.find(name);
         if (it != mAssetPaths.end())
         {
-            return it->second;
+            return it->second.String();
         }
 
         // none found
@@ -67,14 +77,26 @@ public:
             Serialized::SerializeValue(out, false, Serialized::cTypeToken, Serialized::cTypeTokenPacked, mType);
 #endif
         }
+        if (mContentHash != 0)
+        {
+            if (packed)
+            {
+                Serialized::SerializeValue(out, true, Serialized::cContentHashToken, Serialized::cContentHashTokenPacked, mContentHash);
+            }
+            else
+            {
+                Serialized::SerializeValue(out, false, Serialized::cContentHashToken, Serialized::cContentHashTokenPacked, std::format("{:016X}", mContentHash));
+            }
+        }
     }
 
     /// deserialize
     void Deserialize(const Serialized::Type &in, bool packed)
     {
+        Serialized::Reader reader(in, packed);
         Serialized::Type typeValue = {};
-        L_ASSERT(Serialized::DeserializeUUID(in, packed, Serialized::cUUIDToken, Serialized::cUUIDTokenPacked, mUUID));
-        L_ASSERT(Serialized::DeserializeValue(in, packed, Serialized::cTypeToken, Serialized::cTypeTokenPacked, typeValue));
+        L_VERIFY(reader.ReadUUID(Serialized::cUUIDToken, Serialized::cUUIDTokenPacked, mUUID));
+        L_VERIFY(reader.Read(Serialized::cTypeToken, Serialized::cTypeTokenPacked, typeValue));
         if (!typeValue.is_string())
         {
             mType = typeValue;
@@ -83,10 +105,32 @@ public:
         {
             mType = EncodeType(typeValue.get<std::string>().c_str());
         }
+
+        // infofiles written before content hashes have none
+        Serialized::Type hashValue = {};
+        mContentHash = 0;
+        if (reader.Read(Serialized::cContentHashToken, Serialized::cContentHashTokenPacked, hashValue))
+        {
+            if (hashValue.is_string())
+            {
+                // a hash that does not parse is unknown
+                const std::string &hashText = hashValue.get_ref<const std::string &>();
+                const char *hashEnd = hashText.data() + hashText.size();
+                std::from_chars_result parsed = std::from_chars(hashText.data(), hashEnd, mContentHash, 16);
+                if (parsed.ec != std::errc() || parsed.ptr != hashEnd)
+                {
+                    mContentHash = 0;
+                }
+            }
+            else if (hashValue.is_number_unsigned())
+            {
+                mContentHash = hashValue.get<Hash64>();
+            }
+        }
     }
 
-    /// save assetinfo
-    bool Save() const
+    /// save assetinfo, as part of a batch if one is given
+    bool Save(BatchWriter *writer) const
     {
         std::string infoFile = mPath.string() + std::string(".info");
         Lumen::DebugLog::Info("AssetInfo::Impl::Save {}", infoFile);
@@ -96,6 +140,11 @@ public:
         Serialize(data, FileSystem::IsPacked(infoFile));
 
         // write the assetinfo
+        if (writer)
+        {
+            writer->WriteSerializedData(infoFile, data);
+            return true;
+        }
         return FileSystem::WriteSerializedData(infoFile, data);
     }
 
@@ -132,6 +181,12 @@ public:
     /// get UUID
     const Lumen::UUID UUID() const { return mUUID; }
 
+    /// get the content hash of the asset file
+    Hash64 ContentHash() const { return mContentHash; }
+
+    /// set the content hash of the asset file
+    void SetContentHash(Hash64 hash) { mContentHash = hash; }
+
 private:
     /// path
     const std::filesystem::path mPath;
@@ -142,11 +197,14 @@ private:
     /// assetinfo type
     Hash mType;
 
-    /// static map of asset names to paths
-    static StringMap<std::string> mAssetPaths;
+    /// content hash of the asset file, zero if unknown
+    Hash64 mContentHash = 0;
+
+    /// static map of asset names to interned paths
+    static StringMap<PathId> mAssetPaths;
 };
 
-StringMap<std::string> AssetInfo::Impl::mAssetPaths;
+StringMap<PathId> AssetInfo::Impl::mAssetPaths;
 
 //==============================================================================================================================================================================
 
@@ -180,7 +238,13 @@ Expected<std::string_view> AssetInfo::Find(std::string_view name)
 /// save assetinfo
 bool AssetInfo::Save() const
 {
-    return mImpl->Save();
+    return mImpl->Save(nullptr);
+}
+
+/// save assetinfo as part of a batch, it is on disk once the batch finishes
+void AssetInfo::Save(BatchWriter &writer) const
+{
+    mImpl->Save(&writer);
 }
 
 /// load assetinfo
@@ -196,7 +260,19 @@ const std::filesystem::path &AssetInfo::Path() const
 }
 
 /// get UUID
-const UUID AssetInfo::UUID() const
+const Lumen::UUID AssetInfo::UUID() const
 {
     return mImpl->UUID();
 }
+
+/// get the content hash of the asset file, zero if unknown
+Hash64 AssetInfo::ContentHash() const
+{
+    return mImpl->ContentHash();
+}
+
+/// set the content hash of the asset file
+void AssetInfo::SetContentHash(Hash64 hash)
+{
+    mImpl->SetContentHash(hash);
+}
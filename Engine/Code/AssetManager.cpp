@@ -5,6 +5,7 @@
 //==============================================================================================================================================================================
 
 #include "lAssetManager.h"
+#include "lBatchWriter.h"
 #include "lFileSystem.h"
 
 using namespace Lumen;
@@ -64,6 +65,9 @@ bool AssetManager::GetAssetInfos(const std::string &path, std::vector<AssetInfoP
         return false;
     }
     std::vector<FileSystem::FileEntry> files = FileSystem::ListFiles("Assets" + path);
+
+    // new infofiles are written together, with one flush to disk for all of them
+    BatchWriter infoWriter;
     for(const FileSystem::FileEntry &entry : files)
     {
         bool isInfo = false;
@@ -84,7 +88,7 @@ bool AssetManager::GetAssetInfos(const std::string &path, std::vector<AssetInfoP
             if (!FileSystem::Exists(infoFile))
             {
                 assetInfo->Initialize();
-                assetInfo->Save();
+                assetInfo->Save(infoWriter);
                 DebugLog::Info("Create asset file in Assets folder: {}", infoFile);
             }
             else
@@ -94,6 +98,10 @@ bool AssetManager::GetAssetInfos(const std::string &path, std::vector<AssetInfoP
             assetInfos.push_back(assetInfo);
         }
     }
+    if (!infoWriter.Finish())
+    {
+        DebugLog::Error("Unable to write asset files in Assets folder: {}", path);
+    }
     return true;
 }
 
@@ -142,8 +150,8 @@ void AssetManagerOldImpl::RegisterFactory(const AssetFactoryOldPtr &assetFactory
 /// import asset
 Expected<AssetPtr> AssetManagerOldImpl::Import(HashType type, const std::filesystem::path &path)
 {
-    // normalize the path
-    std::string normalizedPath = FileSystem::NormalizeFilePath(path).string();
+    // intern the path, normalized once
+    PathId pathId = PathId::Intern(path);
 
     //@@REVIEW@@
     //cache asset in some map? make some mechanism that purges or keeps assets around depending on whats happening?
@@ -152,9 +160,9 @@ Expected<AssetPtr> AssetManagerOldImpl::Import(HashType type, const std::filesys
     for (auto &priorityFactory : mAssetFactories)
     {
         auto &assetFactory = priorityFactory.second;
-        if (assetFactory->Exists(normalizedPath))
+        if (assetFactory->Exists(pathId))
         {
-            auto assetExpected = assetFactory->Import(mEngine, type, normalizedPath);
+            auto assetExpected = assetFactory->Import(mEngine, type, pathId);
             if (assetExpected)
             {
                 return assetExpected.Value();
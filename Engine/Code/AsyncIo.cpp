@@ -0,0 +1,384 @@
+//==============================================================================================================================================================================
+/// \file
+/// \brief     asynchronous file reads
+/// \copyright Copyright (c) Gustavo Goedert. All rights reserved.
+//==============================================================================================================================================================================
+
+#include "lAsyncIo.h"
+#include "lFileSystem.h"
+#include "lThreadPool.h"
+
+/// \cond
+#include <array>
+#include <condition_variable>
+#include <deque>
+#include <list>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+/// \endcond
+
+using namespace Lumen;
+
+/// Lumen Hidden namespace
+namespace Lumen::Hidden
+{
+    /// operations the thread pool backend keeps in flight per worker thread
+    constexpr size_t cThreadPoolDepthPerThread = 2;
+
+    /// thread pool backend class, runs blocking positional reads on the thread pool
+    class ThreadPoolBackend : public IAsyncIoBackend
+    {
+        CLASS_NO_COPY_MOVE(ThreadPoolBackend);
+
+    public:
+        /// default constructor
+        explicit ThreadPoolBackend() = default;
+
+        /// maximum number of operations in flight
+        size_t Depth() const override
+        {
+            return std::max<size_t>(ThreadPool::ThreadCount(), 1) * cThreadPoolDepthPerThread;
+        }
+
+        /// start an operation
+        void Submit(AsyncIo::Operation &operation) override
+        {
+            ThreadPool::Submit([&operation]()
+            {
+                operation.mSize = FileSystem::ReadAt(operation.mPath, operation.mOffset, operation.mBuffer);
+                AsyncIo::Complete(operation);
+            });
+        }
+    };
+
+    /// request state struct
+    struct AsyncRequest
+    {
+        /// path
+        std::filesystem::path mPath;
+
+        /// offset in the file
+        size_t mOffset;
+
+        /// destination
+        std::span<byte> mBuffer;
+
+        /// callback
+        AsyncIo::Callback mCallback;
+
+        /// whether the request was dispatched to the backend
+        bool mDispatched = false;
+
+        /// whether the request is done
+        bool mDone = false;
+
+        /// bytes read, SIZE_MAX if the read failed
+        size_t mSize = 0;
+    };
+
+    /// operation in flight struct, owns the buffer of merged requests
+    struct AsyncOperation : AsyncIo::Operation
+    {
+        /// requests served by this operation, in file order
+        std::vector<Id::Type> mRequests;
+
+        /// buffers of the requests, so a merged read is scattered without the lock
+        std::vector<std::span<byte>> mTargets;
+
+        /// buffer of a merged read, scattered to the requests when done
+        std::vector<byte> mMergeBuffer;
+    };
+
+    /// async io state struct
+    struct AsyncIoState
+    {
+        CLASS_NO_COPY_MOVE(AsyncIoState);
+
+        /// constructs the state with a backend
+        explicit AsyncIoState(const IAsyncIoBackendPtr &backend) : mBackend(backend) {}
+
+        /// backend
+        IAsyncIoBackendPtr mBackend;
+
+        /// mutex protecting the state, backends complete operations from their own threads
+        std::mutex mMutex;
+
+        /// signaled when a request is done
+        std::condition_variable mCondition;
+
+        /// request id generator
+        Id::Generator mRequestIds;
+
+        /// requests that are not retired
+        std::unordered_map<Id::Type, AsyncRequest> mRequests;
+
+        /// requests waiting for dispatch, one fifo per priority, merged requests are skipped when popped
+        std::array<std::deque<Id::Type>, AsyncIo::cPriorityCount> mQueues;
+
+        /// requests waiting for dispatch by file and offset, to find the adjacent ones
+        std::multimap<std::pair<std::filesystem::path::string_type, size_t>, Id::Type> mQueuedByOffset;
+
+        /// operations in flight
+        std::list<AsyncOperation> mOperations;
+
+        /// requests that are not done
+        size_t mPendingCount = 0;
+
+        /// threads that are about to dispatch or dispatching, shutdown waits for them
+        size_t mDispatchers = 0;
+
+        /// requests that are done and not retired, in completion order
+        std::vector<Id::Type> mCompleted;
+    };
+
+    /// global async io state
+    static std::unique_ptr<AsyncIoState> gAsyncIoState;
+
+    /// whether the calling thread is dispatching, backends that complete inline re-enter dispatch
+    static thread_local bool tDispatching = false;
+
+    /// remove a queued request from the offset index
+    static void Unqueue(AsyncIoState &state, Id::Type id, const AsyncRequest &request)
+    {
+        auto [begin, end] = state.mQueuedByOffset.equal_range({ request.mPath.native(), request.mOffset });
+        for (auto it = begin; it != end; ++it)
+        {
+            if (it->second == id)
+            {
+                state.mQueuedByOffset.erase(it);
+                return;
+            }
+        }
+    }
+
+    /// build the next operation from the highest priority request and the queued requests that follow it in the file
+    static AsyncOperation *NextOperation(AsyncIoState &state)
+    {
+        for (std::deque<Id::Type> &queue : state.mQueues)
+        {
+            while (!queue.empty())
+            {
+                Id::Type id = queue.front();
+                queue.pop_front();
+                auto it = state.mRequests.find(id);
+                if (it == state.mRequests.end() || it->second.mDispatched)
+                {
+                    continue;
+                }
+
+                // merge adjacent requests of any priority, they ride along for free
+                AsyncOperation &operation = state.mOperations.emplace_back();
+                AsyncRequest *request = &it->second;
+                operation.mPath = request->mPath;
+                operation.mOffset = request->mOffset;
+                size_t size = 0;
+                for (;;)
+                {
+                    request->mDispatched = true;
+                    Unqueue(state, id, *request);
+                    operation.mRequests.push_back(id);
+                    operation.mTargets.push_back(request->mBuffer);
+                    size += request->mBuffer.size();
+
+                    auto next = state.mQueuedByOffset.find({ operation.mPath.native(), operation.mOffset + size });
+                    if (next == state.mQueuedByOffset.end())
+                    {
+                        break;
+                    }
+                    id = next->second;
+                    request = &state.mRequests.at(id);
+                    if (size + request->mBuffer.size() > AsyncIo::cMaxMergeSize)
+                    {
+                        break;
+                    }
+                }
+
+                // a single request reads straight into its buffer
+                if (operation.mRequests.size() == 1)
+                {
+                    operation.mBuffer = it->second.mBuffer;
+                }
+                else
+                {
+                    operation.mMergeBuffer.resize(size);
+                    operation.mBuffer = operation.mMergeBuffer;
+                }
+                return &operation;
+            }
+        }
+        return nullptr;
+    }
+
+    /// submit operations to the backend until it is full or nothing is queued, the caller counted itself in the dispatchers
+    static void Dispatch(AsyncIoState &state)
+    {
+        std::unique_lock<std::mutex> lock(state.mMutex);
+        if (!tDispatching)
+        {
+            tDispatching = true;
+            while (state.mOperations.size() < state.mBackend->Depth())
+            {
+                AsyncOperation *operation = NextOperation(state);
+                if (!operation)
+                {
+                    break;
+                }
+                lock.unlock();
+                state.mBackend->Submit(*operation);
+                lock.lock();
+            }
+            tDispatching = false;
+        }
+        --state.mDispatchers;
+        state.mCondition.notify_all();
+    }
+}
+
+/// initialize async io namespace, without a backend reads are run on the thread pool
+void AsyncIo::Initialize(const IAsyncIoBackendPtr &backend)
+{
+    L_ASSERT(!Hidden::gAsyncIoState);
+    Hidden::gAsyncIoState = std::make_unique<Hidden::AsyncIoState>(backend ? backend : std::make_shared<Hidden::ThreadPoolBackend>());
+}
+
+/// shutdown async io namespace, pending reads are finished and their callbacks run first
+void AsyncIo::Shutdown()
+{
+    L_ASSERT(Hidden::gAsyncIoState);
+    {
+        std::unique_lock<std::mutex> lock(Hidden::gAsyncIoState->mMutex);
+        Hidden::gAsyncIoState->mCondition.wait(lock, []()
+        {
+            return Hidden::gAsyncIoState->mPendingCount == 0 && Hidden::gAsyncIoState->mOperations.empty() && Hidden::gAsyncIoState->mDispatchers == 0;
+        });
+    }
+    Update();
+    Hidden::gAsyncIoState.reset();
+}
+
+/// submit a read of buffer.size() bytes at an offset of a file, the buffer must stay valid until the request is retired
+Id::Type AsyncIo::Read(const std::filesystem::path &path, size_t offset, std::span<byte> buffer, Priority priority, Callback &&callback)
+{
+    L_ASSERT(Hidden::gAsyncIoState);
+    Id::Type id;
+    {
+        std::lock_guard<std::mutex> lock(Hidden::gAsyncIoState->mMutex);
+        id = Hidden::gAsyncIoState->mRequestIds.Next();
+        Hidden::AsyncRequest &request = Hidden::gAsyncIoState->mRequests.emplace(id, Hidden::AsyncRequest { path, offset, buffer, std::move(callback) }).first->second;
+        Hidden::gAsyncIoState->mQueues[static_cast<size_t>(priority)].push_back(id);
+        Hidden::gAsyncIoState->mQueuedByOffset.emplace(std::make_pair(request.mPath.native(), offset), id);
+        ++Hidden::gAsyncIoState->mPendingCount;
+        ++Hidden::gAsyncIoState->mDispatchers;
+    }
+    Hidden::Dispatch(*Hidden::gAsyncIoState);
+    return id;
+}
+
+/// checks if a request is done, retired requests are done
+bool AsyncIo::Done(Id::Type request)
+{
+    L_ASSERT(Hidden::gAsyncIoState);
+    std::lock_guard<std::mutex> lock(Hidden::gAsyncIoState->mMutex);
+    auto it = Hidden::gAsyncIoState->mRequests.find(request);
+    return it == Hidden::gAsyncIoState->mRequests.end() || it->second.mDone;
+}
+
+/// wait for a request and retire it, running its callback, returns the bytes read or SIZE_MAX if it failed or was already retired
+size_t AsyncIo::Wait(Id::Type request)
+{
+    L_ASSERT(Hidden::gAsyncIoState);
+    Hidden::AsyncRequest retired;
+    {
+        std::unique_lock<std::mutex> lock(Hidden::gAsyncIoState->mMutex);
+        // another thread may retire the request while this one waits
+        auto &requests = Hidden::gAsyncIoState->mRequests;
+        auto it = requests.end();
+        Hidden::gAsyncIoState->mCondition.wait(lock, [&requests, &it, request]()
+        {
+            it = requests.find(request);
+            return it == requests.end() || it->second.mDone;
+        });
+        if (it == requests.end())
+        {
+            return SIZE_MAX;
+        }
+        retired = std::move(it->second);
+        requests.erase(it);
+        std::erase(Hidden::gAsyncIoState->mCompleted, request);
+    }
+    if (retired.mCallback)
+    {
+        retired.mCallback(request, retired.mSize);
+    }
+    return retired.mSize;
+}
+
+/// retire the requests that are done, running their callbacks on the calling thread
+void AsyncIo::Update()
+{
+    L_ASSERT(Hidden::gAsyncIoState);
+    std::vector<std::pair<Id::Type, Hidden::AsyncRequest>> retired;
+    {
+        std::lock_guard<std::mutex> lock(Hidden::gAsyncIoState->mMutex);
+        retired.reserve(Hidden::gAsyncIoState->mCompleted.size());
+        for (Id::Type id : Hidden::gAsyncIoState->mCompleted)
+        {
+            auto it = Hidden::gAsyncIoState->mRequests.find(id);
+            retired.emplace_back(id, std::move(it->second));
+            Hidden::gAsyncIoState->mRequests.erase(it);
+        }
+        Hidden::gAsyncIoState->mCompleted.clear();
+    }
+    if (!retired.empty())
+    {
+        // threads waiting for a request retired here return
+        Hidden::gAsyncIoState->mCondition.notify_all();
+    }
+    for (auto &[id, request] : retired)
+    {
+        if (request.mCallback)
+        {
+            request.mCallback(id, request.mSize);
+        }
+    }
+}
+
+/// called by backends from any thread when an operation is done
+void AsyncIo::Complete(Operation &operation)
+{
+    L_ASSERT(Hidden::gAsyncIoState);
+    Hidden::AsyncOperation &asyncOperation = static_cast<Hidden::AsyncOperation &>(operation);
+
+    // scatter a merged read, a short read leaves the later requests short or empty
+    std::vector<size_t> sizes(asyncOperation.mTargets.size(), SIZE_MAX);
+    if (operation.mSize != SIZE_MAX)
+    {
+        size_t position = 0;
+        for (size_t i = 0; i < asyncOperation.mTargets.size(); ++i)
+        {
+            sizes[i] = std::min(asyncOperation.mTargets[i].size(), operation.mSize - std::min(position, operation.mSize));
+            if (!asyncOperation.mMergeBuffer.empty())
+            {
+                memcpy(asyncOperation.mTargets[i].data(), asyncOperation.mMergeBuffer.data() + position, sizes[i]);
+            }
+            position += asyncOperation.mTargets[i].size();
+        }
+    }
+
+    Hidden::AsyncIoState &state = *Hidden::gAsyncIoState;
+    {
+        std::lock_guard<std::mutex> lock(state.mMutex);
+        for (size_t i = 0; i < asyncOperation.mRequests.size(); ++i)
+        {
+            Hidden::AsyncRequest &request = state.mRequests.at(asyncOperation.mRequests[i]);
+            request.mSize = sizes[i];
+            request.mDone = true;
+            state.mCompleted.push_back(asyncOperation.mRequests[i]);
+        }
+        state.mPendingCount -= asyncOperation.mRequests.size();
+        state.mOperations.remove_if([&asyncOperation](const Hidden::AsyncOperation &entry) { return &entry == &asyncOperation; });
+        ++state.mDispatchers;
+    }
+    Hidden::Dispatch(state);
+}
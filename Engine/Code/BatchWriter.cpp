@@ -0,0 +1,157 @@
+//==============================================================================================================================================================================
+/// \file
+/// \brief     batch writer
+/// \copyright Copyright (c) Gustavo Goedert. All rights reserved.
+//==============================================================================================================================================================================
+
+#include "lBatchWriter.h"
+#include "lThreadPool.h"
+
+/// \cond
+#include <condition_variable>
+#include <mutex>
+#include <unordered_set>
+/// \endcond
+
+using namespace Lumen;
+
+/// BatchWriter::Impl class
+class BatchWriter::Impl
+{
+    CLASS_NO_DEFAULT_CTOR(Impl);
+    CLASS_NO_COPY_MOVE(Impl);
+    CLASS_PTR_UNIQUEMAKER(Impl);
+    friend class BatchWriter;
+
+public:
+    /// constructs a batch writer
+    explicit Impl(FileSystem::Durability durability) : mDurability(durability) {}
+
+    /// destructor, finishes the batch
+    ~Impl()
+    {
+        Finish();
+    }
+
+    /// queue a whole file write, a path written again in the same batch keeps the last data
+    void Write(const std::filesystem::path &path, std::vector<byte> &&data)
+    {
+        bool start;
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mQueue.push_back({ path, std::move(data) });
+            start = !mWriting;
+            mWriting = true;
+        }
+
+        // one task at a time writes the queue, so writes of a path land in order
+        if (start)
+        {
+            ThreadPool::Submit([this]() { Drain(); });
+        }
+    }
+
+    /// wait for the queued writes and replace their files, returns false if any file was not written
+    bool Finish()
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        mCondition.wait(lock, [this]() { return !mWriting; });
+        bool result = FileSystem::CommitAside(mWritten, mDurability) && !mFailed;
+        mWritten.clear();
+        mWrittenSet.clear();
+        mFailed = false;
+        return result;
+    }
+
+private:
+    /// PendingWrite struct
+    struct PendingWrite
+    {
+        /// path
+        std::filesystem::path mPath;
+
+        /// data
+        std::vector<byte> mData;
+    };
+
+    /// write the queue aside until it is empty, on a thread pool worker
+    void Drain()
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        while (!mQueue.empty())
+        {
+            std::vector<PendingWrite> writes;
+            writes.swap(mQueue);
+            lock.unlock();
+            std::vector<bool> written(writes.size());
+            for (size_t i = 0; i < writes.size(); ++i)
+            {
+                written[i] = FileSystem::WriteAside(writes[i].mPath, writes[i].mData);
+            }
+            lock.lock();
+            for (size_t i = 0; i < writes.size(); ++i)
+            {
+                if (!written[i])
+                {
+                    mFailed = true;
+                }
+                else if (mWrittenSet.insert(writes[i].mPath.native()).second)
+                {
+                    mWritten.push_back(std::move(writes[i].mPath));
+                }
+            }
+        }
+        mWriting = false;
+        mCondition.notify_all();
+    }
+
+    /// durability of the batch
+    const FileSystem::Durability mDurability;
+
+    /// mutex protecting the queue and the written paths
+    std::mutex mMutex;
+
+    /// signaled when the queue is written
+    std::condition_variable mCondition;
+
+    /// writes not yet started
+    std::vector<PendingWrite> mQueue;
+
+    /// whether a task is writing the queue
+    bool mWriting = false;
+
+    /// whether a write failed
+    bool mFailed = false;
+
+    /// paths written aside, in the order they were first written
+    std::vector<std::filesystem::path> mWritten;
+
+    /// paths written aside, for lookup
+    std::unordered_set<std::filesystem::path::string_type> mWrittenSet;
+};
+
+//==============================================================================================================================================================================
+
+/// constructs a batch writer
+BatchWriter::BatchWriter(FileSystem::Durability durability) : mImpl(BatchWriter::Impl::MakeUniquePtr(durability)) {}
+
+/// destructor, finishes the batch
+BatchWriter::~BatchWriter() = default;
+
+/// queue a whole file write, a path written again in the same batch keeps the last data
+void BatchWriter::Write(const std::filesystem::path &path, std::vector<byte> &&data)
+{
+    mImpl->Write(path, std::move(data));
+}
+
+/// queue serialized data encoded the way it is stored at a path
+void BatchWriter::WriteSerializedData(const std::filesystem::path &path, const Serialized::Type &data)
+{
+    mImpl->Write(path, FileSystem::EncodeSerializedData(path, data));
+}
+
+/// wait for the queued writes and replace their files, returns false if any file was not written
+bool BatchWriter::Finish()
+{
+    return mImpl->Finish();
+}
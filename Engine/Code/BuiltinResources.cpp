@@ -191,20 +191,20 @@ public:
     /// constructor
     explicit Impl(float priority)
     {
-        mAssetInfos.push_back(SphereMeshInfo::MakePtr());
-        mAssetInfos.push_back(CheckerGrayTextureInfo::MakePtr());
-        mAssetInfos.push_back(SimpleDiffuseShaderInfo::MakePtr());
+        Add(SphereMeshInfo::MakePtr());
+        Add(CheckerGrayTextureInfo::MakePtr());
+        Add(SimpleDiffuseShaderInfo::MakePtr());
     }
 
     /// destructor
     ~Impl() = default;
 
     /// check if asset exists
-    [[nodiscard]] bool Exists(const std::filesystem::path &path) const
+    [[nodiscard]] bool Exists(PathId path) const
     {
-        for (auto assetInfo : mAssetInfos)
+        for (auto &[assetPath, assetInfo] : mAssetInfos)
         {
-            if (assetInfo->Path() == path)
+            if (assetPath == path)
             {
                 return true;
             }
@@ -213,11 +213,11 @@ public:
     }
 
     /// import asset
-    [[nodiscard]] Expected<AssetPtr> Import(EngineWeakPtr &engine, HashType type, const std::filesystem::path &path) const
+    [[nodiscard]] Expected<AssetPtr> Import(EngineWeakPtr &engine, HashType type, PathId path) const
     {
-        for (auto assetInfo : mAssetInfos)
+        for (auto &[assetPath, assetInfo] : mAssetInfos)
         {
-            if ((assetInfo->Type() == type) && (assetInfo->Path() == path))
+            if ((assetInfo->Type() == type) && (assetPath == path))
             {
                 auto assetExpected = assetInfo->Import(engine);
                 if (assetExpected)
@@ -230,12 +230,18 @@ public:
                 }
             }
         }
-        return Expected<AssetPtr>::Unexpected(std::format("Unable to load builtin resource, {}", path.string()));
+        return Expected<AssetPtr>::Unexpected(std::format("Unable to load builtin resource, {}", path.String()));
     }
 
 private:
-    /// asset infos
-    std::vector<AssetInfoOldPtr> mAssetInfos;
+    /// add an asset info
+    void Add(const AssetInfoOldPtr &assetInfo)
+    {
+        mAssetInfos.emplace_back(PathId::Intern(assetInfo->Path()), assetInfo);
+    }
+
+    /// asset infos, by interned path
+    std::vector<std::pair<PathId, AssetInfoOldPtr>> mAssetInfos;
 };
 
 //==============================================================================================================================================================================
@@ -250,13 +256,13 @@ AssetFactoryOldPtr BuiltinResources::MakePtr(float priority)
 }
 
 /// check if asset exists
-[[nodiscard]] bool BuiltinResources::Exists(const std::filesystem::path &path) const
+[[nodiscard]] bool BuiltinResources::Exists(PathId path) const
 {
     return mImpl->Exists(path);
 }
 
 /// import asset
-Expected<AssetPtr> BuiltinResources::Import(EngineWeakPtr &engine, HashType type, const std::filesystem::path &path) const
+Expected<AssetPtr> BuiltinResources::Import(EngineWeakPtr &engine, HashType type, PathId path) const
 {
     return mImpl->Import(engine, type, path);
 }
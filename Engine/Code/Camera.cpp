@@ -20,15 +20,14 @@ public:
     /// constructs a camera
     explicit Impl() = default;
 
+    /// serialized fields
+    SERIALIZED_FIELDS(
+        SERIALIZED_FIELD(Impl, mBackgroundColor, "BackgroundColor", Math::Vector4(0.f, 0.f, 0.f, 0.f)));
+
     /// serialize
     void Serialize(Serialized::Type &out, bool packed) const
     {
-        // set background color
-        if (mBackgroundColor != Math::Vector4::cZero)
-        {
-            Serialized::SerializeValue(out, packed, Serialized::cBackgroundColorToken, Serialized::cBackgroundColorTokenPacked,
-                std::array { mBackgroundColor.x, mBackgroundColor.y, mBackgroundColor.z, mBackgroundColor.w });
-        }
+        Serialized::SerializeFields(out, packed, *this, SerializedFields());
 
         // if empty, set to object
         if (out.empty())
@@ -40,18 +39,7 @@ public:
     /// deserialize
     void Deserialize(const Serialized::Type &in, bool packed)
     {
-        Serialized::Type value;
-
-        // get background color
-        mBackgroundColor = Math::Vector4::cZero;
-        if (Serialized::DeserializeValue(in, packed, Serialized::cBackgroundColorToken, Serialized::cBackgroundColorTokenPacked, value))
-        {
-            if (value.size() != 4)
-            {
-                throw std::runtime_error(std::format("Unable to read Camera::BackgroundColor"));
-            }
-            mBackgroundColor = Math::Vector4 { value.get<std::vector<float>>().data() };
-        }
+        Serialized::DeserializeFields(in, packed, *this, SerializedFields(), "Camera");
     }
 
     /// get background color
@@ -102,4 +90,5 @@ const Math::Vector4 &Camera::GetBackgroundColor() const
 void Camera::SetBackgroundColor(const Math::Vector4 &backgroundColor)
 {
     mImpl->SetBackgroundColor(backgroundColor);
+    SetDirty();
 }
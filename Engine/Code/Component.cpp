@@ -31,12 +31,24 @@ public:
     /// get owning entity
     [[nodiscard]] EntityWeakPtr Entity() const { return mEntity; }
 
+    /// set changed marks
+    void SetDirty(DirtyMark::Type marks) { mDirty |= marks; }
+
+    /// check if the component changed since a mark was last cleared
+    [[nodiscard]] bool Dirty(DirtyMark::Type mark) const { return (mDirty & mark) != 0; }
+
+    /// clear changed marks
+    void ClearDirty(DirtyMark::Type marks) { mDirty &= ~marks; }
+
 private:
     /// name
     const std::string mName;
 
     /// owning entity
     EntityWeakPtr mEntity;
+
+    /// changed marks
+    DirtyMark::Type mDirty = 0;
 };
 
 //==============================================================================================================================================================================
@@ -59,3 +71,21 @@ EntityWeakPtr Component::Entity() const
 {
     return mImpl->Entity();
 }
+
+/// mark the component as changed, sets every changed mark
+void Component::SetDirty()
+{
+    mImpl->SetDirty(DirtyMark::cAll);
+}
+
+/// check if the component changed since a mark was last cleared, components that do not track their changes are always changed
+bool Component::Dirty(DirtyMark::Type mark) const
+{
+    return !TracksChanges() || mImpl->Dirty(mark);
+}
+
+/// clear changed marks, called by the consumers of changes
+void Component::ClearDirty(DirtyMark::Type marks)
+{
+    mImpl->ClearDirty(marks);
+}
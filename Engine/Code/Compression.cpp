@@ -0,0 +1,358 @@
+//==============================================================================================================================================================================
+/// \file
+/// \brief     block compression
+/// \copyright Copyright (c) Gustavo Goedert. All rights reserved.
+//==============================================================================================================================================================================
+
+#include "lCompression.h"
+#include "lThreadPool.h"
+
+/// \cond
+#include <atomic>
+#include <bit>
+/// \endcond
+
+using namespace Lumen;
+
+// the header and block table are read in place, the layout is little-endian
+static_assert(std::endian::native == std::endian::little, "compressed data requires a little-endian host");
+static_assert(sizeof(Compression::Header) == 20);
+
+/// Lumen Hidden namespace
+namespace Lumen::Hidden
+{
+    /// shortest match, a match is encoded as a 2 byte offset and a length
+    constexpr size_t cMinMatch = 4;
+
+    /// largest match offset
+    constexpr size_t cMaxOffset = 0xFFFF;
+
+    /// bytes at the end of a block that are always literals, so the match search can read whole sequences
+    constexpr size_t cLastLiterals = 5;
+
+    /// bits of the match finder hash table
+    constexpr size_t cHashBits = 14;
+
+    /// length nibble value that is extended by following bytes
+    constexpr size_t cLengthMask = 15;
+
+    /// read 4 bytes
+    static dword ReadSequence(const byte *ptr)
+    {
+        dword value;
+        memcpy(&value, ptr, sizeof(value));
+        return value;
+    }
+
+    /// hash a 4 byte sequence
+    static size_t HashSequence(dword sequence)
+    {
+        return (sequence * 2654435761u) >> (32 - cHashBits);
+    }
+
+    /// write the extension bytes of a length
+    static void WriteLength(std::vector<byte> &out, size_t length)
+    {
+        for (; length >= 255; length -= 255)
+        {
+            out.push_back(255);
+        }
+        out.push_back(static_cast<byte>(length));
+    }
+
+    /// read the extension bytes of a length
+    static bool ReadLength(std::span<const byte> in, size_t &position, size_t &length)
+    {
+        for (;;)
+        {
+            if (position >= in.size())
+            {
+                return false;
+            }
+            byte value = in[position++];
+            length += value;
+            if (value != 255)
+            {
+                return true;
+            }
+        }
+    }
+
+    /// write a sequence of literals followed by a match, a zero match length ends the block
+    static void WriteSequence(std::vector<byte> &out, std::span<const byte> literals, size_t offset, size_t matchLength)
+    {
+        size_t matchCode = matchLength ? matchLength - cMinMatch : 0;
+        out.push_back(static_cast<byte>((std::min(literals.size(), cLengthMask) << 4) | std::min(matchCode, cLengthMask)));
+        if (literals.size() >= cLengthMask)
+        {
+            WriteLength(out, literals.size() - cLengthMask);
+        }
+        out.insert(out.end(), literals.begin(), literals.end());
+        if (matchLength)
+        {
+            out.push_back(static_cast<byte>(offset));
+            out.push_back(static_cast<byte>(offset >> 8));
+            if (matchCode >= cLengthMask)
+            {
+                WriteLength(out, matchCode - cLengthMask);
+            }
+        }
+    }
+
+    /// compress a block, returns false if it does not get smaller
+    static bool CompressBlock(std::span<const byte> in, std::vector<byte> &out)
+    {
+        out.clear();
+        out.reserve(in.size());
+
+        // positions are stored plus one, zero is empty
+        std::vector<dword> table(size_t(1) << cHashBits, 0);
+        size_t matchLimit = in.size() > cLastLiterals ? in.size() - cLastLiterals : 0;
+        size_t anchor = 0;
+        size_t position = 0;
+        while (position + cMinMatch <= matchLimit)
+        {
+            dword sequence = ReadSequence(in.data() + position);
+            dword &entry = table[HashSequence(sequence)];
+            size_t candidate = entry;
+            entry = static_cast<dword>(position + 1);
+            if (candidate == 0 || position - (candidate - 1) > cMaxOffset || ReadSequence(in.data() + candidate - 1) != sequence)
+            {
+                // skip faster through data that does not match
+                position += 1 + ((position - anchor) >> 6);
+                continue;
+            }
+
+            // extend the match
+            size_t match = candidate - 1;
+            size_t length = cMinMatch;
+            while (position + length < matchLimit && in[match + length] == in[position + length])
+            {
+                ++length;
+            }
+            WriteSequence(out, in.subspan(anchor, position - anchor), position - match, length);
+            position += length;
+            anchor = position;
+            if (out.size() >= in.size())
+            {
+                return false;
+            }
+        }
+        WriteSequence(out, in.subspan(anchor), 0, 0);
+        return out.size() < in.size();
+    }
+
+    /// decompress a block, every read and write is bounds checked
+    static bool DecompressBlock(std::span<const byte> in, std::span<byte> out)
+    {
+        size_t inPosition = 0;
+        size_t outPosition = 0;
+        while (inPosition < in.size())
+        {
+            // literals
+            byte token = in[inPosition++];
+            size_t literalLength = token >> 4;
+            if (literalLength == cLengthMask && !ReadLength(in, inPosition, literalLength))
+            {
+                return false;
+            }
+            if (literalLength > in.size() - inPosition || literalLength > out.size() - outPosition)
+            {
+                return false;
+            }
+            memcpy(out.data() + outPosition, in.data() + inPosition, literalLength);
+            inPosition += literalLength;
+            outPosition += literalLength;
+
+            // the last sequence has no match
+            if (inPosition == in.size())
+            {
+                break;
+            }
+
+            // match
+            if (in.size() - inPosition < 2)
+            {
+                return false;
+            }
+            size_t offset = in[inPosition] | (size_t(in[inPosition + 1]) << 8);
+            inPosition += 2;
+            size_t matchLength = token & cLengthMask;
+            if (matchLength == cLengthMask && !ReadLength(in, inPosition, matchLength))
+            {
+                return false;
+            }
+            matchLength += cMinMatch;
+            if (offset == 0 || offset > outPosition || matchLength > out.size() - outPosition)
+            {
+                return false;
+            }
+            byte *target = out.data() + outPosition;
+            const byte *source = target - offset;
+            if (offset >= matchLength)
+            {
+                memcpy(target, source, matchLength);
+            }
+            else
+            {
+                // overlapping match repeats the last offset bytes
+                for (size_t i = 0; i < matchLength; ++i)
+                {
+                    target[i] = source[i];
+                }
+            }
+            outPosition += matchLength;
+        }
+        return outPosition == out.size();
+    }
+}
+
+/// checks if a buffer starts with a compressed data header
+bool Compression::IsCompressed(std::span<const byte> data)
+{
+    if (data.size() < sizeof(Header))
+    {
+        return false;
+    }
+    dword magic;
+    memcpy(&magic, data.data(), sizeof(magic));
+    return magic == cMagic;
+}
+
+/// compress data in independent blocks, blocks are compressed in parallel
+std::vector<byte> Compression::Compress(std::span<const byte> data, size_t blockSize)
+{
+    L_ASSERT(blockSize > 0 && blockSize < cStoredBlock);
+    L_ASSERT_MSG(data.size() <= UINT32_MAX, "Compressed data is limited to 4GB");
+
+    // compress the blocks, a block that does not get smaller is stored
+    size_t blockCount = (data.size() + blockSize - 1) / blockSize;
+    std::vector<std::vector<byte>> blocks(blockCount);
+    std::vector<dword> table(blockCount);
+    ThreadPool::ParallelFor(blockCount, [&](size_t i)
+    {
+        std::span<const byte> in = data.subspan(i * blockSize, std::min(blockSize, data.size() - i * blockSize));
+        if (Hidden::CompressBlock(in, blocks[i]))
+        {
+            table[i] = static_cast<dword>(blocks[i].size());
+        }
+        else
+        {
+            blocks[i].assign(in.begin(), in.end());
+            table[i] = static_cast<dword>(blocks[i].size()) | cStoredBlock;
+        }
+    });
+
+    // header, block table, then blocks
+    Header header = { cMagic, cVersion, 0, static_cast<dword>(data.size()), static_cast<dword>(blockSize), static_cast<dword>(blockCount) };
+    size_t size = sizeof(Header) + blockCount * sizeof(dword);
+    for (const std::vector<byte> &block : blocks)
+    {
+        size += block.size();
+    }
+    std::vector<byte> out;
+    out.reserve(size);
+    const byte *headerBytes = reinterpret_cast<const byte *>(&header);
+    out.insert(out.end(), headerBytes, headerBytes + sizeof(Header));
+    const byte *tableBytes = reinterpret_cast<const byte *>(table.data());
+    out.insert(out.end(), tableBytes, tableBytes + table.size() * sizeof(dword));
+    for (const std::vector<byte> &block : blocks)
+    {
+        out.insert(out.end(), block.begin(), block.end());
+    }
+    return out;
+}
+
+/// decompress data, blocks are decompressed in parallel
+bool Compression::Decompress(std::span<const byte> data, std::vector<byte> &out)
+{
+    View view;
+    if (!view.Open(data))
+    {
+        return false;
+    }
+    out.resize(view.Size());
+    std::atomic<bool> result = true;
+    ThreadPool::ParallelFor(view.BlockCount(), [&](size_t i)
+    {
+        if (!view.DecompressBlock(i, std::span<byte>(out).subspan(view.BlockOffset(i), view.BlockSize(i))))
+        {
+            result = false;
+        }
+    });
+    if (!result)
+    {
+        DebugLog::Error("Compressed data has a corrupt block");
+        out.clear();
+        return false;
+    }
+    return true;
+}
+
+/// opens a view on compressed data, the data must outlive the view
+bool Compression::View::Open(std::span<const byte> data)
+{
+    *this = View();
+
+    // validate header
+    if (!IsCompressed(data) || reinterpret_cast<uintptr_t>(data.data()) % alignof(Header) != 0)
+    {
+        DebugLog::Error("Compressed data has an invalid header");
+        return false;
+    }
+    const Header *header = reinterpret_cast<const Header *>(data.data());
+    if (header->mVersion != cVersion)
+    {
+        DebugLog::Error("Compressed data version {} is not supported", header->mVersion);
+        return false;
+    }
+    if (header->mBlockSize == 0 || header->mBlockSize >= cStoredBlock ||
+        header->mBlockCount != (size_t(header->mSize) + header->mBlockSize - 1) / header->mBlockSize ||
+        header->mBlockCount > (data.size() - sizeof(Header)) / sizeof(dword))
+    {
+        DebugLog::Error("Compressed data has an invalid block table");
+        return false;
+    }
+
+    // validate the blocks and resolve their offsets
+    const dword *blocks = reinterpret_cast<const dword *>(data.data() + sizeof(Header));
+    std::vector<size_t> offsets(header->mBlockCount);
+    size_t offset = sizeof(Header) + header->mBlockCount * sizeof(dword);
+    for (dword i = 0; i < header->mBlockCount; ++i)
+    {
+        size_t blockSize = blocks[i] & ~cStoredBlock;
+        size_t uncompressedSize = std::min<size_t>(header->mBlockSize, header->mSize - size_t(i) * header->mBlockSize);
+        if (blockSize > data.size() - offset || ((blocks[i] & cStoredBlock) && blockSize != uncompressedSize))
+        {
+            DebugLog::Error("Compressed data block {} is invalid", i);
+            return false;
+        }
+        offsets[i] = offset;
+        offset += blockSize;
+    }
+
+    mHeader = header;
+    mBlocks = blocks;
+    mOffsets = std::move(offsets);
+    mData = data;
+    return true;
+}
+
+/// uncompressed size of a block
+size_t Compression::View::BlockSize(size_t index) const
+{
+    return std::min<size_t>(mHeader->mBlockSize, mHeader->mSize - BlockOffset(index));
+}
+
+/// decompress a block, out must hold BlockSize(index) bytes
+bool Compression::View::DecompressBlock(size_t index, std::span<byte> out) const
+{
+    L_ASSERT(index < BlockCount() && out.size() == BlockSize(index));
+    std::span<const byte> in = mData.subspan(mOffsets[index], mBlocks[index] & ~cStoredBlock);
+    if (mBlocks[index] & cStoredBlock)
+    {
+        memcpy(out.data(), in.data(), in.size());
+        return true;
+    }
+    return Hidden::DecompressBlock(in, out);
+}
@@ -0,0 +1,151 @@
+//==============================================================================================================================================================================
+/// \file
+/// \brief     content cache
+/// \copyright Copyright (c) Gustavo Goedert. All rights reserved.
+//==============================================================================================================================================================================
+
+#include "lContentCache.h"
+#include "lContentHasher.h"
+
+using namespace Lumen;
+
+/// Lumen Hidden namespace
+namespace Lumen::Hidden
+{
+    /// check if a path is in a folder or its subfolders, walking up the interned parents
+    static bool InFolder(PathId path, PathId folder)
+    {
+        for (PathId parent = path.Parent(); parent.Valid(); parent = parent.Parent())
+        {
+            if (parent == folder)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+}
+
+/// constructs a cache with a budget in bytes
+ContentCache::ContentCache(size_t budget) : mBudget(budget) {}
+
+/// find the content of a path, null if it is not cached
+ContentCache::ContentPtr ContentCache::Find(PathId path)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto it = mIndex.find(path);
+    if (it == mIndex.end())
+    {
+        ++mStats.mMisses;
+        return {};
+    }
+    ++mStats.mHits;
+    mEntries.splice(mEntries.begin(), mEntries, it->second);
+    return it->second->mContent;
+}
+
+/// get the invalidation generation, taken before reading content that is stored afterwards
+qword ContentCache::Generation() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mGeneration;
+}
+
+/// store the content of a path read at a generation, it is not stored if anything was invalidated since or it is too large
+void ContentCache::Insert(PathId path, std::span<const byte> data, qword generation)
+{
+    if (data.size() > MaxContentSize())
+    {
+        return;
+    }
+
+    // copied and hashed outside the lock
+    auto content = std::make_shared<Content>();
+    content->mData.assign(data.begin(), data.end());
+    content->mHash = ContentHasher::Hash(data);
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (generation != mGeneration || mBudget == 0)
+    {
+        return;
+    }
+    if (auto it = mIndex.find(path); it != mIndex.end())
+    {
+        Erase(it->second);
+    }
+    mEntries.push_front({ path, content });
+    mIndex.emplace(path, mEntries.begin());
+    mStats.mBytes += content->mData.size();
+    ++mStats.mEntries;
+    Trim();
+}
+
+/// drop the content of a path
+void ContentCache::Invalidate(PathId path)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    ++mGeneration;
+    if (auto it = mIndex.find(path); it != mIndex.end())
+    {
+        Erase(it->second);
+        ++mStats.mInvalidations;
+    }
+}
+
+/// drop the content of every path in a folder and its subfolders
+void ContentCache::InvalidateFolder(PathId folder)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    ++mGeneration;
+    for (auto it = mEntries.begin(); it != mEntries.end();)
+    {
+        auto next = std::next(it);
+        if (Hidden::InFolder(it->mPath, folder))
+        {
+            Erase(it);
+            ++mStats.mInvalidations;
+        }
+        it = next;
+    }
+}
+
+/// set the budget in bytes, zero disables the cache
+void ContentCache::SetBudget(size_t budget)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mBudget = budget;
+    Trim();
+}
+
+/// largest content stored, a fraction of the budget so one file cannot flush the cache
+size_t ContentCache::MaxContentSize() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mBudget / 16;
+}
+
+/// get the counters
+ContentCache::Stats ContentCache::GetStats() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mStats;
+}
+
+/// drop the least recently used entries until the cache is in budget, the mutex must be held
+void ContentCache::Trim()
+{
+    while (mStats.mBytes > mBudget && !mEntries.empty())
+    {
+        Erase(std::prev(mEntries.end()));
+        ++mStats.mEvictions;
+    }
+}
+
+/// drop an entry, the mutex must be held
+void ContentCache::Erase(std::list<Entry>::iterator it)
+{
+    mStats.mBytes -= it->mContent->mData.size();
+    --mStats.mEntries;
+    mIndex.erase(it->mPath);
+    mEntries.erase(it);
+}
@@ -0,0 +1,222 @@
+//==============================================================================================================================================================================
+/// \file
+/// \brief     content hasher
+/// \copyright Copyright (c) Gustavo Goedert. All rights reserved.
+//==============================================================================================================================================================================
+
+#include "lContentHasher.h"
+
+/// \cond
+#include <bit>
+/// \endcond
+
+using namespace Lumen;
+
+// stripes are read as little-endian words, so every host and simd path gives the same hash
+static_assert(std::endian::native == std::endian::little, "content hashes require a little-endian host");
+
+/// Lumen Hidden namespace
+namespace Lumen::Hidden
+{
+    /// 32 bit multiplier of the scramble
+    constexpr qword cContentPrime32 = 0x9E3779B1;
+
+    /// 64 bit multiplier of the length
+    constexpr qword cContentPrime64 = 0x9E3779B185EBCA87;
+
+    /// offset of the key of the zero padded last stripe
+    constexpr size_t cContentTailKey = 16;
+
+    /// offset of the scramble key
+    constexpr size_t cContentScrambleKey = 24;
+
+    /// offset of the merge key
+    constexpr size_t cContentMergeKey = 17;
+
+    /// key table, stripe n of a block uses the 8 words from n, so reordered stripes hash differently
+    constexpr std::array<qword, 32> cContentKeys = []
+    {
+        // splitmix64 sequence
+        std::array<qword, 32> keys = {};
+        qword state = 0x4C554D454E484153;
+        for (qword &key : keys)
+        {
+            state += 0x9E3779B97F4A7C15;
+            qword z = state;
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EB;
+            key = z ^ (z >> 31);
+        }
+        return keys;
+    }();
+
+    /// accumulate a stripe, each lane adds the product of the low and high halves of its keyed word and the word of its neighbor
+    static inline void ContentAccumulate(qword *accumulators, const byte *stripe, const qword *keys)
+    {
+#if defined(SIMDSSE2)
+        __m128i *acc = reinterpret_cast<__m128i *>(accumulators);
+        for (size_t i = 0; i < 4; ++i)
+        {
+            __m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i *>(stripe) + i);
+            __m128i keyed = _mm_xor_si128(data, _mm_loadu_si128(reinterpret_cast<const __m128i *>(keys) + i));
+            __m128i product = _mm_mul_epu32(keyed, _mm_shuffle_epi32(keyed, _MM_SHUFFLE(0, 3, 0, 1)));
+            __m128i swapped = _mm_shuffle_epi32(data, _MM_SHUFFLE(1, 0, 3, 2));
+            acc[i] = _mm_add_epi64(acc[i], _mm_add_epi64(product, swapped));
+        }
+#elif defined(SIMDNEON)
+        for (size_t i = 0; i < 4; ++i)
+        {
+            uint64x2_t data = vreinterpretq_u64_u8(vld1q_u8(stripe + i * 16));
+            uint64x2_t keyed = veorq_u64(data, vld1q_u64(keys + i * 2));
+            uint64x2_t product = vmull_u32(vmovn_u64(keyed), vshrn_n_u64(keyed, 32));
+            uint64x2_t swapped = vextq_u64(data, data, 1);
+            vst1q_u64(accumulators + i * 2, vaddq_u64(vld1q_u64(accumulators + i * 2), vaddq_u64(product, swapped)));
+        }
+#else
+        for (size_t i = 0; i < 8; ++i)
+        {
+            qword data;
+            memcpy(&data, stripe + i * 8, sizeof(qword));
+            qword keyed = data ^ keys[i];
+            accumulators[i ^ 1] += data;
+            accumulators[i] += (keyed & 0xFFFFFFFF) * (keyed >> 32);
+        }
+#endif
+    }
+
+    /// scramble the accumulators at the end of a block
+    static inline void ContentScramble(qword *accumulators)
+    {
+        const qword *keys = cContentKeys.data() + cContentScrambleKey;
+#if defined(SIMDSSE2)
+        __m128i *acc = reinterpret_cast<__m128i *>(accumulators);
+        const __m128i prime = _mm_set1_epi32(static_cast<int>(cContentPrime32));
+        for (size_t i = 0; i < 4; ++i)
+        {
+            __m128i value = _mm_xor_si128(acc[i], _mm_srli_epi64(acc[i], 47));
+            value = _mm_xor_si128(value, _mm_loadu_si128(reinterpret_cast<const __m128i *>(keys) + i));
+            __m128i low = _mm_mul_epu32(value, prime);
+            __m128i high = _mm_mul_epu32(_mm_srli_epi64(value, 32), prime);
+            acc[i] = _mm_add_epi64(low, _mm_slli_epi64(high, 32));
+        }
+#elif defined(SIMDNEON)
+        const uint32x2_t prime = vdup_n_u32(static_cast<uint32_t>(cContentPrime32));
+        for (size_t i = 0; i < 4; ++i)
+        {
+            uint64x2_t value = vld1q_u64(accumulators + i * 2);
+            value = veorq_u64(value, vshrq_n_u64(value, 47));
+            value = veorq_u64(value, vld1q_u64(keys + i * 2));
+            uint64x2_t low = vmull_u32(vmovn_u64(value), prime);
+            uint64x2_t high = vmull_u32(vshrn_n_u64(value, 32), prime);
+            vst1q_u64(accumulators + i * 2, vaddq_u64(low, vshlq_n_u64(high, 32)));
+        }
+#else
+        for (size_t i = 0; i < 8; ++i)
+        {
+            qword value = accumulators[i];
+            value ^= value >> 47;
+            value ^= keys[i];
+            accumulators[i] = value * cContentPrime32;
+        }
+#endif
+    }
+
+    /// multiply to 128 bits and fold the halves
+    static inline qword ContentMulFold(qword a, qword b)
+    {
+        qword lowLow = (a & 0xFFFFFFFF) * (b & 0xFFFFFFFF);
+        qword highLow = (a >> 32) * (b & 0xFFFFFFFF);
+        qword lowHigh = (a & 0xFFFFFFFF) * (b >> 32);
+        qword highHigh = (a >> 32) * (b >> 32);
+        qword cross = (lowLow >> 32) + (highLow & 0xFFFFFFFF) + lowHigh;
+        qword upper = (highLow >> 32) + (cross >> 32) + highHigh;
+        qword lower = (cross << 32) | (lowLow & 0xFFFFFFFF);
+        return lower ^ upper;
+    }
+}
+
+/// default constructor
+ContentHasher::ContentHasher() :
+    mAccumulators { 0x9E3779B1, 0x9E3779B185EBCA87, 0xC2B2AE3D27D4EB4F, 0x165667B19E3779F9, 0x85EBCA77C2B2AE63, 0x85EBCA77, 0x27D4EB2F165667C5, 0x61C8864F }
+{
+}
+
+/// hash more data
+void ContentHasher::Update(std::span<const byte> data)
+{
+    mLength += data.size();
+
+    // complete the partial stripe first
+    if (mBufferSize > 0)
+    {
+        size_t count = std::min(cStripeSize - mBufferSize, data.size());
+        memcpy(mBuffer + mBufferSize, data.data(), count);
+        mBufferSize += count;
+        data = data.subspan(count);
+        if (mBufferSize < cStripeSize)
+        {
+            return;
+        }
+        Hidden::ContentAccumulate(mAccumulators, mBuffer, Hidden::cContentKeys.data() + mStripe);
+        mBufferSize = 0;
+        if (++mStripe == cBlockStripes)
+        {
+            Hidden::ContentScramble(mAccumulators);
+            mStripe = 0;
+        }
+    }
+
+    // whole stripes are read in place
+    const byte *stripe = data.data();
+    const byte *end = stripe + (data.size() / cStripeSize) * cStripeSize;
+    for (; stripe < end; stripe += cStripeSize)
+    {
+        Hidden::ContentAccumulate(mAccumulators, stripe, Hidden::cContentKeys.data() + mStripe);
+        if (++mStripe == cBlockStripes)
+        {
+            Hidden::ContentScramble(mAccumulators);
+            mStripe = 0;
+        }
+    }
+    mBufferSize = data.size() % cStripeSize;
+    if (mBufferSize > 0)
+    {
+        memcpy(mBuffer, end, mBufferSize);
+    }
+}
+
+/// get the hash of all data so far, more data can still be added
+Hash64 ContentHasher::Finish() const
+{
+    // the last partial stripe is padded with zeros, the length tells it apart from real zeros
+    alignas(16) qword accumulators[8];
+    memcpy(accumulators, mAccumulators, sizeof(accumulators));
+    if (mBufferSize > 0)
+    {
+        alignas(16) byte stripe[cStripeSize] = {};
+        memcpy(stripe, mBuffer, mBufferSize);
+        Hidden::ContentAccumulate(accumulators, stripe, Hidden::cContentKeys.data() + Hidden::cContentTailKey);
+    }
+
+    // merge the accumulators
+    const qword *keys = Hidden::cContentKeys.data() + Hidden::cContentMergeKey;
+    qword hash = mLength * Hidden::cContentPrime64;
+    for (size_t i = 0; i < 8; i += 2)
+    {
+        hash += Hidden::ContentMulFold(accumulators[i] ^ keys[i], accumulators[i + 1] ^ keys[i + 1]);
+    }
+
+    // avalanche
+    hash ^= hash >> 37;
+    hash *= 0x165667919E3779F9;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+/// hash data in one call
+Hash64 ContentHasher::Hash(std::span<const byte> data)
+{
+    ContentHasher hasher;
+    hasher.Update(data);
+    return hasher.Finish();
+}
@@ -9,6 +9,8 @@
 
 /// \cond
 #include <deque>
+#include <mutex>
+#include <thread>
 /// \endcond
 
 using namespace Lumen;
@@ -19,24 +21,56 @@ namespace Lumen::Hidden
     /// maximum callback log size
     constexpr size_t MaxCallbackLogSize = 256;
 
-    /// log callback
+    /// mutex protecting the callback, its thread and the callback log
+    std::mutex gLogMutex;
+
+    /// log callback, only changed from the thread it is called on
     DebugLog::LogCallback gLogCallback = nullptr;
 
-    /// keep recent log messages waiting for callback to be set
+    /// thread that set the log callback, the only one it is called on
+    std::thread::id gLogCallbackThread;
+
+    /// keep recent log messages waiting for callback to be set, or logged from other threads and waiting for the callback thread
     std::deque<std::pair<DebugLog::LogLevel, std::string>> gCallbackLog;
+
+    /// send the stored callback log messages to the callback, from the callback thread
+    static void FlushCallbackLog()
+    {
+        std::deque<std::pair<DebugLog::LogLevel, std::string>> callbackLog;
+        {
+            std::lock_guard<std::mutex> lock(gLogMutex);
+            if (!gLogCallback || gLogCallbackThread != std::this_thread::get_id())
+            {
+                return;
+            }
+            callbackLog.swap(gCallbackLog);
+        }
+
+        // called without the lock, so the callback can log
+        for (auto &[level, message] : callbackLog)
+        {
+            gLogCallback(level, message);
+        }
+    }
 }
 
-/// set log callback
+/// set log callback, it is only called on this thread
 void DebugLog::SetCallback(LogCallback callback)
 {
-    Hidden::gLogCallback = callback;
-
-    // sent stored callback log messages to callback
-    for (auto &[level, message] : Hidden::gCallbackLog)
     {
-        Hidden::gLogCallback(level, message);
+        std::lock_guard<std::mutex> lock(Hidden::gLogMutex);
+        Hidden::gLogCallback = callback;
+        Hidden::gLogCallbackThread = std::this_thread::get_id();
     }
-    Hidden::gCallbackLog.clear();
+
+    // sent stored callback log messages to callback
+    Hidden::FlushCallbackLog();
+}
+
+/// send the messages logged from other threads to the callback, from the thread that set it
+void DebugLog::Update()
+{
+    Hidden::FlushCallbackLog();
 }
 
 void DebugLog::LogImpl(LogLevel level, std::string_view format, std::format_args args)
@@ -62,19 +96,26 @@ void DebugLog::LogImpl(LogLevel level, std::string_view format, std::format_args
     fullMessage += std::vformat(format, args);
     Engine::DebugOutput(fullMessage);
 
-    // either callback log message, or store to callback later
+    // either callback log message, or store to callback later, messages from other threads wait for the callback thread
     std::string_view message(fullMessage);
     message.remove_prefix(prefix.size());
-    if (Hidden::gLogCallback)
+    bool callback;
     {
-        Hidden::gLogCallback(level, message);
-    }
-    else
-    {
-        if (Hidden::gCallbackLog.size() >= Hidden::MaxCallbackLogSize)
+        std::lock_guard<std::mutex> lock(Hidden::gLogMutex);
+        callback = Hidden::gLogCallback && Hidden::gLogCallbackThread == std::this_thread::get_id();
+        if (!callback)
         {
-            Hidden::gCallbackLog.pop_front();
+            if (Hidden::gCallbackLog.size() >= Hidden::MaxCallbackLogSize)
+            {
+                Hidden::gCallbackLog.pop_front();
+            }
+            Hidden::gCallbackLog.emplace_back(level, message);
         }
-        Hidden::gCallbackLog.emplace_back(level, message);
+    }
+    if (callback)
+    {
+        // messages stored earlier go first, so the callback sees them in order
+        Hidden::FlushCallbackLog();
+        Hidden::gLogCallback(level, message);
     }
 }
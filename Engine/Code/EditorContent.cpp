@@ -7,6 +7,7 @@
 
 #include "lEditorContent.h"
 #include "lAssetManager.h"
+#include "lBatchWriter.h"
 #include "lImGuiLib.h"
 #include "lNodeForest.h"
 
@@ -432,6 +433,8 @@ public:
 #if TEST_VERSION == 2
 #elif TEST_VERSION == 1
 #else //TEST_VERSION == 0
+        // content hashes of handled modifications are written together, on the main thread like every other infofile write
+        BatchWriter infoWriter(FileSystem::Durability::Cached);
         for (auto item : assetBatch)
         {
             std::filesystem::path oldFilePath = item.mOldName;
@@ -475,6 +478,7 @@ public:
 
             case FileSystem::Change::Modified:
                 DebugLog::Info("Modified: {}", item.mName);
+                StoreContentHash(item, infoWriter);
                 break;
 
             case FileSystem::Change::Renamed:
@@ -542,9 +546,29 @@ public:
                 break;
             }
         }
+        if (!infoWriter.Finish())
+        {
+            DebugLog::Error("Unable to store the content hashes of modified assets");
+        }
 #endif
     }
 
+    /// store the content hash of a handled modification in its infofile, so touching the file without changing it is ignored from now on
+    static void StoreContentHash(const FileSystem::AssetChange &assetChange, BatchWriter &infoWriter)
+    {
+        if (assetChange.mContentHash == 0)
+        {
+            return;
+        }
+        Expected<AssetInfoPtr> assetInfo = AssetInfo::MakePtr(assetChange.mName);
+        if (!assetInfo || !assetInfo.Value()->Load() || assetInfo.Value()->ContentHash() == assetChange.mContentHash)
+        {
+            return;
+        }
+        assetInfo.Value()->SetContentHash(assetChange.mContentHash);
+        assetInfo.Value()->Save(infoWriter);
+    }
+
     /// run editor content
     void Run()
     {
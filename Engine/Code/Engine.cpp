@@ -8,11 +8,19 @@
 #include "lSceneManager.h"
 #include "lFileSystemResources.h"
 #include "lBuiltinResources.h"
+#include "lThreadPool.h"
+#include "lAsyncIo.h"
+#ifdef __linux__
+#include "lIoUringBackend.h"
+#endif
 
 #include "EnginePlatform.h"
 
 /// \cond
+#include <chrono>
+#include <iomanip>
 #include <random>
+#include <sstream>
 /// \endcond
 
 using namespace Lumen;
@@ -48,12 +56,20 @@ public:
     /// initialization and management
     bool Initialize(const Object &config)
     {
+        ThreadPool::Initialize();
+
         //AssetManagerOld::Initialize(shared_from_this());
         AssetManagerOld::Initialize(mOwner);
         AssetManagerOld::RegisterFactory(FileSystemResources::MakePtr(1.0f));
         AssetManagerOld::RegisterFactory(BuiltinResources::MakePtr(0.1f));
 
         FileSystem::Initialize(mOwner);
+#ifdef __linux__
+        // reads go through io_uring where the kernel allows it, the thread pool otherwise
+        AsyncIo::Initialize(Linux::IoUringBackend::MakePtr());
+#else
+        AsyncIo::Initialize();
+#endif
         SceneManager::Initialize();
 
         if (!mApplication)
@@ -63,7 +79,11 @@ public:
         using clock = std::chrono::system_clock;
         auto time = clock::to_time_t(clock::now());
         std::tm timeInfo;
+#ifdef _WIN32
         localtime_s(&timeInfo, &time);
+#else
+        localtime_r(&time, &timeInfo);
+#endif
         std::ostringstream oss;
         oss << std::put_time(&timeInfo, "%Y-%m-%d");
         DebugLog::Info("[{}] Engine initialized in editor mode", oss.str());
@@ -100,10 +120,13 @@ public:
             mApplication->Shutdown();
 
         SceneManager::Shutdown();
+        AsyncIo::Shutdown();
         FileSystem::Shutdown();
 
         AssetManagerOld::Shutdown();
 
+        ThreadPool::Shutdown();
+
         mPlatform->Shutdown();
     }
 
@@ -129,6 +152,12 @@ public:
         FileSystem::ProcessFileChanges();
 #endif
 
+        // run completion callbacks of async reads
+        AsyncIo::Update();
+
+        // deliver the log messages of worker threads
+        DebugLog::Update();
+
         // run application
         if (mApplication)
         {
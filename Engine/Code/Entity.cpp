@@ -66,16 +66,23 @@ public:
     /// deserialize
     void Deserialize(const Serialized::Type &in, bool packed)
     {
+        Serialized::Reader reader(in, packed);
+
         // get transform
-        Serialized::Type inTransform = {};
-        Serialized::DeserializeValue(in, packed, Serialized::cTransformToken, Serialized::cTransformTokenPacked, inTransform);
-        mTransform->Deserialize(inTransform, packed);
+        if (const Serialized::Type *inTransform = reader.Find(Serialized::cTransformToken, Serialized::cTransformTokenPacked))
+        {
+            mTransform->Deserialize(*inTransform, packed);
+        }
+        else
+        {
+            mTransform->Deserialize(Serialized::Type {}, packed);
+        }
 
         // get components
         mComponents.clear();
-        Serialized::Type inComponents = {};
-        if (Serialized::DeserializeValue(in, packed, Serialized::cComponentsToken, Serialized::cComponentsTokenPacked, inComponents))
+        if (const Serialized::Type *inComponentsPtr = reader.Find(Serialized::cComponentsToken, Serialized::cComponentsTokenPacked))
         {
+            const Serialized::Type &inComponents = *inComponentsPtr;
             if (packed)
             {
                 if (!inComponents.is_array())
@@ -105,6 +112,90 @@ public:
         }
     }
 
+    /// serialize into a packed scene
+    void Serialize(PackedScene::Writer &out) const
+    {
+        // add entity with transform record
+        PackedScene::TransformRecord transform;
+        mTransform->Serialize(transform);
+        out.AddEntity(mName, transform);
+
+        // add component blobs
+        for (const ComponentWeakPtr &component : mComponents)
+        {
+            auto componentPtr = component.lock();
+            L_ASSERT(componentPtr);
+            Serialized::Type outComponent = {};
+            componentPtr->Serialize(outComponent, true);
+            out.AddComponent(componentPtr->Type(), Serialized::Type::to_cbor(outComponent));
+        }
+    }
+
+    /// deserialize an entity record of a packed scene, the decoded components of the record are given in order
+    void Deserialize(const PackedScene::View &in, size_t index, std::span<const Serialized::Type> components)
+    {
+        // get transform
+        mTransform->Deserialize(in.Transform(index));
+
+        // get components
+        mComponents.clear();
+        const PackedScene::EntityRecord &entity = in.Entity(index);
+        L_ASSERT(components.size() == entity.mComponentCount);
+        for (dword i = 0; i < entity.mComponentCount; ++i)
+        {
+            auto component = AddComponent(mOwner, in.Component(entity.mFirstComponent + i).mType);
+            component.lock()->Deserialize(components[i], true);
+        }
+    }
+
+    /// restore an entity record of a packed scene in place, only the transform and components changed since the last snapshot are deserialized,
+    /// components that do not track their changes are deserialized when their state differs from the record
+    bool Restore(const PackedScene::View &in, size_t index)
+    {
+        // components added since the snapshot, or a different component list, need a new entity
+        const PackedScene::EntityRecord &entity = in.Entity(index);
+        if ((mDirty & DirtyMark::cSnapshot) || mComponents.size() != entity.mComponentCount)
+        {
+            return false;
+        }
+        for (dword i = 0; i < entity.mComponentCount; ++i)
+        {
+            auto componentPtr = mComponents[i].lock();
+            if (!componentPtr || componentPtr->Type() != in.Component(entity.mFirstComponent + i).mType)
+            {
+                return false;
+            }
+        }
+
+        // get transform
+        if (mTransform->Dirty(DirtyMark::cSnapshot))
+        {
+            mTransform->Deserialize(in.Transform(index));
+        }
+
+        // get components
+        for (dword i = 0; i < entity.mComponentCount; ++i)
+        {
+            auto componentPtr = mComponents[i].lock();
+            if (!componentPtr->Dirty(DirtyMark::cSnapshot))
+            {
+                continue;
+            }
+            std::span<const byte> blob = in.Blob(in.Component(entity.mFirstComponent + i));
+            if (!componentPtr->TracksChanges())
+            {
+                Serialized::Type current = {};
+                componentPtr->Serialize(current, true);
+                if (std::ranges::equal(Serialized::Type::to_cbor(current), blob))
+                {
+                    continue;
+                }
+            }
+            componentPtr->Deserialize(Serialized::Type::from_cbor(blob.begin(), blob.end()), true);
+        }
+        return true;
+    }
+
     /// get transform
     [[nodiscard]] Application &GetApplication() { return mApplication; }
 
@@ -120,6 +211,12 @@ public:
     /// add a component
     [[maybe_unused]] ComponentWeakPtr AddComponent(const EntityWeakPtr &entity, Hash type);
 
+    /// check if the entity, its transform or any of its components changed since a mark was last cleared
+    [[nodiscard]] bool Dirty(DirtyMark::Type mark) const;
+
+    /// clear changed marks of the entity, its transform and its components
+    void ClearDirty(DirtyMark::Type marks);
+
 protected:
     /// called on state change
     void OnState(Lumen::Application::State newState);
@@ -142,6 +239,9 @@ private:
 
     /// components
     std::vector<ComponentWeakPtr> mComponents;
+
+    /// changed marks, set when components are added
+    DirtyMark::Type mDirty = 0;
 };
 
 /// constructs a entity
@@ -181,6 +281,38 @@ ComponentWeakPtr Entity::Impl::AddComponent(const EntityWeakPtr &entity, Hash ty
     return component;
 }
 
+/// check if the entity, its transform or any of its components changed since a mark was last cleared
+bool Entity::Impl::Dirty(DirtyMark::Type mark) const
+{
+    if ((mDirty & mark) || mTransform->Dirty(mark))
+    {
+        return true;
+    }
+    for (const ComponentWeakPtr &component : mComponents)
+    {
+        auto componentPtr = component.lock();
+        L_ASSERT(componentPtr);
+        if (componentPtr->Dirty(mark))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/// clear changed marks of the entity, its transform and its components
+void Entity::Impl::ClearDirty(DirtyMark::Type marks)
+{
+    mDirty &= ~marks;
+    mTransform->ClearDirty(marks);
+    for (const ComponentWeakPtr &component : mComponents)
+    {
+        auto componentPtr = component.lock();
+        L_ASSERT(componentPtr);
+        componentPtr->ClearDirty(marks);
+    }
+}
+
 /// called on state change
 void Entity::Impl::OnState(Lumen::Application::State newState)
 {
@@ -242,6 +374,24 @@ void Entity::Deserialize(const Serialized::Type &in, bool packed)
     mImpl->Deserialize(in, packed);
 }
 
+/// serialize into a packed scene
+void Entity::Serialize(PackedScene::Writer &out) const
+{
+    mImpl->Serialize(out);
+}
+
+/// deserialize an entity record of a packed scene, the decoded components of the record are given in order
+void Entity::Deserialize(const PackedScene::View &in, size_t index, std::span<const Serialized::Type> components)
+{
+    mImpl->Deserialize(in, index, components);
+}
+
+/// restore an entity record of a packed scene in place, only the transform and components changed since the last snapshot are deserialized
+bool Entity::Restore(const PackedScene::View &in, size_t index)
+{
+    return mImpl->Restore(in, index);
+}
+
 /// get application
 Application &Entity::GetApplication()
 {
@@ -269,9 +419,28 @@ ComponentWeakPtr Entity::Component(Hash type) const
 /// add a component
 ComponentWeakPtr Entity::AddComponent(Hash type)
 {
+    mImpl->mDirty = DirtyMark::cAll;
     return mImpl->AddComponent(shared_from_this(), type);
 }
 
+/// mark the entity as changed, sets every changed mark
+void Entity::SetDirty()
+{
+    mImpl->mDirty = DirtyMark::cAll;
+}
+
+/// check if the entity, its transform or any of its components changed since a mark was last cleared
+bool Entity::Dirty(DirtyMark::Type mark) const
+{
+    return mImpl->Dirty(mark);
+}
+
+/// clear changed marks of the entity, its transform and its components
+void Entity::ClearDirty(DirtyMark::Type marks)
+{
+    mImpl->ClearDirty(marks);
+}
+
 /// called on state change
 void Entity::OnState(Lumen::Application::State newState)
 {
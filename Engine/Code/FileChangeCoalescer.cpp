@@ -0,0 +1,112 @@
+//==============================================================================================================================================================================
+/// \file
+/// \brief     file change coalescer
+/// \copyright Copyright (c) Gustavo Goedert. All rights reserved.
+//==============================================================================================================================================================================
+
+#include "lFileChangeCoalescer.h"
+
+using namespace Lumen;
+
+/// add a change, coalescing it with the pending change of the same file
+void FileChangeCoalescer::Push(FileSystem::Change change, FileSystem::Flags flags, std::string name)
+{
+    if (auto it = mBatchIndex.find(name); it != mBatchIndex.end())
+    {
+        FileSystem::FileChange &pending = mBatch[it->second];
+        switch (change)
+        {
+        case FileSystem::Change::Added:
+            if (pending.mChange == FileSystem::Change::Added)
+            {
+                // reported by both a folder walk and its event
+                return;
+            }
+            if (pending.mChange == FileSystem::Change::Removed && pending.mFlags == flags && flags.Has(FileSystem::Flag::File))
+            {
+                // saved by replacing the file
+                pending.mChange = FileSystem::Change::Modified;
+                return;
+            }
+            break;
+        case FileSystem::Change::Modified:
+            if (pending.mChange == FileSystem::Change::Added || pending.mChange == FileSystem::Change::Modified)
+            {
+                // a file found unchanged by a scan is not anymore
+                pending.mFlags &= ~FileSystem::Flags(FileSystem::Flag::Unchanged);
+                return;
+            }
+            break;
+        case FileSystem::Change::Removed:
+            if (pending.mChange == FileSystem::Change::Added)
+            {
+                // never seen, drop both
+                pending.mName.clear();
+                mBatchIndex.erase(it);
+                return;
+            }
+            if (pending.mChange == FileSystem::Change::Modified)
+            {
+                pending.mChange = FileSystem::Change::Removed;
+                pending.mFlags = flags;
+                return;
+            }
+            break;
+        default:
+            break;
+        }
+    }
+    mBatchIndex[name] = mBatch.size();
+    mBatch.push_back({ change, flags, std::move(name), "" });
+}
+
+/// add a rename, a file added and renamed before being taken is just added
+void FileChangeCoalescer::PushRename(FileSystem::Flags flags, std::string name, std::string oldName)
+{
+    if (auto it = mBatchIndex.find(oldName); it != mBatchIndex.end() && mBatch[it->second].mChange == FileSystem::Change::Added)
+    {
+        mBatch[it->second].mName.clear();
+        mBatchIndex.erase(it);
+        Push(FileSystem::Change::Added, flags, std::move(name));
+        return;
+    }
+
+    // changes are not coalesced across a rename
+    mBatchIndex.erase(oldName);
+    mBatchIndex.erase(name);
+    mBatch.push_back({ FileSystem::Change::Renamed, flags, std::move(name), std::move(oldName) });
+}
+
+/// add a file change of any kind
+void FileChangeCoalescer::Push(FileSystem::FileChange &&fileChange)
+{
+    if (fileChange.mChange == FileSystem::Change::Renamed)
+    {
+        PushRename(fileChange.mFlags, std::move(fileChange.mName), std::move(fileChange.mOldName));
+    }
+    else
+    {
+        Push(fileChange.mChange, fileChange.mFlags, std::move(fileChange.mName));
+    }
+}
+
+/// move the pending changes to the end of a batch
+void FileChangeCoalescer::Take(std::vector<FileSystem::FileChange> &fileBatch)
+{
+    fileBatch.reserve(fileBatch.size() + mBatch.size());
+    for (FileSystem::FileChange &fileChange : mBatch)
+    {
+        if (!fileChange.mName.empty())
+        {
+            fileBatch.push_back(std::move(fileChange));
+        }
+    }
+    Clear();
+}
+
+/// drop the pending changes
+void FileChangeCoalescer::Clear()
+{
+    mBatch.clear();
+    mBatchIndex.clear();
+}
@@ -0,0 +1,423 @@
+//==============================================================================================================================================================================
+/// \file
+/// \brief     file index
+/// \copyright Copyright (c) Gustavo Goedert. All rights reserved.
+//==============================================================================================================================================================================
+
+#include "lFileIndex.h"
+#include "lContentHasher.h"
+#include "lThreadPool.h"
+
+/// \cond
+#include <condition_variable>
+#include <fstream>
+#include <mutex>
+#include <unordered_set>
+/// \endcond
+
+using namespace Lumen;
+
+/// Lumen Hidden namespace
+namespace Lumen::Hidden
+{
+    /// size of the chunks files are hashed in
+    constexpr size_t cIndexHashChunkSize = 1 << 20;
+
+    /// state of a scanned record compared to the index
+    enum class IndexState : byte { Added, Unchanged, Check };
+
+    /// append a value to an index buffer
+    template<typename T>
+    static void IndexWrite(std::vector<byte> &out, const T &value)
+    {
+        const byte *data = reinterpret_cast<const byte *>(&value);
+        out.insert(out.end(), data, data + sizeof(T));
+    }
+
+    /// read a value from an index buffer
+    template<typename T>
+    static bool IndexRead(std::span<const byte> &in, T &value)
+    {
+        if (in.size() < sizeof(T))
+        {
+            return false;
+        }
+        memcpy(&value, in.data(), sizeof(T));
+        in = in.subspan(sizeof(T));
+        return true;
+    }
+
+    /// list a folder with the cached directory entry data, its folders are returned to be listed next
+    /// returns false if the folder could not be listed whole, the entries listed before the error are still returned
+    static bool IndexScanFolder(const std::filesystem::path &root, const std::string &relative, std::vector<FileIndex::Record> &records, std::vector<std::string> &folders)
+    {
+        std::error_code error;
+        std::filesystem::directory_iterator it(root / relative, error), end;
+        for (; !error && it != end; it.increment(error))
+        {
+            const std::filesystem::directory_entry &entry = *it;
+            std::string name = entry.path().filename().generic_string();
+            if (!relative.empty())
+            {
+                name = relative + "/" + name;
+            }
+            std::error_code entryError;
+            if (entry.is_directory(entryError))
+            {
+                records.push_back({ name, FileSystem::Flag::Directory, 0, 0, 0 });
+                if (!entry.is_symlink(entryError))
+                {
+                    folders.push_back(std::move(name));
+                }
+            }
+            else if (entry.is_regular_file(entryError))
+            {
+                qword size = entry.file_size(entryError);
+                qword time = static_cast<qword>(entry.last_write_time(entryError).time_since_epoch().count());
+                records.push_back({ std::move(name), FileSystem::Flag::File, size, time, 0 });
+            }
+        }
+        if (error)
+        {
+            Lumen::DebugLog::Error("Unable to list folder {}, {}", (root / relative).string(), error.message());
+            return false;
+        }
+        return true;
+    }
+
+    /// hash the content of a file, zero if it cannot be read
+    static Hash64 IndexHashFile(const std::filesystem::path &path)
+    {
+        std::ifstream file(path, std::ios::binary);
+        if (!file.is_open())
+        {
+            return 0;
+        }
+        ContentHasher hasher;
+        std::vector<byte> buffer(cIndexHashChunkSize);
+        while (file.read(reinterpret_cast<char *>(buffer.data()), buffer.size()) || file.gcount() > 0)
+        {
+            hasher.Update(std::span<const byte>(buffer.data(), static_cast<size_t>(file.gcount())));
+        }
+        return file.bad() ? 0 : hasher.Finish();
+    }
+}
+
+/// walk struct, the state of a scan shared by its folder tasks
+struct FileIndex::Walk
+{
+    /// constructs a walk of a folder
+    explicit Walk(const std::filesystem::path &folder, ChunkCallback &&callback) : mFolder(folder), mCallback(std::move(callback)) {}
+
+    /// folder scanned
+    const std::filesystem::path mFolder;
+
+    /// chunk callback
+    const ChunkCallback mCallback;
+
+    /// mutex protecting the rest of the walk
+    std::mutex mMutex;
+
+    /// signaled when the walk finishes
+    std::condition_variable mFinishedCondition;
+
+    /// folders queued but not listed yet
+    size_t mPending = 1;
+
+    /// whether the walk finished
+    bool mFinished = false;
+
+    /// records scanned so far, in no order
+    std::vector<Record> mRecords;
+
+    /// changes not reported yet
+    std::vector<FileSystem::FileChange> mChunk;
+
+    /// folders that could not be listed whole, their unlisted records are kept from the index
+    std::unordered_set<std::string> mFailedFolders;
+};
+
+/// default constructor
+FileIndex::FileIndex() = default;
+
+/// destructor, waits for a scan in progress
+FileIndex::~FileIndex()
+{
+    Wait();
+}
+
+/// load an index, returns false and leaves the index empty if it is missing or invalid
+bool FileIndex::Load(const std::filesystem::path &indexPath)
+{
+    Wait();
+    mRecords.clear();
+    std::ifstream file(indexPath, std::ios::binary | std::ios::ate);
+    if (!file.is_open())
+    {
+        return false;
+    }
+    std::vector<byte> data(static_cast<size_t>(file.tellg()));
+    file.seekg(0, std::ios::beg);
+    if (!file.read(reinterpret_cast<char *>(data.data()), data.size()))
+    {
+        return false;
+    }
+
+    // header
+    std::span<const byte> in(data);
+    dword magic = 0;
+    word version = 0, reserved = 0;
+    qword count = 0;
+    if (!Hidden::IndexRead(in, magic) || !Hidden::IndexRead(in, version) || !Hidden::IndexRead(in, reserved) || !Hidden::IndexRead(in, count) ||
+        magic != cMagic || version != cVersion)
+    {
+        return false;
+    }
+
+    // records, they must still be sorted
+    std::vector<Record> records;
+    records.reserve(static_cast<size_t>(std::min<qword>(count, in.size() / (sizeof(dword) + sizeof(byte) + 3 * sizeof(qword)))));
+    for (qword i = 0; i < count; ++i)
+    {
+        dword nameSize = 0;
+        byte flags = 0;
+        Record record;
+        if (!Hidden::IndexRead(in, nameSize) || !Hidden::IndexRead(in, flags) || !Hidden::IndexRead(in, record.mSize) ||
+            !Hidden::IndexRead(in, record.mTime) || !Hidden::IndexRead(in, record.mHash) || in.size() < nameSize)
+        {
+            return false;
+        }
+        record.mName.assign(reinterpret_cast<const char *>(in.data()), nameSize);
+        record.mFlags = FileSystem::Flags(flags);
+        in = in.subspan(nameSize);
+        if (!records.empty() && !(records.back().mName < record.mName))
+        {
+            return false;
+        }
+        records.push_back(std::move(record));
+    }
+    mRecords = std::move(records);
+    return true;
+}
+
+/// save the index
+bool FileIndex::Save(const std::filesystem::path &indexPath) const
+{
+    std::vector<byte> out;
+    Hidden::IndexWrite(out, cMagic);
+    Hidden::IndexWrite(out, cVersion);
+    Hidden::IndexWrite(out, word(0));
+    Hidden::IndexWrite(out, static_cast<qword>(mRecords.size()));
+    for (const Record &record : mRecords)
+    {
+        Hidden::IndexWrite(out, static_cast<dword>(record.mName.size()));
+        Hidden::IndexWrite(out, record.mFlags.Value());
+        Hidden::IndexWrite(out, record.mSize);
+        Hidden::IndexWrite(out, record.mTime);
+        Hidden::IndexWrite(out, record.mHash);
+        out.insert(out.end(), reinterpret_cast<const byte *>(record.mName.data()), reinterpret_cast<const byte *>(record.mName.data()) + record.mName.size());
+    }
+
+    // written aside and renamed over the old index, so an interrupted save keeps the old one
+    std::filesystem::path tempPath = indexPath;
+    tempPath += ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if (!file.write(reinterpret_cast<const char *>(out.data()), out.size()))
+        {
+            return false;
+        }
+    }
+    std::error_code error;
+    std::filesystem::rename(tempPath, indexPath, error);
+    return !error;
+}
+
+/// scan a folder and report what changed since the index, then update the index to the scan
+void FileIndex::Update(const std::filesystem::path &folder, std::vector<FileSystem::FileChange> &fileBatch)
+{
+    UpdateAsync(folder, [&fileBatch](std::vector<FileSystem::FileChange> &&chunk)
+    {
+        std::move(chunk.begin(), chunk.end(), std::back_inserter(fileBatch));
+    });
+    Wait();
+}
+
+/// start scanning a folder on the thread pool and report what changed since the index a chunk at a time, then update the index to the scan
+void FileIndex::UpdateAsync(const std::filesystem::path &folder, ChunkCallback &&callback)
+{
+    Wait();
+    mWalk = std::make_unique<Walk>(folder, std::move(callback));
+    ThreadPool::Submit([this, &walk = *mWalk]() { ScanFolder(walk, ""); });
+}
+
+/// wait for a scan started by UpdateAsync to finish
+void FileIndex::Wait()
+{
+    if (!mWalk)
+    {
+        return;
+    }
+    {
+        std::unique_lock<std::mutex> lock(mWalk->mMutex);
+        mWalk->mFinishedCondition.wait(lock, [this]() { return mWalk->mFinished; });
+    }
+    mWalk.reset();
+}
+
+/// list a folder of a scan, compare it to the index and queue its subfolders
+void FileIndex::ScanFolder(Walk &walk, const std::string &relative)
+{
+    std::vector<Record> records;
+    std::vector<std::string> folders;
+    bool listed = Hidden::IndexScanFolder(walk.mFolder, relative, records, folders);
+
+    // each entry is looked up in the index, which is sorted and not changed until the walk finishes
+    std::vector<Hidden::IndexState> states(records.size(), Hidden::IndexState::Added);
+    std::vector<Hash64> oldHashes(records.size(), 0);
+    std::vector<size_t> checks;
+    std::vector<const Record *> replaced;
+    for (size_t i = 0; i < records.size(); ++i)
+    {
+        Record &record = records[i];
+        auto oldIt = std::lower_bound(mRecords.begin(), mRecords.end(), record.mName, [](const Record &old, const std::string &name) { return old.mName < name; });
+        if (oldIt == mRecords.end() || oldIt->mName != record.mName)
+        {
+            continue;
+        }
+        if (oldIt->mFlags != record.mFlags)
+        {
+            // replaced by a different kind of entry
+            replaced.push_back(&*oldIt);
+        }
+        else if (oldIt->mSize == record.mSize && oldIt->mTime == record.mTime)
+        {
+            states[i] = Hidden::IndexState::Unchanged;
+            record.mHash = oldIt->mHash;
+        }
+        else
+        {
+            states[i] = Hidden::IndexState::Check;
+            oldHashes[i] = oldIt->mHash;
+            checks.push_back(i);
+        }
+    }
+
+    // only files that were touched are hashed, in parallel
+    ThreadPool::ParallelFor(checks.size(), [&](size_t index)
+    {
+        Record &record = records[checks[index]];
+        record.mHash = Hidden::IndexHashFile(walk.mFolder / record.mName);
+    });
+
+    // report, a replaced entry is removed before its replacement is added, every file present is added so listeners can rebuild their state,
+    // and the ones that did not change are flagged
+    std::vector<FileSystem::FileChange> changes;
+    changes.reserve(replaced.size() + records.size());
+    for (const Record *record : replaced)
+    {
+        changes.push_back({ FileSystem::Change::Removed, record->mFlags, (walk.mFolder / record->mName).string(), "" });
+    }
+    for (size_t i = 0; i < records.size(); ++i)
+    {
+        const Record &record = records[i];
+        bool unchanged = states[i] == Hidden::IndexState::Unchanged ||
+            (states[i] == Hidden::IndexState::Check && record.mHash != 0 && record.mHash == oldHashes[i]);
+        changes.push_back({ FileSystem::Change::Added, unchanged ? record.mFlags | FileSystem::Flag::Unchanged : record.mFlags, (walk.mFolder / record.mName).string(), "" });
+    }
+
+    // the folder goes into the chunk whole, so an asset and its infofile are never split, and only then are its subfolders queued
+    bool last = false;
+    {
+        std::lock_guard<std::mutex> lock(walk.mMutex);
+        if (!listed)
+        {
+            walk.mFailedFolders.insert(relative);
+        }
+        std::move(changes.begin(), changes.end(), std::back_inserter(walk.mChunk));
+        std::move(records.begin(), records.end(), std::back_inserter(walk.mRecords));
+        if (walk.mChunk.size() >= cChunkSize)
+        {
+            walk.mCallback(std::move(walk.mChunk));
+            walk.mChunk.clear();
+        }
+        walk.mPending += folders.size();
+        last = --walk.mPending == 0;
+    }
+    for (std::string &folder : folders)
+    {
+        ThreadPool::Submit([this, &walk, folder = std::move(folder)]() { ScanFolder(walk, folder); });
+    }
+    if (last)
+    {
+        FinishWalk(walk);
+    }
+}
+
+/// report the removed records once every folder of a scan is listed, and update the index to the scan
+void FileIndex::FinishWalk(Walk &walk)
+{
+    std::vector<Record> records = std::move(walk.mRecords);
+    auto byName = [](const Record &a, const Record &b) { return a.mName < b.mName; };
+    std::sort(records.begin(), records.end(), byName);
+
+    // both lists are sorted, so a merge finds the removed records, the contents of a removed folder are not reported, like a folder moved away
+    // records missing from a folder that could not be listed are kept as they were, with everything under them, instead of being removed
+    std::vector<Record> kept;
+    {
+        std::unordered_set<std::string_view> removedFolders;
+        std::unordered_set<std::string_view> keptFolders;
+        auto it = records.begin();
+        for (const Record &old : mRecords)
+        {
+            for (; it != records.end() && it->mName < old.mName; ++it)
+            {
+            }
+            if (it != records.end() && it->mName == old.mName)
+            {
+                if (it->mFlags != old.mFlags && old.mFlags.Has(FileSystem::Flag::Directory))
+                {
+                    // reported when its replacement was listed
+                    removedFolders.insert(old.mName);
+                }
+                continue;
+            }
+            size_t separator = old.mName.rfind('/');
+            std::string_view parent = separator != std::string::npos ? std::string_view(old.mName).substr(0, separator) : std::string_view();
+            if (walk.mFailedFolders.contains(std::string(parent)) || keptFolders.contains(parent))
+            {
+                if (old.mFlags.Has(FileSystem::Flag::Directory))
+                {
+                    keptFolders.insert(old.mName);
+                }
+                kept.push_back(old);
+                continue;
+            }
+            bool inRemovedFolder = separator != std::string::npos && removedFolders.contains(parent);
+            if (old.mFlags.Has(FileSystem::Flag::Directory))
+            {
+                removedFolders.insert(old.mName);
+            }
+            if (!inRemovedFolder)
+            {
+                walk.mChunk.push_back({ FileSystem::Change::Removed, old.mFlags, (walk.mFolder / old.mName).string(), "" });
+            }
+        }
+    }
+    if (!walk.mChunk.empty())
+    {
+        walk.mCallback(std::move(walk.mChunk));
+        walk.mChunk.clear();
+    }
+    if (!kept.empty())
+    {
+        size_t middle = records.size();
+        std::move(kept.begin(), kept.end(), std::back_inserter(records));
+        std::inplace_merge(records.begin(), records.begin() + middle, records.end(), byName);
+    }
+    mRecords = std::move(records);
+
+    std::lock_guard<std::mutex> lock(walk.mMutex);
+    walk.mFinished = true;
+    walk.mFinishedCondition.notify_all();
+}
@@ -5,9 +5,27 @@
 //==============================================================================================================================================================================
 
 #include "lFileSystem.h"
-#include "lStringMap.h"
 #include "lConcurrentBatchQueue.h"
+#include "lCompression.h"
+#include "lContentCache.h"
+#include "lContentHasher.h"
 #include "lEngine.h"
+#include "lPathId.h"
+#ifdef EDITOR
+#include "lAssetInfo.h"
+#include "lFileChangeCoalescer.h"
+#include "lLockFreeQueue.h"
+#endif
+
+/// \cond
+#include <atomic>
+#include <bit>
+#include <condition_variable>
+#include <deque>
+#include <set>
+#include <shared_mutex>
+#include <thread>
+/// \endcond
 
 using namespace Lumen;
 
@@ -16,6 +34,90 @@ constexpr std::chrono::milliseconds InfoDelay { 500 };
 /// Lumen Hidden namespace
 namespace Lumen::Hidden
 {
+    /// bits of a file handle that index its slot, the high bits hold the slot generation
+    constexpr size_t cHandleSlotBits = sizeof(Id::Type) * 4;
+
+    /// mask of the slot bits of a file handle
+    constexpr Id::Type cHandleSlotMask = (Id::Type(1) << cHandleSlotBits) - 1;
+
+    /// bits of a slot that pick its shard, each thread reserves slots from its own shard
+    constexpr size_t cHandleShardBits = 4;
+
+    /// number of handle shards
+    constexpr size_t cHandleShardCount = size_t(1) << cHandleShardBits;
+
+    /// bits of a slot that index it within its shard
+    constexpr size_t cHandleIndexBits = cHandleSlotBits - cHandleShardBits;
+
+    /// bits of a slot index that pick its place in a chunk, up to 1024 slots and half the index bits when handles are narrow
+    constexpr size_t cHandleChunkBits = std::min<size_t>(10, cHandleIndexBits / 2);
+
+    /// slots per chunk, chunks never move so slots are found without locking
+    constexpr size_t cHandleChunkSize = size_t(1) << cHandleChunkBits;
+
+    /// most chunks of a shard, up to 1024 and as many as the remaining index bits address
+    constexpr size_t cHandleChunkCount = size_t(1) << std::min<size_t>(10, cHandleIndexBits - cHandleChunkBits);
+
+    // every slot of every shard fits in the slot bits, so handles never alias
+    static_assert(cHandleShardBits + std::countr_zero(cHandleChunkSize * cHandleChunkCount) <= cHandleSlotBits);
+
+    /// default budget of the content cache
+    constexpr size_t cContentCacheBudget = size_t(16) << 20;
+
+    /// open file handle slot, everything but the generation is only touched by the thread using the handle
+    struct HandleSlot
+    {
+        /// file system owning the open file, null while the slot is free or only reserved
+        IFileSystemPtr mFileSystem;
+
+        /// generation, advanced when the slot is released so stale handles do not resolve
+        std::atomic<Id::Type> mGeneration = 0;
+
+        /// data of a mapped file
+        std::span<const byte> mMappedData;
+
+        /// copy of a mapped file whose file system cannot map
+        std::vector<byte> mMappedCopy;
+
+        /// cached content of a file mapped from the content cache, such handles have no file system
+        ContentCache::ContentPtr mCachedContent;
+
+        /// path of a file opened for writing, its cached content is dropped once it is closed
+        PathId mWritePath;
+    };
+
+    /// path characters in the native encoding, so paths are matched without converting them
+    using PathView = std::basic_string_view<std::filesystem::path::value_type>;
+
+    /// handle shard struct, on its own cache line
+    struct alignas(64) HandleShard
+    {
+        /// mutex protecting the free slots and the growth of the chunks
+        std::mutex mMutex;
+
+        /// chunks of slots, published once allocated
+        std::array<std::atomic<HandleSlot *>, cHandleChunkCount> mChunks = {};
+
+        /// storage of the chunks
+        std::vector<std::unique_ptr<HandleSlot[]>> mChunkStorage;
+
+        /// number of slots in the chunks
+        size_t mSlotCount = 0;
+
+        /// free slots, by index in the shard
+        std::vector<size_t> mFreeSlots;
+    };
+
+    /// mounted file system
+    struct Mount
+    {
+        /// normalized mount point with a trailing slash, in the native encoding
+        std::filesystem::path::string_type mPrefix;
+
+        /// file system
+        IFileSystemPtr mFileSystem;
+    };
+
     /// file sytem state struct
     struct FileSytemState
     {
@@ -27,93 +129,805 @@ namespace Lumen::Hidden
         /// engine pointer
         EngineWeakPtr mEngine;
 
-        /// file id generator
-        Id::Generator mFileIdGenerator;
+        /// open file handle slots, sharded by the low bits of a handle
+        std::array<HandleShard, cHandleShardCount> mHandleShards;
 
-        /// file change mapFileChange
-        std::multimap<std::chrono::system_clock::time_point, FileSystem::AssetChange> mAssetChangeMap;
+        /// next shard given to a thread
+        std::atomic<size_t> mNextHandleShard = 0;
 
-        /// file systems
-        StringMap<IFileSystemPtr> mFileSystems;
+        /// mutex protecting the mounts, only registering takes it exclusively
+        std::shared_mutex mMountMutex;
+
+        /// mounted file systems, longest mount point first
+        std::vector<Mount> mMounts;
+
+        /// compress binary data written to packed file systems
+        std::atomic<bool> mCompressPacked = false;
+
+        /// cache of small file contents, by normalized path
+        ContentCache mContentCache { cContentCacheBudget };
     };
 
     /// global file state
     static std::unique_ptr<FileSytemState> gFileSytemState;
 
-    /// checks if a path starts with a prefix
-    bool StartsWith(const std::filesystem::path &path, const std::filesystem::path &prefix)
+    /// handle shard of the calling thread
+    thread_local size_t tHandleShard = SIZE_MAX;
+
+    /// find the file system of the longest mount point prefixing a path and the path relative to it, without allocating
+    static IFileSystemPtr ResolveMount(const std::filesystem::path &path, PathView &relative)
     {
-        std::string pathStr = path.string();
-        std::string prefixStr = prefix.string();
-        for (auto itPath = pathStr.begin(), itPrefix = prefixStr.begin(); itPrefix != prefixStr.end(); ++itPath, ++itPrefix)
+        PathView native = path.native();
+        std::shared_lock<std::shared_mutex> lock(gFileSytemState->mMountMutex);
+        for (const Mount &mount : gFileSytemState->mMounts)
         {
-            if (itPath == pathStr.end() || *itPath != *itPrefix)
+            if (native.starts_with(mount.mPrefix))
             {
-                return false;
+                relative = native.substr(mount.mPrefix.size());
+                return mount.mFileSystem;
             }
         }
+        return {};
+    }
+
+    /// find the slot of a handle, null if the handle is stale or invalid, no lock is taken
+    static HandleSlot *FindSlot(Id::Type handle)
+    {
+        size_t slot = handle & cHandleSlotMask;
+        size_t index = slot >> cHandleShardBits;
+        if (index / cHandleChunkSize >= cHandleChunkCount)
+        {
+            return nullptr;
+        }
+        HandleShard &shard = gFileSytemState->mHandleShards[slot & (cHandleShardCount - 1)];
+        HandleSlot *chunk = shard.mChunks[index / cHandleChunkSize].load(std::memory_order_acquire);
+        if (!chunk)
+        {
+            return nullptr;
+        }
+        HandleSlot &handleSlot = chunk[index % cHandleChunkSize];
+        if (handleSlot.mGeneration.load(std::memory_order_acquire) != (handle >> cHandleSlotBits))
+        {
+            return nullptr;
+        }
+        return &handleSlot;
+    }
+
+    /// find the file system owning an open file handle
+    static IFileSystem *FindFileSystem(Id::Type handle)
+    {
+        L_ASSERT(gFileSytemState);
+        HandleSlot *handleSlot = FindSlot(handle);
+        if (!handleSlot)
+        {
+            return nullptr;
+        }
+        L_ASSERT(!handleSlot->mFileSystem || handleSlot->mFileSystem->Handles(handle));
+        return handleSlot->mFileSystem.get();
+    }
+
+    /// bind an open file handle to the file system that opened it
+    static HandleSlot &BindHandle(Id::Type handle, const IFileSystemPtr &fileSystem)
+    {
+        HandleSlot *handleSlot = FindSlot(handle);
+        L_ASSERT(handleSlot && !handleSlot->mFileSystem);
+        handleSlot->mFileSystem = fileSystem;
+        return *handleSlot;
+    }
+
+    /// release the slot of a closed file handle
+    static void ReleaseHandle(Id::Type handle)
+    {
+        size_t slot = handle & cHandleSlotMask;
+        HandleSlot &handleSlot = *FindSlot(handle);
+        handleSlot.mFileSystem.reset();
+        handleSlot.mMappedData = {};
+        handleSlot.mMappedCopy = {};
+        handleSlot.mCachedContent.reset();
+        handleSlot.mWritePath = {};
+        handleSlot.mGeneration.store(((handle >> cHandleSlotBits) + 1) & cHandleSlotMask, std::memory_order_release);
+        HandleShard &shard = gFileSytemState->mHandleShards[slot & (cHandleShardCount - 1)];
+        std::lock_guard<std::mutex> lock(shard.mMutex);
+        shard.mFreeSlots.push_back(slot >> cHandleShardBits);
+    }
+
+    /// compress binary data if writing to a packed file system with compression enabled
+    static std::span<const byte> CompressPacked(const std::filesystem::path &path, std::span<const byte> data, std::vector<byte> &buffer)
+    {
+        if (gFileSytemState->mCompressPacked && !data.empty() && FileSystem::IsPacked(path))
+        {
+            buffer = Compression::Compress(data);
+            return buffer;
+        }
+        return data;
+    }
+
+    /// decompress mapped data into a buffer if it is compressed and point the data at it, uncompressed data is left as is
+    static bool Decompress(std::span<const byte> &data, std::vector<byte> &buffer)
+    {
+        if (!Compression::IsCompressed(data))
+        {
+            return true;
+        }
+        if (!Compression::Decompress(data, buffer))
+        {
+            return false;
+        }
+        data = buffer;
+        return true;
+    }
+
+    /// decompress binary data in place if it is compressed, uncompressed data is left as is
+    static bool Decompress(std::vector<byte> &data)
+    {
+        if (!Compression::IsCompressed(data))
+        {
+            return true;
+        }
+        std::vector<byte> out;
+        if (!Compression::Decompress(data, out))
+        {
+            return false;
+        }
+        data = std::move(out);
         return true;
     }
 
 #ifdef EDITOR
     /// file batch queue
     ConcurrentBatchQueue<FileSystem::FileChange> gFileBatchQueue;
-#endif
-}
 
-class HandleStreamBuf : public std::streambuf
-{
-public:
-    /// adjust buffer size based on your performance needs
-    explicit HandleStreamBuf(Id::Type handle, size_t bufferSize = 4096) : mHandler(handle), mBuffer(bufferSize)
+    /// changes are delivered once no new ones arrived for this long
+    constexpr std::chrono::milliseconds cChangeSettleTime(50);
+
+    /// changes are delivered at least this often, even if they never stop arriving
+    constexpr std::chrono::milliseconds cChangeMaxLatency(500);
+
+    /// checks if a name is an infofile
+    static bool IsInfoFile(std::string_view name)
     {
-        // set the get area to be empty initially
-        setg(mBuffer.data(), mBuffer.data(), mBuffer.data());
+        return name.size() > 5 && name[name.size() - 5] == '.' &&
+            std::equal(name.end() - 4, name.end(), "info", [](unsigned char a, unsigned char b) { return std::tolower(a) == b; });
     }
 
-protected:
-    /// called when the stream needs more bytes
-    int_type underflow() override
+    /// asset added without an infofile, reported once the infofile arrives or its wait is over
+    struct AwaitingInfo
+    {
+        /// when the wait is over
+        std::chrono::steady_clock::time_point mDeadline;
+
+        /// asset change
+        FileSystem::AssetChange mAssetChange;
+    };
+
+    /// FileChangePipeline class, coalesces the pushed file changes and pairs them with their infofiles on a worker thread
+    /// the main thread pops the ready batches without locking, the files reported so far are kept so nothing is probed on disk
+    class FileChangePipeline
+    {
+        CLASS_NO_COPY_MOVE(FileChangePipeline);
+
+    public:
+        /// default constructor
+        explicit FileChangePipeline() = default;
+
+        /// destructor
+        ~FileChangePipeline()
+        {
+            Stop();
+        }
+
+        /// start the worker thread
+        void Start()
+        {
+            L_ASSERT(!mThread.joinable());
+            mStop = false;
+            mThread = std::thread(&FileChangePipeline::Run, this);
+        }
+
+        /// stop the worker thread, pending changes are dropped
+        void Stop()
+        {
+            if (mThread.joinable())
+            {
+                {
+                    std::lock_guard<std::mutex> lock(mMutex);
+                    mStop = true;
+                }
+                mCondition.notify_one();
+                mThread.join();
+            }
+            mPending.Clear();
+            mKnown.clear();
+            mAwaitingInfo.clear();
+            mAwaitingOrder.clear();
+            std::vector<FileSystem::AssetChange> readyBatch;
+            while (mReady.Pop(readyBatch))
+            {
+            }
+        }
+
+        /// wake the worker thread, changes were pushed
+        void Wake()
+        {
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                mWoken = true;
+            }
+            mCondition.notify_one();
+        }
+
+        /// pop a ready batch, only from the main thread
+        bool Pop(std::vector<FileSystem::AssetChange> &readyBatch)
+        {
+            return mReady.Pop(readyBatch);
+        }
+
+    private:
+        /// worker thread
+        void Run()
+        {
+            std::list<std::vector<FileSystem::FileChange>> fileBatchQueue;
+            for (;;)
+            {
+                {
+                    std::unique_lock<std::mutex> lock(mMutex);
+                    auto woken = [this]() { return mStop || mWoken; };
+                    if (std::optional<std::chrono::steady_clock::time_point> deadline = Deadline())
+                    {
+                        mCondition.wait_until(lock, *deadline, woken);
+                    }
+                    else
+                    {
+                        mCondition.wait(lock, woken);
+                    }
+                    if (mStop)
+                    {
+                        return;
+                    }
+                    mWoken = false;
+                }
+
+                auto now = std::chrono::steady_clock::now();
+                if (gFileBatchQueue.PopBatchQueue(fileBatchQueue))
+                {
+                    if (mPending.Empty())
+                    {
+                        mPendingSince = now;
+                    }
+                    mLastChange = now;
+                    for (std::vector<FileSystem::FileChange> &batch : fileBatchQueue)
+                    {
+                        for (FileSystem::FileChange &fileChange : batch)
+                        {
+                            // files written aside are not reported, moving one over its file is the change
+                            if (fileChange.mName.ends_with(FileSystem::cAsideSuffix))
+                            {
+                                continue;
+                            }
+                            if (fileChange.mChange == FileSystem::Change::Renamed && fileChange.mOldName.ends_with(FileSystem::cAsideSuffix))
+                            {
+                                fileChange.mChange = FileSystem::Change::Added;
+                                fileChange.mOldName.clear();
+                            }
+
+                            // watchers and scans may use different separators
+                            PathId name = PathId::Intern(fileChange.mName);
+                            fileChange.mName = name.String();
+                            PathId oldName;
+                            if (!fileChange.mOldName.empty())
+                            {
+                                oldName = PathId::Intern(fileChange.mOldName);
+                                fileChange.mOldName = oldName.String();
+                            }
+                            Invalidate(fileChange, name, oldName);
+                            mPending.Push(std::move(fileChange));
+                        }
+                    }
+                    fileBatchQueue.clear();
+                }
+
+                std::vector<FileSystem::AssetChange> readyBatch;
+                if (!mPending.Empty() && (now - mLastChange >= cChangeSettleTime || now - mPendingSince >= cChangeMaxLatency))
+                {
+                    std::vector<FileSystem::FileChange> fileBatch;
+                    mPending.Take(fileBatch);
+                    Resolve(fileBatch, now, readyBatch);
+                }
+                Expire(now, readyBatch);
+                if (!readyBatch.empty())
+                {
+                    mReady.Push(std::move(readyBatch));
+                }
+            }
+        }
+
+        /// when the worker has something to do without being woken
+        std::optional<std::chrono::steady_clock::time_point> Deadline() const
+        {
+            std::optional<std::chrono::steady_clock::time_point> deadline;
+            if (!mPending.Empty())
+            {
+                deadline = std::min(mLastChange + cChangeSettleTime, mPendingSince + cChangeMaxLatency);
+            }
+            if (!mAwaitingOrder.empty() && (!deadline || mAwaitingOrder.front().first < *deadline))
+            {
+                deadline = mAwaitingOrder.front().first;
+            }
+            return deadline;
+        }
+
+        /// track the files of a batch, then turn its changes into asset changes
+        void Resolve(std::vector<FileSystem::FileChange> &fileBatch, std::chrono::steady_clock::time_point now, std::vector<FileSystem::AssetChange> &readyBatch)
+        {
+            // the whole batch is tracked first, so a file and its infofile arriving together are paired in any order
+            for (FileSystem::FileChange &fileChange : fileBatch)
+            {
+                switch (fileChange.mChange)
+                {
+                case FileSystem::Change::Added:
+                    // a known file replaced by one written aside is modified
+                    if (!mKnown.insert(fileChange.mName).second && fileChange.mFlags.Has(FileSystem::Flag::File))
+                    {
+                        fileChange.mChange = FileSystem::Change::Modified;
+                    }
+                    break;
+                case FileSystem::Change::Modified:
+                    mKnown.insert(fileChange.mName);
+                    break;
+                case FileSystem::Change::Renamed:
+                    Forget(fileChange.mOldName, fileChange.mFlags, fileChange.mName);
+                    mKnown.insert(fileChange.mName);
+                    break;
+                case FileSystem::Change::Removed:
+                    Forget(fileChange.mName, fileChange.mFlags, {});
+                    break;
+                }
+            }
+
+            for (const FileSystem::FileChange &fileChange : fileBatch)
+            {
+                if (IsInfoFile(fileChange.mName))
+                {
+                    // infofiles are not reported, but one arriving late releases its asset
+                    if (fileChange.mChange == FileSystem::Change::Added || fileChange.mChange == FileSystem::Change::Renamed)
+                    {
+                        auto it = mAwaitingInfo.find(fileChange.mName.substr(0, fileChange.mName.size() - 5));
+                        if (it != mAwaitingInfo.end())
+                        {
+                            readyBatch.push_back(std::move(it->second.mAssetChange));
+                            mAwaitingInfo.erase(it);
+                        }
+                    }
+                    continue;
+                }
+
+                auto awaiting = mAwaitingInfo.find(fileChange.mChange == FileSystem::Change::Renamed ? fileChange.mOldName : fileChange.mName);
+                switch (fileChange.mChange)
+                {
+                case FileSystem::Change::Added:
+                    if (mKnown.contains(fileChange.mName + ".info"))
+                    {
+                        readyBatch.push_back({ FileSystem::Change::Added, fileChange.mFlags, fileChange.mName, "" });
+                    }
+                    else if (awaiting == mAwaitingInfo.end())
+                    {
+                        Await({ FileSystem::Change::Added, fileChange.mFlags, fileChange.mName, "" }, now);
+                    }
+                    break;
+                case FileSystem::Change::Modified:
+                    // an asset still waiting for its infofile was not reported yet
+                    if (awaiting == mAwaitingInfo.end())
+                    {
+                        // files are often touched without changing, those are not reimported
+                        Hash64 contentHash = 0;
+                        if (fileChange.mFlags.Has(FileSystem::Flag::File) && mKnown.contains(fileChange.mName + ".info") && ContentUnchanged(fileChange.mName, contentHash))
+                        {
+                            Lumen::DebugLog::Detail("Modified file with the same content, {}, ignored", fileChange.mName);
+                            break;
+                        }
+                        readyBatch.push_back({ FileSystem::Change::Modified, fileChange.mFlags, fileChange.mName, "", contentHash });
+                    }
+                    break;
+                case FileSystem::Change::Renamed:
+                    if (awaiting != mAwaitingInfo.end())
+                    {
+                        FileSystem::AssetChange assetChange = std::move(awaiting->second.mAssetChange);
+                        mAwaitingInfo.erase(awaiting);
+                        assetChange.mName = fileChange.mName;
+                        Await(std::move(assetChange), now);
+                    }
+                    else
+                    {
+                        readyBatch.push_back({ FileSystem::Change::Renamed, fileChange.mFlags, fileChange.mName, fileChange.mOldName });
+                    }
+                    break;
+                case FileSystem::Change::Removed:
+                    if (awaiting != mAwaitingInfo.end())
+                    {
+                        mAwaitingInfo.erase(awaiting);
+                    }
+                    else
+                    {
+                        readyBatch.push_back({ FileSystem::Change::Removed, fileChange.mFlags, fileChange.mName, "" });
+                    }
+                    break;
+                }
+            }
+        }
+
+        /// drop the cached contents a change makes stale, as soon as it arrives
+        static void Invalidate(const FileSystem::FileChange &fileChange, PathId name, PathId oldName)
+        {
+            ContentCache &cache = gFileSytemState->mContentCache;
+            if (fileChange.mChange == FileSystem::Change::Added && fileChange.mFlags.Has(FileSystem::Flag::Unchanged))
+            {
+                return;
+            }
+            if (fileChange.mFlags.Has(FileSystem::Flag::Directory))
+            {
+                // only a folder moving or going away changes the files in it
+                if (fileChange.mChange != FileSystem::Change::Renamed && fileChange.mChange != FileSystem::Change::Removed)
+                {
+                    return;
+                }
+                cache.InvalidateFolder(name);
+                if (oldName.Valid())
+                {
+                    cache.InvalidateFolder(oldName);
+                }
+                return;
+            }
+            cache.Invalidate(name);
+            if (oldName.Valid())
+            {
+                cache.Invalidate(oldName);
+            }
+        }
+
+        /// hash the content of a file, without logging if it is not in a registered file system
+        static bool HashContent(const std::string &name, Hash64 &hash)
+        {
+            PathView relative;
+            std::filesystem::path path(name);
+            return ResolveMount(path, relative) && FileSystem::ContentHash(path, hash);
+        }
+
+        /// check the content hash of a modified file against the one in its infofile, the infofile is only read here,
+        /// a new hash is returned with the change and stored by the main thread once the asset is reimported
+        static bool ContentUnchanged(const std::string &name, Hash64 &hash)
+        {
+            if (!HashContent(name, hash))
+            {
+                hash = 0;
+                return false;
+            }
+            Expected<AssetInfoPtr> assetInfo = AssetInfo::MakePtr(name);
+            if (!assetInfo || !assetInfo.Value()->Load())
+            {
+                return false;
+            }
+            return assetInfo.Value()->ContentHash() == hash;
+        }
+
+        /// stop tracking a file, and the contents of a folder, moving them to a new name if given
+        void Forget(const std::string &name, FileSystem::Flags flags, const std::string &newName)
+        {
+            mKnown.erase(name);
+            if (!flags.Has(FileSystem::Flag::Directory))
+            {
+                return;
+            }
+
+            // the contents of a folder sort together, between "name/" and "name0", the character after the separator
+            auto begin = mKnown.lower_bound(name + "/");
+            auto end = mKnown.lower_bound(name + static_cast<char>('/' + 1));
+            std::vector<std::string> moved;
+            if (!newName.empty())
+            {
+                for (auto it = begin; it != end; ++it)
+                {
+                    moved.push_back(newName + it->substr(name.size()));
+                }
+            }
+            mKnown.erase(begin, end);
+            mKnown.insert(std::make_move_iterator(moved.begin()), std::make_move_iterator(moved.end()));
+        }
+
+        /// wait for the infofile of an added asset
+        void Await(FileSystem::AssetChange &&assetChange, std::chrono::steady_clock::time_point now)
+        {
+            auto deadline = now + InfoDelay;
+            mAwaitingOrder.emplace_back(deadline, assetChange.mName);
+            AwaitingInfo &awaitingInfo = mAwaitingInfo[assetChange.mName];
+            awaitingInfo.mDeadline = deadline;
+            awaitingInfo.mAssetChange = std::move(assetChange);
+        }
+
+        /// report the assets whose infofile did not arrive in time
+        void Expire(std::chrono::steady_clock::time_point now, std::vector<FileSystem::AssetChange> &readyBatch)
+        {
+            // waits only ever get later, entries already resolved are skipped
+            while (!mAwaitingOrder.empty() && mAwaitingOrder.front().first <= now)
+            {
+                auto &[deadline, name] = mAwaitingOrder.front();
+                auto it = mAwaitingInfo.find(name);
+                if (it != mAwaitingInfo.end() && it->second.mDeadline == deadline)
+                {
+                    readyBatch.push_back(std::move(it->second.mAssetChange));
+                    mAwaitingInfo.erase(it);
+                }
+                mAwaitingOrder.pop_front();
+            }
+        }
+
+        /// worker thread
+        std::thread mThread;
+
+        /// mutex protecting the wake and stop flags
+        std::mutex mMutex;
+
+        /// signaled when changes are pushed or on stop
+        std::condition_variable mCondition;
+
+        /// changes were pushed
+        bool mWoken = false;
+
+        /// stop flag
+        bool mStop = false;
+
+        /// changes waiting for the pushes to settle
+        FileChangeCoalescer mPending;
+
+        /// when the oldest pending change arrived
+        std::chrono::steady_clock::time_point mPendingSince;
+
+        /// when the newest pending change arrived
+        std::chrono::steady_clock::time_point mLastChange;
+
+        /// names of the files and folders reported so far, ordered so the contents of a folder are one range
+        std::set<std::string, std::less<>> mKnown;
+
+        /// added assets waiting for their infofile, by name
+        std::unordered_map<std::string, AwaitingInfo> mAwaitingInfo;
+
+        /// deadlines of the waits in the order they end
+        std::deque<std::pair<std::chrono::steady_clock::time_point, std::string>> mAwaitingOrder;
+
+        /// batches ready for the main thread
+        LockFreeQueue<std::vector<FileSystem::AssetChange>> mReady;
+    };
+
+    /// file change pipeline, it outlives the file system state since watchers may push before and after it
+    static FileChangePipeline gFileChangePipeline;
+#endif
+
+    /// sax handler that builds one top level entry at a time and hands it to a callback
+    class EntrySaxHandler : public nlohmann::json_sax<Serialized::Type>
     {
-        if (gptr() < egptr())
+        CLASS_NO_DEFAULT_CTOR(EntrySaxHandler);
+        CLASS_NO_COPY_MOVE(EntrySaxHandler);
+
+    public:
+        /// constructs a sax handler
+        explicit EntrySaxHandler(const FileSystem::EntryCallback &callback) : mCallback(callback) {}
+
+        /// null value
+        bool null() override { return Value(nullptr); }
+
+        /// boolean value
+        bool boolean(bool val) override { return Value(val); }
+
+        /// integer value
+        bool number_integer(number_integer_t val) override { return Value(val); }
+
+        /// unsigned value
+        bool number_unsigned(number_unsigned_t val) override { return Value(val); }
+
+        /// float value
+        bool number_float(number_float_t val, const string_t &) override { return Value(val); }
+
+        /// string value
+        bool string(string_t &val) override { return Value(std::move(val)); }
+
+        /// binary value
+        bool binary(binary_t &val) override { return Value(Serialized::Type::binary(std::move(val))); }
+
+        /// object begin
+        bool start_object(std::size_t) override
         {
-            return traits_type::to_int_type(*gptr());
+            if (mDepth++ == 0)
+            {
+                return true;
+            }
+            mStack.push_back(Put(Serialized::Type::object()));
+            return true;
         }
 
-        // read bytes
-        size_t bytesRead = FileSystem::ReadBytes(mHandler, mBuffer.data(), mBuffer.size());
+        /// object key
+        bool key(string_t &val) override
+        {
+            if (mDepth == 1)
+            {
+                mEntryKey = std::move(val);
+            }
+            else
+            {
+                mKey = std::move(val);
+            }
+            return true;
+        }
 
-        if (bytesRead == 0)
+        /// object end
+        bool end_object() override
+        {
+            if (--mDepth == 0)
+            {
+                return true;
+            }
+            return End();
+        }
+
+        /// array begin
+        bool start_array(std::size_t) override
+        {
+            if (mDepth++ == 0)
+            {
+                mError = "serialized data root must be an object";
+                return false;
+            }
+            mStack.push_back(Put(Serialized::Type::array()));
+            return true;
+        }
+
+        /// array end
+        bool end_array() override
+        {
+            --mDepth;
+            return End();
+        }
+
+        /// parse error
+        bool parse_error(std::size_t, const std::string &, const nlohmann::detail::exception &ex) override
+        {
+            mError = ex.what();
+            return false;
+        }
+
+        /// get error
+        [[nodiscard]] const std::string &Error() const { return mError; }
+
+        /// whether the callback stopped the parse
+        [[nodiscard]] bool Stopped() const { return mStopped; }
+
+    private:
+        /// place a value in the current container, or make it the current entry
+        Serialized::Type *Put(Serialized::Type &&value)
+        {
+            if (mStack.empty())
+            {
+                mEntry = std::move(value);
+                return &mEntry;
+            }
+            Serialized::Type *container = mStack.back();
+            if (container->is_object())
+            {
+                return &((*container)[mKey] = std::move(value));
+            }
+            container->push_back(std::move(value));
+            return &container->back();
+        }
+
+        /// scalar value
+        bool Value(Serialized::Type &&value)
+        {
+            if (mDepth == 0)
+            {
+                mError = "serialized data root must be an object";
+                return false;
+            }
+            Put(std::move(value));
+            return !mStack.empty() || Emit();
+        }
+
+        /// container end
+        bool End()
+        {
+            mStack.pop_back();
+            return !mStack.empty() || Emit();
+        }
+
+        /// hand the finished entry to the callback and release it, returns false to stop the parse if the callback stopped it
+        bool Emit()
+        {
+            mStopped = !mCallback(mEntryKey, mEntry);
+            mEntry = {};
+            return !mStopped;
+        }
+
+        /// entry callback
+        const FileSystem::EntryCallback &mCallback;
+
+        /// nesting depth, the root object is depth 1
+        int mDepth = 0;
+
+        /// whether the callback stopped the parse
+        bool mStopped = false;
+
+        /// key of the current entry
+        std::string mEntryKey;
+
+        /// key of the next value inside the current entry
+        std::string mKey;
+
+        /// current entry
+        Serialized::Type mEntry;
+
+        /// open containers of the current entry
+        std::vector<Serialized::Type *> mStack;
+
+        /// error message
+        std::string mError;
+    };
+}
+
+/// initialize file namespace
+void FileSystem::Initialize(const EngineWeakPtr &engine)
+{
+    L_ASSERT(!Hidden::gFileSytemState);
+    Hidden::gFileSytemState = std::make_unique<Hidden::FileSytemState>();
+    Hidden::gFileSytemState->mEngine = engine;
+#ifdef EDITOR
+    Hidden::gFileChangePipeline.Start();
+#endif
+}
+
+/// shutdown file namespace
+void FileSystem::Shutdown()
+{
+    L_ASSERT(Hidden::gFileSytemState);
+#ifdef EDITOR
+    Hidden::gFileChangePipeline.Stop();
+#endif
+
+    // a file system mounted more than once is only shut down once
+    std::vector<IFileSystem *> fileSystems;
+    for (const Hidden::Mount &mount : Hidden::gFileSytemState->mMounts)
+    {
+        if (std::find(fileSystems.begin(), fileSystems.end(), mount.mFileSystem.get()) == fileSystems.end())
         {
-            return traits_type::eof();
+            fileSystems.push_back(mount.mFileSystem.get());
+            mount.mFileSystem->Shutdown();
         }
-
-        // reset the buffer pointers
-        setg(mBuffer.data(), mBuffer.data(), mBuffer.data() + bytesRead);
-        return traits_type::to_int_type(*gptr());
     }
+    Hidden::gFileSytemState.reset();
+}
 
-private:
-    /// file handle
-    Id::Type mHandler;
+/// enable compression of binary data written to packed file systems, compressed data is always readable
+void FileSystem::SetCompressPacked(bool compress)
+{
+    L_ASSERT(Hidden::gFileSytemState);
+    Hidden::gFileSytemState->mCompressPacked = compress;
+}
 
-    /// internal buffer for reading
-    std::vector<char> mBuffer;
-};
+/// set the budget in bytes of the cache of small file contents read by Map, zero disables it
+void FileSystem::SetContentCacheBudget(size_t budget)
+{
+    L_ASSERT(Hidden::gFileSytemState);
+    Hidden::gFileSytemState->mContentCache.SetBudget(budget);
+}
 
-/// initialize file namespace
-void FileSystem::Initialize(const EngineWeakPtr &engine)
+/// get the counters of the cache of small file contents
+FileSystem::CacheStats FileSystem::ContentCacheStats()
 {
-    L_ASSERT(!Hidden::gFileSytemState);
-    Hidden::gFileSytemState = std::make_unique<Hidden::FileSytemState>();
-    Hidden::gFileSytemState->mEngine = engine;
+    L_ASSERT(Hidden::gFileSytemState);
+    return Hidden::gFileSytemState->mContentCache.GetStats();
 }
 
-/// shutdown file namespace
-void FileSystem::Shutdown()
+/// whether binary data written to packed file systems is compressed
+bool FileSystem::CompressPacked()
 {
     L_ASSERT(Hidden::gFileSytemState);
-    Hidden::gFileSytemState.reset();
+    return Hidden::gFileSytemState->mCompressPacked;
 }
 
 /// normalize a directory path
@@ -144,117 +958,37 @@ const std::filesystem::path FileSystem::NormalizeFilePath(const std::filesystem:
 void FileSystem::RegisterFileSystem(const std::filesystem::path &mountPoint, const IFileSystemPtr &fileSystem)
 {
     L_ASSERT(Hidden::gFileSytemState);
-    Hidden::gFileSytemState->mFileSystems.insert_or_assign(FileSystem::NormalizeDirPath(mountPoint).string(), fileSystem);
+    std::filesystem::path::string_type prefix = FileSystem::NormalizeDirPath(mountPoint).native();
+    std::unique_lock<std::shared_mutex> lock(Hidden::gFileSytemState->mMountMutex);
+    std::vector<Hidden::Mount> &mounts = Hidden::gFileSytemState->mMounts;
+    auto it = std::find_if(mounts.begin(), mounts.end(), [&prefix](const Hidden::Mount &mount) { return mount.mPrefix == prefix; });
+    if (it != mounts.end())
+    {
+        it->mFileSystem = fileSystem;
+        return;
+    }
+
+    // keep the longest mount points first, so the first match is the longest prefix
+    it = std::find_if(mounts.begin(), mounts.end(), [&prefix](const Hidden::Mount &mount) { return mount.mPrefix.size() < prefix.size(); });
+    mounts.insert(it, { std::move(prefix), fileSystem });
 }
 
 /// push file changes
 void FileSystem::PushFileChangeBatch(std::vector<FileChange> &&fileBatch)
 {
     Hidden::gFileBatchQueue.PushBatch(std::move(fileBatch));
+    Hidden::gFileChangePipeline.Wake();
 }
 
-/// process file changes
+/// process file changes, the batches made ready by the pipeline are reported to the engine
 void FileSystem::ProcessFileChanges()
 {
-    using clock = std::chrono::system_clock;
-    using time_point = clock::time_point;
-    using ms = std::chrono::milliseconds;
-
-    auto now = clock::now();
-    auto &map = Hidden::gFileSytemState->mAssetChangeMap;
+    L_ASSERT(Hidden::gFileSytemState);
     std::vector<AssetChange> assetBatch;
-
-    std::list<std::vector<FileChange>> fileBatchQueue;
-    int dotest = 0; //?WIP? this is just to test the late arrival of info, we should have a better way to test this
-                    // but for now we can just create a file and then create the info after a delay,
-                    // and see if the system correctly processes the asset change when the info arrives
-    if (Hidden::gFileBatchQueue.PopBatchQueue(fileBatchQueue))
-    {
-        for (auto &batch : fileBatchQueue)
-        {
-            for (auto &fileChange : batch)
-            {
-                // determine info and base file existence
-                auto ext = std::filesystem::path(fileChange.mName).extension().string();
-                bool isInfo = (ext.size() == 5) &&
-                    std::equal(ext.begin() + 1, ext.end(), "info", [](unsigned char a, unsigned char b) { return std::tolower(a) == b; });
-                bool hasInfo = isInfo;
-                bool hasBase = !isInfo;
-                if (isInfo)
-                {
-                    hasBase = Exists(std::filesystem::path(fileChange.mName.substr(0, fileChange.mName.size() - 5)));
-                }
-                else
-                {
-                    hasInfo = Exists(std::filesystem::path(fileChange.mName + ".info"));
-                }
-
-                if (!isInfo)
-                {
-                    if (hasBase)
-                    {
-                        AssetChange assetChange;
-                        switch (fileChange.mChange)
-                        {
-                        case FileSystem::Change::Added:
-                            assetChange = { FileSystem::Change::Added, fileChange.mFlags, fileChange.mName, "" };
-                            if (hasInfo)
-                            {
-                                Lumen::DebugLog::Detail("Added file with infofile, {}, infofile exists", assetChange.mName);
-                                assetBatch.push_back(assetChange);
-                            }
-                            else
-                            {
-                                if (dotest == 0)
-                                {
-                                    dotest = 1;
-                                }
-                                map.emplace(clock::now() + InfoDelay, assetChange);
-                            }
-                            break;
-                        case FileSystem::Change::Modified:
-                            assetBatch.push_back({ FileSystem::Change::Modified, fileChange.mFlags, fileChange.mName, "" });
-                            break;
-                        case FileSystem::Change::Renamed:
-                            assetBatch.push_back({ FileSystem::Change::Renamed, fileChange.mFlags, fileChange.mName, fileChange.mOldName });
-                            break;
-                        case FileSystem::Change::Removed:
-                            assetBatch.push_back({ FileSystem::Change::Removed, fileChange.mFlags, fileChange.mName, "" });
-                            break;
-                        }
-                    }
-                }
-            }
-        }
-    }
-
-    if (dotest == 1)
-    {
-        dotest = 2;
-        // CREATE THE Assets/serializer_test.txt
-    }
-
-    for (auto it = map.begin(); it != map.end(); )
+    std::vector<AssetChange> readyBatch;
+    while (Hidden::gFileChangePipeline.Pop(readyBatch))
     {
-        auto &[processTime, assetChange] = *it;
-
-        if (Exists(std::filesystem::path(assetChange.mName + ".info")))
-        {
-            Lumen::DebugLog::Detail("Added file with infofile, {}, infofile late arrival", assetChange.mName);
-            assetBatch.push_back(assetChange);
-            it = map.erase(it);
-        }
-        else if (processTime <= now)
-        {
-            // CREATE THE INFOFILE
-            Lumen::DebugLog::Detail("Added file without infofile, {}, created infofile", assetChange.mName);
-            assetBatch.push_back(assetChange);
-            it = map.erase(it);
-        }
-        else
-        {
-            ++it;
-        }
+        assetBatch.insert(assetBatch.end(), std::make_move_iterator(readyBatch.begin()), std::make_move_iterator(readyBatch.end()));
     }
 
     if (!assetBatch.empty())
@@ -266,43 +1000,66 @@ void FileSystem::ProcessFileChanges()
     }
 }
 
-/// generates a new file id
+/// generates a new file id, reserving a handle slot that FileSystem::Open binds to the file system, from any thread
 Id::Type FileSystem::GenerateFileId()
 {
-    return Hidden::gFileSytemState->mFileIdGenerator.Next();
+    L_ASSERT(Hidden::gFileSytemState);
+    if (Hidden::tHandleShard == SIZE_MAX)
+    {
+        Hidden::tHandleShard = Hidden::gFileSytemState->mNextHandleShard.fetch_add(1, std::memory_order_relaxed) % Hidden::cHandleShardCount;
+    }
+    Hidden::HandleShard &shard = Hidden::gFileSytemState->mHandleShards[Hidden::tHandleShard];
+    std::lock_guard<std::mutex> lock(shard.mMutex);
+    size_t index;
+    if (shard.mFreeSlots.empty())
+    {
+        index = shard.mSlotCount++;
+        L_ASSERT_MSG(index < Hidden::cHandleChunkSize * Hidden::cHandleChunkCount, "Too many open files");
+        if (index % Hidden::cHandleChunkSize == 0)
+        {
+            shard.mChunkStorage.push_back(std::make_unique<Hidden::HandleSlot[]>(Hidden::cHandleChunkSize));
+            shard.mChunks[index / Hidden::cHandleChunkSize].store(shard.mChunkStorage.back().get(), std::memory_order_release);
+        }
+    }
+    else
+    {
+        index = shard.mFreeSlots.back();
+        shard.mFreeSlots.pop_back();
+    }
+    Hidden::HandleSlot &handleSlot = shard.mChunks[index / Hidden::cHandleChunkSize].load(std::memory_order_relaxed)[index % Hidden::cHandleChunkSize];
+    size_t slot = (index << Hidden::cHandleShardBits) | Hidden::tHandleShard;
+    return (handleSlot.mGeneration.load(std::memory_order_relaxed) << Hidden::cHandleSlotBits) | slot;
 }
 
 /// read serialized data from a path
 bool FileSystem::ReadSerializedData(const std::filesystem::path &path, Serialized::Type &data)
 {
     bool binary = FileSystem::IsPacked(path);
-    Id::Type file = FileSystem::Open(path, false, binary);
+    Id::Type file = FileSystem::Map(path);
     if (file == Id::Invalid)
     {
         Lumen::DebugLog::Error("Unable to open scene file for reading, {}", path.string());
         return false;
     }
 
-    if (binary)
+    // parse straight from the mapped file
+    std::span<const byte> bytes = FileSystem::MappedData(file);
+    std::vector<byte> decompressed;
+    if (binary && !Hidden::Decompress(bytes, decompressed))
     {
-        size_t fileSize = FileSystem::Size(file);
-        std::vector<uint8_t> v(fileSize);
-        if (FileSystem::ReadBytes(file, v.data(), fileSize) == fileSize)
-        {
-            try
-            {
-                data = Serialized::Type::from_cbor(v);
-            }
-            catch (const std::exception &e)
-            {
-                Lumen::DebugLog::Error("Unable to parse scene file {}, error {}", path.string(), e.what());
-                return false;
-            }
-        }
+        Lumen::DebugLog::Error("Unable to decompress scene file {}", path.string());
+        FileSystem::Close(file);
+        return false;
     }
-    else
+    try
     {
-        data = Serialized::Type::parse(FileSystem::ReadText(file));
+        data = binary ? Serialized::Type::from_cbor(bytes.begin(), bytes.end()) : Serialized::Type::parse(bytes.begin(), bytes.end());
+    }
+    catch (const std::exception &e)
+    {
+        Lumen::DebugLog::Error("Unable to parse file {}, error {}", path.string(), e.what());
+        FileSystem::Close(file);
+        return false;
     }
     FileSystem::Close(file);
     return true;
@@ -310,39 +1067,205 @@ bool FileSystem::ReadSerializedData(const std::filesystem::path &path, Serialize
 
 /// write serialized data to a path
 bool FileSystem::WriteSerializedData(const std::filesystem::path &path, const Serialized::Type &data)
+{
+    if (!FileSystem::WriteAtomic(path, FileSystem::EncodeSerializedData(path, data)))
+    {
+        Lumen::DebugLog::Error("Unable to write scene file, {}", path.string());
+        return false;
+    }
+    return true;
+}
+
+/// read the top level entries of serialized data from a path one at a time, without building the whole document
+bool FileSystem::ReadSerializedEntries(const std::filesystem::path &path, const EntryCallback &callback)
 {
     bool binary = FileSystem::IsPacked(path);
-    Id::Type file = FileSystem::Open(path, true, binary);
+    Id::Type file = FileSystem::Map(path);
     if (file == Id::Invalid)
     {
-        Lumen::DebugLog::Error("Unable to open scene file for writing, {}", path.string());
+        Lumen::DebugLog::Error("Unable to open file for reading, {}", path.string());
         return false;
     }
 
-    if (binary)
+    // compressed data is decompressed as a whole, its blocks decompress in parallel
+    std::span<const byte> bytes = FileSystem::MappedData(file);
+    std::vector<byte> decompressed;
+    if (binary && !Hidden::Decompress(bytes, decompressed))
     {
-        std::vector<uint8_t> serData = Serialized::Type::to_cbor(data);
-        FileSystem::WriteBytes(file, serData.data(), serData.size());
+        Lumen::DebugLog::Error("Unable to decompress file {}", path.string());
+        FileSystem::Close(file);
+        return false;
     }
-    else
+
+    // parse the mapped file, only the entry being read is kept as a document
+    Hidden::EntrySaxHandler handler(callback);
+    bool result = false;
+    try
+    {
+        result = Serialized::Type::sax_parse(bytes.begin(), bytes.end(), &handler, binary ? nlohmann::json::input_format_t::cbor : nlohmann::json::input_format_t::json);
+        if (!result && !handler.Stopped())
+        {
+            Lumen::DebugLog::Error("Unable to parse file {}, error {}", path.string(), handler.Error());
+        }
+    }
+    catch (const std::exception &e)
     {
-        FileSystem::WriteText(file, data.dump(4));
+        Lumen::DebugLog::Error("Unable to parse file {}, error {}", path.string(), e.what());
     }
+    FileSystem::Close(file);
+    return result;
+}
 
+/// read binary data from a path
+bool FileSystem::ReadBinaryData(const std::filesystem::path &path, std::vector<byte> &data)
+{
+    // mapped, so a cached file is not read again
+    Id::Type file = FileSystem::Map(path);
+    if (file == Id::Invalid)
+    {
+        Lumen::DebugLog::Error("Unable to open binary file for reading, {}", path.string());
+        return false;
+    }
+    std::span<const byte> bytes = FileSystem::MappedData(file);
+    data.assign(bytes.begin(), bytes.end());
     FileSystem::Close(file);
+    if (!Hidden::Decompress(data))
+    {
+        Lumen::DebugLog::Error("Unable to decompress binary file, {}", path.string());
+        return false;
+    }
     return true;
 }
 
-/// checks if a path is packed
-bool FileSystem::IsPacked(const std::filesystem::path &path)
+/// write binary data to a path
+bool FileSystem::WriteBinaryData(const std::filesystem::path &path, std::span<const byte> data)
+{
+    std::vector<byte> compressed;
+    std::span<const byte> bytes = Hidden::CompressPacked(path, data, compressed);
+    if (!FileSystem::WriteAtomic(path, bytes))
+    {
+        Lumen::DebugLog::Error("Unable to write binary file, {}", path.string());
+        return false;
+    }
+    return true;
+}
+
+/// encode serialized data the way it is stored at a path
+std::vector<byte> FileSystem::EncodeSerializedData(const std::filesystem::path &path, const Serialized::Type &data)
+{
+    if (FileSystem::IsPacked(path))
+    {
+        std::vector<byte> serData = Serialized::Type::to_cbor(data);
+        std::vector<byte> compressed;
+        Hidden::CompressPacked(path, serData, compressed);
+        return compressed.empty() ? serData : compressed;
+    }
+    std::string text = data.dump(4);
+    return std::vector<byte>(text.begin(), text.end());
+}
+
+/// write a whole file atomically, readers see the old or the new file but never a partial one
+bool FileSystem::WriteAtomic(const std::filesystem::path &path, std::span<const byte> data, Durability durability)
+{
+    std::filesystem::path paths[] = { path };
+    return FileSystem::WriteAside(path, data) && FileSystem::CommitAside(paths, durability);
+}
+
+/// write a whole file aside of its path, safe to call from any thread, the file is replaced by CommitAside
+bool FileSystem::WriteAside(const std::filesystem::path &path, std::span<const byte> data)
+{
+    L_ASSERT(Hidden::gFileSytemState);
+    Hidden::PathView relative;
+    if (IFileSystemPtr fileSystem = Hidden::ResolveMount(path, relative))
+    {
+        return fileSystem->WriteAside(relative, data);
+    }
+    return false;
+}
+
+/// replace files with the files written aside of them, a durable commit flushes them to disk once for all files
+bool FileSystem::CommitAside(std::span<const std::filesystem::path> paths, Durability durability)
 {
     L_ASSERT(Hidden::gFileSytemState);
-    for (auto &[mountPoint, fileSystem] : Hidden::gFileSytemState->mFileSystems)
+
+    // group the paths by file system, so each flushes once
+    std::vector<std::pair<IFileSystemPtr, std::vector<std::filesystem::path>>> commits;
+    bool result = true;
+    for (const std::filesystem::path &path : paths)
     {
-        if (Hidden::StartsWith(path, mountPoint))
+        Hidden::PathView relative;
+        IFileSystemPtr fileSystem = Hidden::ResolveMount(path, relative);
+        if (!fileSystem)
+        {
+            result = false;
+            continue;
+        }
+        auto it = std::find_if(commits.begin(), commits.end(), [&fileSystem](const auto &commit) { return commit.first == fileSystem; });
+        if (it == commits.end())
         {
-            return fileSystem->Packed();
+            it = commits.emplace(commits.end(), fileSystem, std::vector<std::filesystem::path>());
         }
+        it->second.emplace_back(relative);
+    }
+    for (auto &[fileSystem, relativePaths] : commits)
+    {
+        result = fileSystem->CommitAside(relativePaths, durability) && result;
+    }
+
+    // dropped once replaced, so content cached while replacing does not stay
+    for (const std::filesystem::path &path : paths)
+    {
+        Hidden::gFileSytemState->mContentCache.Invalidate(PathId::Intern(path));
+    }
+    return result;
+}
+
+/// append binary data to a path, the file is created if missing and appended data is never compressed
+bool FileSystem::AppendBinaryData(const std::filesystem::path &path, std::span<const byte> data)
+{
+    // opening for write truncates, so only a missing file is opened that way
+    Id::Type file = FileSystem::Open(path, !FileSystem::Exists(path), true);
+    if (file == Id::Invalid)
+    {
+        Lumen::DebugLog::Error("Unable to open binary file for appending, {}", path.string());
+        return false;
+    }
+
+    FileSystem::Seek(file, FileSystem::Size(file));
+    bool result = FileSystem::WriteBytes(file, data.data(), data.size());
+    FileSystem::Close(file);
+    Hidden::gFileSytemState->mContentCache.Invalidate(PathId::Intern(path));
+    if (!result)
+    {
+        Lumen::DebugLog::Error("Unable to append binary file, {}", path.string());
+    }
+    return result;
+}
+
+/// hash the content of a file, returns false if it cannot be read
+bool FileSystem::ContentHash(const std::filesystem::path &path, Hash64 &hash)
+{
+    L_ASSERT(Hidden::gFileSytemState);
+    Id::Type file = Map(path);
+    if (file == Id::Invalid)
+    {
+        return false;
+    }
+    // cached contents were hashed when cached
+    Hidden::HandleSlot *handleSlot = Hidden::FindSlot(file);
+    hash = handleSlot->mCachedContent ? handleSlot->mCachedContent->mHash : ContentHasher::Hash(handleSlot->mMappedData);
+    Close(file);
+    return true;
+}
+
+/// checks if a path is packed
+bool FileSystem::IsPacked(const std::filesystem::path &path)
+{
+    L_ASSERT(Hidden::gFileSytemState);
+    Hidden::PathView relative;
+    if (IFileSystemPtr fileSystem = Hidden::ResolveMount(path, relative))
+    {
+        return fileSystem->Packed();
     }
     Lumen::DebugLog::Error("No registered file system for path {}", path.string());
     return false;
@@ -352,13 +1275,10 @@ bool FileSystem::IsPacked(const std::filesystem::path &path)
 bool FileSystem::Exists(const std::filesystem::path &path)
 {
     L_ASSERT(Hidden::gFileSytemState);
-    for (auto &[mountPoint, fileSystem] : Hidden::gFileSytemState->mFileSystems)
+    Hidden::PathView relative;
+    if (IFileSystemPtr fileSystem = Hidden::ResolveMount(path, relative))
     {
-        if (Hidden::StartsWith(path, mountPoint))
-        {
-            std::filesystem::path relativePath = path.lexically_relative(mountPoint);
-            return fileSystem->Exists(relativePath.string());
-        }
+        return fileSystem->Exists(relative);
     }
     return false;
 }
@@ -367,30 +1287,31 @@ bool FileSystem::Exists(const std::filesystem::path &path)
 std::vector<FileSystem::FileEntry> FileSystem::ListFiles(const std::filesystem::path &path)
 {
     L_ASSERT(Hidden::gFileSytemState);
-    std::vector<FileEntry> files;
-    for (auto &[mountPoint, fileSystem] : Hidden::gFileSytemState->mFileSystems)
+    Hidden::PathView relative;
+    if (IFileSystemPtr fileSystem = Hidden::ResolveMount(path, relative))
     {
-        if (Hidden::StartsWith(path, mountPoint))
-        {
-            std::filesystem::path relativePath = path.lexically_relative(mountPoint);
-            std::vector<FileEntry> mountFiles = fileSystem->ListFiles(relativePath);
-            files.insert(files.end(), mountFiles.begin(), mountFiles.end());
-        }
+        return fileSystem->ListFiles(relative);
     }
-    return files;
+    return {};
 }
 
 /// opens a file on the specified path
 Id::Type FileSystem::Open(const std::filesystem::path &path, bool write, bool binary)
 {
     L_ASSERT(Hidden::gFileSytemState);
-    for (auto &[mountPoint, fileSystem] : Hidden::gFileSytemState->mFileSystems)
+    Hidden::PathView relative;
+    if (IFileSystemPtr fileSystem = Hidden::ResolveMount(path, relative))
     {
-        if (Hidden::StartsWith(path, mountPoint))
+        Id::Type handle = fileSystem->Open(relative, write, binary);
+        if (handle != Id::Invalid)
         {
-            std::filesystem::path relativePath = path.lexically_relative(mountPoint);
-            return fileSystem->Open(relativePath.string(), write, binary);
+            Hidden::HandleSlot &handleSlot = Hidden::BindHandle(handle, fileSystem);
+            if (write)
+            {
+                handleSlot.mWritePath = PathId::Intern(path);
+            }
         }
+        return handle;
     }
     Lumen::DebugLog::Error("No registered file system for path {}", path.string());
     return Id::Invalid;
@@ -400,27 +1321,127 @@ Id::Type FileSystem::Open(const std::filesystem::path &path, bool write, bool bi
 void FileSystem::Close(const Id::Type handle)
 {
     L_ASSERT(Hidden::gFileSytemState);
-    for (auto &[mountPoint, fileSystem] : Hidden::gFileSytemState->mFileSystems)
+    if (Hidden::HandleSlot *handleSlot = Hidden::FindSlot(handle); handleSlot && handleSlot->mCachedContent)
+    {
+        Hidden::ReleaseHandle(handle);
+        return;
+    }
+    if (IFileSystem *fileSystem = Hidden::FindFileSystem(handle))
     {
-        if (fileSystem->Handles(handle))
+        fileSystem->Close(handle);
+
+        // dropped once written, so content cached while writing does not stay
+        Hidden::HandleSlot *handleSlot = Hidden::FindSlot(handle);
+        if (handleSlot->mWritePath.Valid())
         {
-            fileSystem->Close(handle);
-            return;
+            Hidden::gFileSytemState->mContentCache.Invalidate(handleSlot->mWritePath);
         }
+        Hidden::ReleaseHandle(handle);
+        return;
     }
     Lumen::DebugLog::Error("No registered file system for file handle {}", handle);
 }
 
+/// maps a whole file read-only, files that cannot be mapped are read into a copy, the data stays valid until the handle is closed
+Id::Type FileSystem::Map(const std::filesystem::path &path)
+{
+    L_ASSERT(Hidden::gFileSytemState);
+    Hidden::PathView relative;
+    IFileSystemPtr fileSystem = Hidden::ResolveMount(path, relative);
+    if (!fileSystem)
+    {
+        Lumen::DebugLog::Error("No registered file system for path {}", path.string());
+        return Id::Invalid;
+    }
+
+    // cached contents are mapped without touching the file system
+    ContentCache &cache = Hidden::gFileSytemState->mContentCache;
+    PathId key = PathId::Intern(path);
+    if (ContentCache::ContentPtr content = cache.Find(key))
+    {
+        Id::Type handle = FileSystem::GenerateFileId();
+        Hidden::HandleSlot &handleSlot = *Hidden::FindSlot(handle);
+        handleSlot.mMappedData = content->mData;
+        handleSlot.mCachedContent = std::move(content);
+        return handle;
+    }
+    qword generation = cache.Generation();
+
+    std::filesystem::path relativePath(relative);
+    std::span<const byte> data;
+    Id::Type handle = fileSystem->Map(relativePath, data);
+    if (handle != Id::Invalid)
+    {
+        Hidden::BindHandle(handle, fileSystem).mMappedData = data;
+        cache.Insert(key, data, generation);
+        return handle;
+    }
+
+    // copying fallback, opening for read would create a missing file
+    if (!fileSystem->Exists(relativePath) || (handle = fileSystem->Open(relativePath, false, true)) == Id::Invalid)
+    {
+        return Id::Invalid;
+    }
+    Hidden::HandleSlot &handleSlot = Hidden::BindHandle(handle, fileSystem);
+    handleSlot.mMappedCopy.resize(fileSystem->Size(handle));
+    if (fileSystem->ReadBytes(handle, handleSlot.mMappedCopy.data(), handleSlot.mMappedCopy.size()) != handleSlot.mMappedCopy.size())
+    {
+        FileSystem::Close(handle);
+        return Id::Invalid;
+    }
+    handleSlot.mMappedData = handleSlot.mMappedCopy;
+    cache.Insert(key, handleSlot.mMappedData, generation);
+    return handle;
+}
+
+/// gets the data of a mapped file by handle
+std::span<const byte> FileSystem::MappedData(const Id::Type handle)
+{
+    L_ASSERT(Hidden::gFileSytemState);
+    Hidden::HandleSlot *handleSlot = Hidden::FindSlot(handle);
+    if (!handleSlot || (!handleSlot->mFileSystem && !handleSlot->mCachedContent))
+    {
+        Lumen::DebugLog::Error("No registered file system for file handle {}", handle);
+        return {};
+    }
+    return handleSlot->mMappedData;
+}
+
+/// reads bytes at an offset of a file without a handle, returns the bytes read or SIZE_MAX if the file cannot be read
+size_t FileSystem::ReadAt(const std::filesystem::path &path, size_t offset, std::span<byte> buffer)
+{
+    L_ASSERT(Hidden::gFileSytemState);
+    Hidden::PathView relative;
+    if (IFileSystemPtr fileSystem = Hidden::ResolveMount(path, relative))
+    {
+        return fileSystem->ReadAt(relative, offset, buffer);
+    }
+
+    // no logging, this runs on io threads
+    return SIZE_MAX;
+}
+
+/// path of a file on the native file system, empty if it is not stored as a native file
+std::filesystem::path FileSystem::NativePath(const std::filesystem::path &path)
+{
+    L_ASSERT(Hidden::gFileSytemState);
+    Hidden::PathView relative;
+    if (IFileSystemPtr fileSystem = Hidden::ResolveMount(path, relative))
+    {
+        return fileSystem->NativePath(relative);
+    }
+
+    // no logging, this runs on io threads
+    return {};
+}
+
 /// reads bytes from a file handle
 size_t FileSystem::ReadBytes(const Id::Type handle, void *buffer, const size_t size)
 {
     L_ASSERT(Hidden::gFileSytemState);
-    for (auto &[mountPoint, fileSystem] : Hidden::gFileSytemState->mFileSystems)
+    if (IFileSystem *fileSystem = Hidden::FindFileSystem(handle))
     {
-        if (fileSystem->Handles(handle))
-        {
-            return fileSystem->ReadBytes(handle, buffer, size);
-        }
+        return fileSystem->ReadBytes(handle, buffer, size);
     }
     Lumen::DebugLog::Error("No registered file system for file handle {}", handle);
     return 0;
@@ -430,12 +1451,9 @@ size_t FileSystem::ReadBytes(const Id::Type handle, void *buffer, const size_t s
 bool FileSystem::WriteBytes(const Id::Type handle, const void *buffer, const size_t size)
 {
     L_ASSERT(Hidden::gFileSytemState);
-    for (auto &[mountPoint, fileSystem] : Hidden::gFileSytemState->mFileSystems)
+    if (IFileSystem *fileSystem = Hidden::FindFileSystem(handle))
     {
-        if (fileSystem->Handles(handle))
-        {
-            return fileSystem->WriteBytes(handle, buffer, size);
-        }
+        return fileSystem->WriteBytes(handle, buffer, size);
     }
     Lumen::DebugLog::Error("No registered file system for file handle {}", handle);
     return false;
@@ -445,12 +1463,9 @@ bool FileSystem::WriteBytes(const Id::Type handle, const void *buffer, const siz
 std::string FileSystem::ReadText(const Id::Type handle, int lineCount)
 {
     L_ASSERT(Hidden::gFileSytemState);
-    for (auto &[mountPoint, fileSystem] : Hidden::gFileSytemState->mFileSystems)
+    if (IFileSystem *fileSystem = Hidden::FindFileSystem(handle))
     {
-        if (fileSystem->Handles(handle))
-        {
-            return fileSystem->ReadText(handle, lineCount);
-        }
+        return fileSystem->ReadText(handle, lineCount);
     }
     Lumen::DebugLog::Error("No registered file system for file handle {}", handle);
     return {};
@@ -460,12 +1475,9 @@ std::string FileSystem::ReadText(const Id::Type handle, int lineCount)
 bool FileSystem::WriteText(const Id::Type handle, const std::string &text)
 {
     L_ASSERT(Hidden::gFileSytemState);
-    for (auto &[mountPoint, fileSystem] : Hidden::gFileSytemState->mFileSystems)
+    if (IFileSystem *fileSystem = Hidden::FindFileSystem(handle))
     {
-        if (fileSystem->Handles(handle))
-        {
-            return fileSystem->WriteText(handle, text);
-        }
+        return fileSystem->WriteText(handle, text);
     }
     Lumen::DebugLog::Error("No registered file system for file handle {}", handle);
     return false;
@@ -475,36 +1487,38 @@ bool FileSystem::WriteText(const Id::Type handle, const std::string &text)
 bool FileSystem::ReadInfofileRecord(const Id::Type handle, Serialized::Type &record)
 {
     L_ASSERT(Hidden::gFileSytemState);
-    for (auto &[mountPoint, fileSystem] : Hidden::gFileSytemState->mFileSystems)
+    if (IFileSystem *fileSystem = Hidden::FindFileSystem(handle))
     {
-        if (fileSystem->Handles(handle))
+        if (fileSystem->Packed())
         {
-            if (fileSystem->Packed())
-            {
 //??                std::vector<uint8_t> serData = Serialized::Type::to_cbor(record);
 //??                return fileSystem->WriteBytes(handle, serData.data(), serData.size());
-                size_t fileSize = FileSystem::Size(handle);
-                std::vector<uint8_t> v(fileSize);
-                if (FileSystem::ReadBytes(handle, v.data(), fileSize) == fileSize)
+            size_t fileSize = FileSystem::Size(handle);
+            std::vector<uint8_t> v(fileSize);
+            if (FileSystem::ReadBytes(handle, v.data(), fileSize) == fileSize)
+            {
+                if (!Hidden::Decompress(v))
                 {
-                    try
-                    {
-                        record = Serialized::Type::from_cbor(v);
-                    }
-                    catch (const std::exception &e)
-                    {
-                        Lumen::DebugLog::Error("Unable to parse scene file {}, error {}", "unknown"/*path.string()*/, e.what());
-                        return false;
-                    }
+                    Lumen::DebugLog::Error("Unable to decompress infofile record");
+                    return false;
+                }
+                try
+                {
+                    record = Serialized::Type::from_cbor(v);
+                }
+                catch (const std::exception &e)
+                {
+                    Lumen::DebugLog::Error("Unable to parse scene file {}, error {}", "unknown"/*path.string()*/, e.what());
+                    return false;
                 }
             }
-            else
-            {
+        }
+        else
+        {
 //??                return fileSystem->WriteText(handle, record.dump(4));
-                record = Serialized::Type::parse(FileSystem::ReadText(handle));
-            }
-            return true;
+            record = Serialized::Type::parse(FileSystem::ReadText(handle));
         }
+        return true;
     }
     Lumen::DebugLog::Error("No registered file system for file handle {}", handle);
     return false;
@@ -514,19 +1528,20 @@ bool FileSystem::ReadInfofileRecord(const Id::Type handle, Serialized::Type &rec
 bool FileSystem::WriteInfofileRecord(const Id::Type handle, const Serialized::Type &record)
 {
     L_ASSERT(Hidden::gFileSytemState);
-    for (auto &[mountPoint, fileSystem] : Hidden::gFileSytemState->mFileSystems)
+    if (IFileSystem *fileSystem = Hidden::FindFileSystem(handle))
     {
-        if (fileSystem->Handles(handle))
+        if (fileSystem->Packed())
         {
-            if (fileSystem->Packed())
+            std::vector<uint8_t> serData = Serialized::Type::to_cbor(record);
+            if (Hidden::gFileSytemState->mCompressPacked)
             {
-                std::vector<uint8_t> serData = Serialized::Type::to_cbor(record);
-                return fileSystem->WriteBytes(handle, serData.data(), serData.size());
-            }
-            else
-            {
-                return fileSystem->WriteText(handle, record.dump(4));
+                serData = Compression::Compress(serData);
             }
+            return fileSystem->WriteBytes(handle, serData.data(), serData.size());
+        }
+        else
+        {
+            return fileSystem->WriteText(handle, record.dump(4));
         }
     }
     Lumen::DebugLog::Error("No registered file system for file handle {}", handle);
@@ -537,12 +1552,9 @@ bool FileSystem::WriteInfofileRecord(const Id::Type handle, const Serialized::Ty
 size_t FileSystem::Tell(const Id::Type handle)
 {
     L_ASSERT(Hidden::gFileSytemState);
-    for (auto &[mountPoint, fileSystem] : Hidden::gFileSytemState->mFileSystems)
+    if (IFileSystem *fileSystem = Hidden::FindFileSystem(handle))
     {
-        if (fileSystem->Handles(handle))
-        {
-            return fileSystem->Tell(handle);
-        }
+        return fileSystem->Tell(handle);
     }
     Lumen::DebugLog::Error("No registered file system for file handle {}", handle);
     return -1;
@@ -552,13 +1564,10 @@ size_t FileSystem::Tell(const Id::Type handle)
 void FileSystem::Seek(const Id::Type handle, const size_t position)
 {
     L_ASSERT(Hidden::gFileSytemState);
-    for (auto &[mountPoint, fileSystem] : Hidden::gFileSytemState->mFileSystems)
+    if (IFileSystem *fileSystem = Hidden::FindFileSystem(handle))
     {
-        if (fileSystem->Handles(handle))
-        {
-            fileSystem->Seek(handle, position);
-            return;
-        }
+        fileSystem->Seek(handle, position);
+        return;
     }
     Lumen::DebugLog::Error("No registered file system for file handle {}", handle);
 }
@@ -567,12 +1576,9 @@ void FileSystem::Seek(const Id::Type handle, const size_t position)
 size_t FileSystem::Size(const Id::Type handle)
 {
     L_ASSERT(Hidden::gFileSytemState);
-    for (auto &[mountPoint, fileSystem] : Hidden::gFileSytemState->mFileSystems)
+    if (IFileSystem *fileSystem = Hidden::FindFileSystem(handle))
     {
-        if (fileSystem->Handles(handle))
-        {
-            return fileSystem->Size(handle);
-        }
+        return fileSystem->Size(handle);
     }
     Lumen::DebugLog::Error("No registered file system for file handle {}", handle);
     return -1;
@@ -25,28 +25,28 @@ public:
     ~Impl() = default;
 
     /// check if asset exists
-    [[nodiscard]] bool Exists(const std::filesystem::path &path) const
+    [[nodiscard]] bool Exists(PathId path) const
     {
-        return FileSystem::Exists(path);
+        return FileSystem::Exists(path.Path());
     }
 
     /// import asset
-    [[nodiscard]] Expected<AssetPtr> Import(EngineWeakPtr &engine, HashType type, const std::filesystem::path &path) const
+    [[nodiscard]] Expected<AssetPtr> Import(EngineWeakPtr &engine, HashType type, PathId path) const
     {
         if (type == Material::Type())
         {
-            auto materialExpected = Material::MakePtr(path);
+            auto materialExpected = Material::MakePtr(path.Path());
             if (!materialExpected)
             {
                 return Expected<AssetPtr>::Unexpected(materialExpected.Error());
             }
             if (!materialExpected.Value()->Load())
             {
-                return Expected<AssetPtr>::Unexpected(std::format("Unable to import material resource, {}", path.string()));
+                return Expected<AssetPtr>::Unexpected(std::format("Unable to import material resource, {}", path.String()));
             }
             return materialExpected;
         }
-        return Expected<AssetPtr>::Unexpected(std::format("Unknown resource type, {}", path.string()));
+        return Expected<AssetPtr>::Unexpected(std::format("Unknown resource type, {}", path.String()));
     }
 };
 
@@ -62,13 +62,13 @@ AssetFactoryOldPtr FileSystemResources::MakePtr(float priority)
 }
 
 /// check if asset exists
-[[nodiscard]] bool FileSystemResources::Exists(const std::filesystem::path &path) const
+[[nodiscard]] bool FileSystemResources::Exists(PathId path) const
 {
     return mImpl->Exists(path);
 }
 
 /// import asset
-Expected<AssetPtr> FileSystemResources::Import(EngineWeakPtr &engine, HashType type, const std::filesystem::path &path) const
+Expected<AssetPtr> FileSystemResources::Import(EngineWeakPtr &engine, HashType type, PathId path) const
 {
     return mImpl->Import(engine, type, path);
 }
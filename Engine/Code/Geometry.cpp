@@ -21,10 +21,15 @@ public:
     /// constructs a geometry
     explicit Impl() = default;
 
+    /// serialized fields
+    SERIALIZED_FIELDS(
+        SERIALIZED_FIELD(Impl, mMeshPath, "Lumen::Mesh", PathId()));
+
     /// serialize
     void Serialize(Serialized::Type &out, bool packed) const
     {
-        Serialized::SerializeValue(out, packed, Serialized::cMeshTypeToken, Serialized::cMeshTypeTokenPacked, mMesh->Path().string());
+        static_assert(std::get<0>(SerializedFields()).mNamePacked == Serialized::cMeshTypeTokenPacked, "the mesh field keeps the key of the mesh token");
+        Serialized::SerializeFields(out, packed, *this, SerializedFields());
     }
 
     /// deserialize
@@ -33,13 +38,12 @@ public:
         mMesh.reset();
 
         // load mesh
-        Serialized::Type path = {};
-        Serialized::DeserializeValue(in, packed, Serialized::cMeshTypeToken, Serialized::cMeshTypeTokenPacked, path);
-        if (path.empty())
+        Serialized::DeserializeFields(in, packed, *this, SerializedFields(), "Geometry");
+        if (!mMeshPath.Valid())
         {
             throw std::runtime_error(std::format("Unable to load mesh resource, no path in mesh asset"));
         }
-        Expected<AssetPtr> meshExp = AssetManagerOld::Import(Mesh::Type(), path);
+        Expected<AssetPtr> meshExp = AssetManagerOld::Import(Mesh::Type(), mMeshPath.Path());
         if (!meshExp.HasValue())
         {
             throw std::runtime_error(std::format("Unable to load mesh resource, {}", meshExp.Error()));
@@ -51,11 +55,18 @@ public:
     [[nodiscard]] const MeshPtr GetMesh() const { return mMesh;  }
 
     /// set mesh
-    void SetMesh(const MeshPtr &mesh) { mMesh = mesh; }
+    void SetMesh(const MeshPtr &mesh)
+    {
+        mMesh = mesh;
+        mMeshPath = mesh ? PathId::Intern(mesh->Path()) : PathId();
+    }
 
 private:
     /// mesh
     MeshPtr mMesh;
+
+    /// mesh path, the serialized state of the mesh
+    PathId mMeshPath;
 };
 
 //==============================================================================================================================================================================
@@ -88,4 +99,8 @@ void Geometry::Deserialize(const Serialized::Type &in, bool packed)
 const MeshPtr Geometry::GetMesh() const { return mImpl->GetMesh(); }
 
 /// set mesh
-void Geometry::SetMesh(const MeshPtr &mesh) { mImpl->SetMesh(mesh); }
+void Geometry::SetMesh(const MeshPtr &mesh)
+{
+    mImpl->SetMesh(mesh);
+    SetDirty();
+}
@@ -0,0 +1,57 @@
+//==============================================================================================================================================================================
+/// \file
+/// \brief     Editor, linux headless implementation
+/// \copyright Copyright (c) Gustavo Goedert. All rights reserved.
+//==============================================================================================================================================================================
+#ifdef EDITOR
+
+#include "lEditor.h"
+
+using namespace Lumen;
+
+/// Editor::Impl class, linux has no window or renderer platform, so the editor has no user interface and only the editor data paths run
+class Editor::Impl
+{
+    CLASS_NO_DEFAULT_CTOR(Impl);
+    CLASS_NO_COPY_MOVE(Impl);
+    CLASS_PTR_UNIQUEMAKER(Impl);
+    friend class Editor;
+
+public:
+    /// constructs editor
+    explicit Impl(const ApplicationWeakPtr &application) : mApplication(application) {}
+
+private:
+    /// application
+    ApplicationWeakPtr mApplication;
+};
+
+//==============================================================================================================================================================================
+
+/// constructs editor
+Editor::Editor(const ApplicationWeakPtr &application) : mImpl(Editor::Impl::MakeUniquePtr(application)) {}
+
+/// virtual destructor
+Editor::~Editor() {}
+
+/// creates a smart pointer version of the editor
+EditorPtr Editor::MakePtr(const ApplicationWeakPtr &application)
+{
+    return EditorPtr(new Editor(application));
+}
+
+/// initialize editor
+void Editor::Initialize() {}
+
+/// shutdown editor
+void Editor::Shutdown() {}
+
+/// editor first run
+void Editor::FirstRun() {}
+
+/// process asset changes, there are no editor windows to update
+void Editor::ProcessAssetChanges(std::vector<FileSystem::AssetChange> &&assetBatch) {}
+
+/// run editor
+void Editor::Run() {}
+#endif
@@ -0,0 +1,19 @@
+//==============================================================================================================================================================================
+/// \file
+/// \brief     Engine, linux support
+/// \copyright Copyright (c) Gustavo Goedert. All rights reserved.
+//==============================================================================================================================================================================
+
+#include "lEngine.h"
+
+/// \cond
+#include <cstdio>
+/// \endcond
+
+/// debug log, linux support, there is no debugger output so debug builds write to stderr
+void Lumen::Engine::DebugOutput(const std::string &message)
+{
+#ifndef NDEBUG
+    std::fprintf(stderr, "%s\n", message.c_str());
+#endif
+}
@@ -0,0 +1,632 @@
+//==============================================================================================================================================================================
+/// \file
+/// \brief     FolderFileSystem, posix implementation
+/// \copyright Copyright (c) Gustavo Goedert. All rights reserved.
+//==============================================================================================================================================================================
+
+#include "lFolderFileSystem.h"
+#include "lFileIndex.h"
+#include "lHandleMap.h"
+
+/// \cond
+#include <cerrno>
+#include <fstream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+/// \endcond
+
+using namespace Lumen;
+
+/// Lumen Hidden namespace
+namespace Lumen::Hidden
+{
+    /// number of files committed together from which one flush of the whole file system is cheaper than one per file
+    constexpr size_t cSyncFileSystemPaths = 32;
+}
+
+/// FolderFileSystem::Impl class
+class FolderFileSystem::Impl
+{
+    CLASS_NO_DEFAULT_CTOR(Impl);
+    CLASS_NO_COPY_MOVE(Impl);
+    CLASS_PTR_UNIQUEMAKER(Impl);
+    friend class FolderFileSystem;
+
+public:
+    /// constructs a folder file system implementation
+    explicit Impl(const std::filesystem::path &path, const std::filesystem::path &indexPath) : mPath(path), mIndexPath(indexPath) {}
+
+    /// destroys the folder file system implementation, unmapping files that were not closed
+    ~Impl()
+    {
+        mMappedFiles.ForEach([](Id::Type, MappedFile &mappedFile)
+        {
+            munmap(mappedFile.mView, mappedFile.mSize);
+        });
+    }
+
+    /// initialize file system, only the files that changed since the saved index are hashed
+    /// the folder is scanned in the background and its changes pushed a chunk at a time, so processing starts before the scan is done
+    void Initialize()
+    {
+        if (!mIndexPath.empty())
+        {
+            mIndex.Load(mIndexPath);
+        }
+        mIndex.UpdateAsync(mPath, [](std::vector<FileSystem::FileChange> &&fileBatch)
+        {
+            FileSystem::PushFileChangeBatch(std::move(fileBatch));
+        });
+    }
+
+    /// shutdown file system, the index is brought up to date with the folder and saved
+    void Shutdown()
+    {
+        mIndex.Wait();
+        if (!mIndexPath.empty())
+        {
+            std::vector<FileSystem::FileChange> fileBatch;
+            mIndex.Update(mPath, fileBatch);
+            mIndex.Save(mIndexPath);
+        }
+    }
+
+    /// whether this file system is packed
+    bool Packed() const
+    {
+        return false;
+    }
+
+    /// whether this file system handles the specified file handle
+    bool Handles(Id::Type handle)
+    {
+        return mOpenFiles.Contains(handle) || mMappedFiles.Contains(handle);
+    }
+
+    /// check if a file exists
+    bool Exists(const std::filesystem::path &path)
+    {
+        std::filesystem::path fullPath = mPath / path;
+        return std::filesystem::exists(fullPath);
+    }
+
+    /// list files in a directory
+    std::vector<FileSystem::FileEntry> ListFiles(const std::filesystem::path &path)
+    {
+        std::vector<FileSystem::FileEntry> files;
+        std::error_code error;
+        for (const auto &entry : std::filesystem::directory_iterator(mPath / path, error))
+        {
+            if (entry.is_regular_file())
+            {
+                files.push_back({ FileSystem::Flag::File, entry.path().filename().string() });
+            }
+            else if (entry.is_directory())
+            {
+                files.push_back({ FileSystem::Flag::Directory, entry.path().filename().string() });
+            }
+        }
+        return files;
+    }
+
+    /// opens a file on the specified path
+    Id::Type Open(const std::filesystem::path &path, bool write, bool binary)
+    {
+        std::filesystem::path fullPath = mPath / path;
+        if (!Exists(path))
+        {
+            std::ofstream file(fullPath, (binary ? std::ios::binary : (std::ios::openmode)0));
+        }
+        std::ios::openmode mode = std::ios::in | std::ios::out;
+        if (write)
+        {
+            mode |= std::ios::trunc;
+        }
+        if (binary)
+        {
+            mode |= std::ios::binary;
+        }
+        std::fstream file(fullPath, mode);
+        if (file.is_open())
+        {
+            Id::Type fileId = FileSystem::GenerateFileId();
+            mOpenFiles.Emplace(fileId, std::move(file));
+            return fileId;
+        }
+        return Id::Invalid;
+    }
+
+    /// closes a file handle
+    void Close(const Id::Type handle)
+    {
+        if (MappedFile *mappedFile = mMappedFiles.Find(handle))
+        {
+            munmap(mappedFile->mView, mappedFile->mSize);
+            mMappedFiles.Erase(handle);
+            return;
+        }
+        mOpenFiles.Erase(handle);
+    }
+
+    /// maps a whole file read-only, the data stays valid until the handle is closed
+    Id::Type Map(const std::filesystem::path &path, std::span<const byte> &data)
+    {
+        std::filesystem::path fullPath = mPath / path;
+        int file = open(fullPath.c_str(), O_RDONLY | O_CLOEXEC);
+        if (file < 0)
+        {
+            return Id::Invalid;
+        }
+
+        // empty files cannot be mapped, they are read into a copy instead, the mapping keeps the file alive after close
+        struct stat status = {};
+        void *view = MAP_FAILED;
+        if (fstat(file, &status) == 0 && S_ISREG(status.st_mode) && status.st_size > 0)
+        {
+            view = mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+        }
+        close(file);
+        if (view == MAP_FAILED)
+        {
+            return Id::Invalid;
+        }
+
+        // whole files are usually read front to back
+        MappedFile mappedFile = { view, static_cast<size_t>(status.st_size) };
+        madvise(mappedFile.mView, mappedFile.mSize, MADV_SEQUENTIAL);
+        Id::Type fileId = FileSystem::GenerateFileId();
+        mMappedFiles.Emplace(fileId, mappedFile);
+        data = std::span<const byte>(static_cast<const byte *>(mappedFile.mView), mappedFile.mSize);
+        return fileId;
+    }
+
+    /// reads bytes at an offset of a file without a handle, each read opens the file so io threads share no state
+    size_t ReadAt(const std::filesystem::path &path, size_t offset, std::span<byte> buffer)
+    {
+        std::filesystem::path fullPath = mPath / path;
+        int file = open(fullPath.c_str(), O_RDONLY | O_CLOEXEC);
+        if (file < 0)
+        {
+            return SIZE_MAX;
+        }
+
+        // positional reads, pread may return less than asked for
+        size_t size = 0;
+        while (size < buffer.size())
+        {
+            ssize_t read = pread(file, buffer.data() + size, buffer.size() - size, static_cast<off_t>(offset + size));
+            if (read < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                size = SIZE_MAX;
+                break;
+            }
+            if (read == 0)
+            {
+                break;
+            }
+            size += static_cast<size_t>(read);
+        }
+        close(file);
+        return size;
+    }
+
+    /// path of a file on the native file system
+    std::filesystem::path NativePath(const std::filesystem::path &path) const
+    {
+        return mPath / path;
+    }
+
+    /// reads bytes from a file handle
+    size_t ReadBytes(const Id::Type handle, void *buffer, const size_t size)
+    {
+        FileState *state = mOpenFiles.Find(handle);
+        if (!state)
+        {
+            return false;
+        }
+        std::fstream &file = state->mFileStream;
+        file.read(static_cast<char *>(const_cast<void *>(buffer)), size);
+        return file.gcount();
+    }
+
+    /// writes bytes to a file handle
+    bool WriteBytes(const Id::Type handle, const void *buffer, const size_t size)
+    {
+        FileState *state = mOpenFiles.Find(handle);
+        if (!state)
+        {
+            return false;
+        }
+        std::fstream &file = state->mFileStream;
+        file.write(static_cast<const char *>(buffer), size);
+        return true;
+    }
+
+    /// reads text from a file handle, a negative line count reads to the end, the text is returned as stored
+    std::string ReadText(const Id::Type handle, int lineCount)
+    {
+        std::string text;
+
+        FileState *state = mOpenFiles.Find(handle);
+        if (!state)
+        {
+            return text;
+        }
+        std::fstream &file = state->mFileStream;
+
+        if (lineCount < 0)
+        {
+            // the rest of the file in one read, sized from the file
+            const std::streampos current = file.tellg();
+            file.seekg(0, std::ios::end);
+            const std::streampos end = file.tellg();
+            file.seekg(current, std::ios::beg);
+            if (current < 0 || end <= current)
+            {
+                return text;
+            }
+            text.resize(static_cast<size_t>(end - current));
+            file.read(text.data(), text.size());
+
+            // text mode may translate line endings, so fewer characters than bytes can be read
+            text.resize(static_cast<size_t>(file.gcount()));
+            file.clear();
+        }
+        else
+        {
+            // only the requested lines are read, newlines included
+            std::streambuf *buffer = file.rdbuf();
+            while (lineCount > 0)
+            {
+                int c = buffer->sbumpc();
+                if (c == std::char_traits<char>::eof())
+                {
+                    break;
+                }
+                text.push_back(static_cast<char>(c));
+                if (c == '\n')
+                {
+                    --lineCount;
+                }
+            }
+        }
+
+        return text;
+    }
+
+    /// writes text to a file handle
+    bool WriteText(const Id::Type handle, const std::string &text)
+    {
+        FileState *state = mOpenFiles.Find(handle);
+        if (!state)
+        {
+            return false;
+        }
+        std::fstream &file = state->mFileStream;
+
+        file << text;
+        return true;
+    }
+
+    /// write a whole file aside of its path, called from any thread
+    bool WriteAside(const std::filesystem::path &path, std::span<const byte> data)
+    {
+        std::filesystem::path asidePath = mPath / path;
+        asidePath += FileSystem::cAsideSuffix;
+        int file = open(asidePath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+        if (file < 0)
+        {
+            return false;
+        }
+
+        // write may take less than given
+        size_t size = 0;
+        while (size < data.size())
+        {
+            ssize_t written = write(file, data.data() + size, data.size() - size);
+            if (written < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                break;
+            }
+            size += static_cast<size_t>(written);
+        }
+        bool result = (close(file) == 0) && (size == data.size());
+        if (!result)
+        {
+            unlink(asidePath.c_str());
+        }
+        return result;
+    }
+
+    /// replace files with the files written aside of them, a durable commit has every file written aside on disk before any replaces its file
+    bool CommitAside(std::span<const std::filesystem::path> paths, FileSystem::Durability durability)
+    {
+        bool durable = (durability == FileSystem::Durability::Durable) && !paths.empty();
+
+        // few files are flushed one by one, large batches with one flush of the whole file system
+        if (durable && !FlushAside(paths))
+        {
+            for (const std::filesystem::path &path : paths)
+            {
+                std::filesystem::path asidePath = mPath / path;
+                asidePath += FileSystem::cAsideSuffix;
+                unlink(asidePath.c_str());
+            }
+            return false;
+        }
+
+        bool result = true;
+        std::vector<std::filesystem::path> folders;
+        for (const std::filesystem::path &path : paths)
+        {
+            std::filesystem::path fullPath = mPath / path;
+            std::filesystem::path asidePath = fullPath;
+            asidePath += FileSystem::cAsideSuffix;
+            if (rename(asidePath.c_str(), fullPath.c_str()) != 0)
+            {
+                unlink(asidePath.c_str());
+                result = false;
+                continue;
+            }
+            if (durable && std::find(folders.begin(), folders.end(), fullPath.parent_path()) == folders.end())
+            {
+                folders.push_back(fullPath.parent_path());
+            }
+        }
+
+        // the renames are on disk once their folders are
+        for (const std::filesystem::path &folderPath : folders)
+        {
+            result = Flush(folderPath, O_RDONLY | O_DIRECTORY) && result;
+        }
+        return result;
+    }
+
+    /// flush the files written aside to disk
+    bool FlushAside(std::span<const std::filesystem::path> paths)
+    {
+        if (paths.size() >= Hidden::cSyncFileSystemPaths)
+        {
+            return Flush(mPath, O_RDONLY | O_DIRECTORY, true);
+        }
+        for (const std::filesystem::path &path : paths)
+        {
+            std::filesystem::path asidePath = mPath / path;
+            asidePath += FileSystem::cAsideSuffix;
+            if (!Flush(asidePath, O_RDONLY))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /// flush a file or folder to disk, or the whole file system holding it
+    static bool Flush(const std::filesystem::path &path, int flags, bool fileSystem = false)
+    {
+        int file = open(path.c_str(), flags | O_CLOEXEC);
+        if (file < 0)
+        {
+            return false;
+        }
+        bool result = (fileSystem ? syncfs(file) : fsync(file)) == 0;
+        return (close(file) == 0) && result;
+    }
+
+    /// gets the current position in the file by handle
+    size_t Tell(const Id::Type handle)
+    {
+        FileState *state = mOpenFiles.Find(handle);
+        if (!state)
+        {
+            return 0;
+        }
+        return static_cast<size_t>(state->mFileStream.tellg());
+    }
+
+    /// seeks to a position in the file by handle
+    void Seek(const Id::Type handle, const size_t position)
+    {
+        FileState *state = mOpenFiles.Find(handle);
+        if (!state)
+        {
+            return;
+        }
+        state->mFileStream.seekg(static_cast<std::streamoff>(position), std::ios::beg);
+    }
+
+    /// gets the size of the file by handle
+    size_t Size(const Id::Type handle)
+    {
+        FileState *state = mOpenFiles.Find(handle);
+        if (!state)
+        {
+            return static_cast<size_t>(-1);
+        }
+        std::fstream &file = state->mFileStream;
+
+        // get file size by seeking to the end and back
+        const std::streampos current = file.tellg();
+        file.seekg(0, std::ios::end);
+        const std::streampos end = file.tellg();
+        file.seekg(current, std::ios::beg);
+
+        return static_cast<size_t>(end);
+    }
+
+private:
+    /// mapped file struct
+    struct MappedFile
+    {
+        /// mapped view
+        void *mView;
+
+        /// mapped size
+        size_t mSize;
+    };
+
+    /// file state struct
+    struct FileState
+    {
+        /// file stream
+        std::fstream mFileStream;
+    };
+
+    /// path
+    const std::filesystem::path mPath;
+
+    /// index path, empty if the index is not saved
+    const std::filesystem::path mIndexPath;
+
+    /// index of the folder
+    FileIndex mIndex;
+
+    /// open files
+    HandleMap<FileState> mOpenFiles;
+
+    /// mapped files
+    HandleMap<MappedFile> mMappedFiles;
+};
+
+//==============================================================================================================================================================================
+
+/// constructs a folder file system
+FolderFileSystem::FolderFileSystem(const std::filesystem::path &path, const std::filesystem::path &indexPath) :
+    IFileSystem(), mImpl(FolderFileSystem::Impl::MakeUniquePtr(FileSystem::NormalizeDirPath(path), indexPath)) {}
+
+/// creates a smart pointer version of the folder file system
+IFileSystemPtr FolderFileSystem::MakePtr(const std::filesystem::path &path, const std::filesystem::path &indexPath)
+{
+    return IFileSystemPtr(new FolderFileSystem(path, indexPath));
+}
+
+/// initialize file system
+void FolderFileSystem::Initialize()
+{
+    return mImpl->Initialize();
+}
+
+/// shutdown file system
+void FolderFileSystem::Shutdown()
+{
+    mImpl->Shutdown();
+}
+
+/// whether this file system is packed
+bool FolderFileSystem::Packed() const
+{
+    return mImpl->Packed();
+}
+
+/// whether this file system handles the specified file handle
+bool FolderFileSystem::Handles(Id::Type handle)
+{
+    return mImpl->Handles(handle);
+}
+
+/// check if a file exists
+bool FolderFileSystem::Exists(const std::filesystem::path &path)
+{
+    return mImpl->Exists(path);
+}
+
+/// list files in a directory
+std::vector<FileSystem::FileEntry> FolderFileSystem::ListFiles(const std::filesystem::path &path)
+{
+    return mImpl->ListFiles(path);
+}
+
+/// opens a file on the specified path
+Id::Type FolderFileSystem::Open(const std::filesystem::path &path, bool write, bool binary)
+{
+    return mImpl->Open(path, write, binary);
+}
+
+/// closes a file handle
+void FolderFileSystem::Close(const Id::Type handle)
+{
+    mImpl->Close(handle);
+}
+
+/// maps a whole file read-only, the data stays valid until the handle is closed
+Id::Type FolderFileSystem::Map(const std::filesystem::path &path, std::span<const byte> &data)
+{
+    return mImpl->Map(path, data);
+}
+
+/// reads bytes at an offset of a file without a handle
+size_t FolderFileSystem::ReadAt(const std::filesystem::path &path, size_t offset, std::span<byte> buffer)
+{
+    return mImpl->ReadAt(path, offset, buffer);
+}
+
+/// path of a file on the native file system
+std::filesystem::path FolderFileSystem::NativePath(const std::filesystem::path &path)
+{
+    return mImpl->NativePath(path);
+}
+
+/// reads bytes from a file handle
+size_t FolderFileSystem::ReadBytes(const Id::Type handle, void *buffer, const size_t size)
+{
+    return mImpl->ReadBytes(handle, buffer, size);
+}
+
+/// writes bytes to a file handle
+bool FolderFileSystem::WriteBytes(const Id::Type handle, const void *buffer, const size_t size)
+{
+    return mImpl->WriteBytes(handle, buffer, size);
+}
+
+/// reads text from a file handle
+std::string FolderFileSystem::ReadText(const Id::Type handle, const int lineCount)
+{
+    return mImpl->ReadText(handle, lineCount);
+}
+
+/// writes text to a file handle
+bool FolderFileSystem::WriteText(const Id::Type handle, const std::string &text)
+{
+    return mImpl->WriteText(handle, text);
+}
+
+/// write a whole file aside of its path, called from any thread
+bool FolderFileSystem::WriteAside(const std::filesystem::path &path, std::span<const byte> data)
+{
+    return mImpl->WriteAside(path, data);
+}
+
+/// replace files with the files written aside of them, a durable commit flushes them to disk once for all files
+bool FolderFileSystem::CommitAside(std::span<const std::filesystem::path> paths, FileSystem::Durability durability)
+{
+    return mImpl->CommitAside(paths, durability);
+}
+
+/// gets the current position in the file by handle
+size_t FolderFileSystem::Tell(const Id::Type handle)
+{
+    return mImpl->Tell(handle);
+}
+
+/// seeks to a position in the file by handle
+void FolderFileSystem::Seek(const Id::Type handle, const size_t position)
+{
+    mImpl->Seek(handle, position);
+}
+
+/// gets the size of the file by handle
+size_t FolderFileSystem::Size(const Id::Type handle)
+{
+    return mImpl->Size(handle);
+}
@@ -0,0 +1,581 @@
+//==============================================================================================================================================================================
+/// \file
+/// \brief     FolderWatcher, inotify implementation
+/// \copyright Copyright (c) Gustavo Goedert. All rights reserved.
+//==============================================================================================================================================================================
+
+#include "lFolderWatcher.h"
+#include "lFileChangeCoalescer.h"
+
+/// \cond
+#include <cerrno>
+#include <chrono>
+#include <map>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+/// \endcond
+
+using namespace Lumen;
+using namespace Lumen::Linux;
+
+/// Lumen Hidden namespace
+namespace Lumen::Hidden
+{
+    /// events watched on every folder, modifications are reported once the writer closes the file
+    constexpr uint32_t cWatchMask = IN_CREATE | IN_DELETE | IN_CLOSE_WRITE | IN_MOVED_FROM | IN_MOVED_TO | IN_ONLYDIR;
+
+    /// changes are pushed once the folder has been quiet this long
+    constexpr std::chrono::milliseconds cSettleTime(50);
+
+    /// changes are pushed at least this often, even if the folder never gets quiet
+    constexpr std::chrono::milliseconds cMaxLatency(500);
+
+    /// size of the inotify read buffer
+    constexpr size_t cEventBufferSize = 65536;
+
+    /// join a relative folder and a name
+    static std::string JoinRelative(const std::string &folder, std::string_view name)
+    {
+        return folder.empty() ? std::string(name) : folder + "/" + std::string(name);
+    }
+
+    /// whether a relative path is a folder or inside it
+    static bool IsInsideRelative(const std::string &path, const std::string &folder)
+    {
+        return path.starts_with(folder) && (path.size() == folder.size() || path[folder.size()] == '/');
+    }
+}
+
+/// FolderWatcher::Impl class
+class FolderWatcher::Impl
+{
+    CLASS_NO_DEFAULT_CTOR(Impl);
+    CLASS_NO_COPY_MOVE(Impl);
+    CLASS_PTR_UNIQUEMAKER(Impl);
+    friend class FolderWatcher;
+
+public:
+    /// constructs a folder watcher implementation
+    explicit Impl(const std::filesystem::path &path) : mPath(path), mPrefix(path.generic_string()) {}
+
+    /// destroys the folder watcher implementation
+    ~Impl()
+    {
+        Stop();
+    }
+
+    /// start watching
+    bool Start()
+    {
+        if (mThread.joinable())
+        {
+            return true;
+        }
+        if (!std::filesystem::is_directory(mPath))
+        {
+            DebugLog::Error("Could not open directory to monitor: {}", mPath.string());
+            return false;
+        }
+        mNotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        mWake = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (mNotify < 0 || mWake < 0)
+        {
+            DebugLog::Error("Could not create a folder watcher for {}, error {}", mPath.string(), errno);
+            CloseDescriptors();
+            return false;
+        }
+        mThread = std::thread(&Impl::Run, this);
+        return true;
+    }
+
+    /// stop watching
+    void Stop()
+    {
+        if (mThread.joinable())
+        {
+            uint64_t value = 1;
+            [[maybe_unused]] ssize_t written = write(mWake, &value, sizeof(value));
+            mThread.join();
+        }
+        CloseDescriptors();
+        mWatches.clear();
+        mKnown.clear();
+        mMovedFrom.clear();
+        mBatch.Clear();
+    }
+
+    /// whether the watcher is running
+    bool Running() const
+    {
+        return mThread.joinable();
+    }
+
+private:
+    /// watcher thread, everything but start and stop happens here
+    void Run()
+    {
+        // the tree is walked here, so watching a large folder never stalls the caller
+        AddWatches("", false);
+
+        std::vector<char> buffer(Hidden::cEventBufferSize);
+        pollfd descriptors[2] = { { mNotify, POLLIN, 0 }, { mWake, POLLIN, 0 } };
+        for (;;)
+        {
+            int ready = poll(descriptors, 2, Timeout());
+            if (ready < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                break;
+            }
+            if (descriptors[1].revents)
+            {
+                break;
+            }
+
+            bool pending = Pending();
+            if (descriptors[0].revents)
+            {
+                ReadEvents(buffer);
+            }
+            if (!pending && Pending())
+            {
+                mPendingSince = std::chrono::steady_clock::now();
+            }
+            if (ready == 0 || (Pending() && std::chrono::steady_clock::now() - mPendingSince >= Hidden::cMaxLatency))
+            {
+                Flush();
+            }
+        }
+    }
+
+    /// whether there are changes waiting to be pushed
+    bool Pending() const
+    {
+        return !mBatch.Empty() || !mMovedFrom.empty();
+    }
+
+    /// poll timeout in milliseconds, waits for the folder to settle when changes are pending
+    int Timeout() const
+    {
+        if (!Pending())
+        {
+            return -1;
+        }
+        auto remaining = Hidden::cMaxLatency - (std::chrono::steady_clock::now() - mPendingSince);
+        auto timeout = std::min<std::chrono::steady_clock::duration>(Hidden::cSettleTime, remaining);
+        return static_cast<int>(std::max<long long>(std::chrono::duration_cast<std::chrono::milliseconds>(timeout).count(), 0));
+    }
+
+    /// read every queued event, both halves of a rename are queued together so pairs are complete once the queue is drained
+    void ReadEvents(std::vector<char> &buffer)
+    {
+        for (;;)
+        {
+            ssize_t length = read(mNotify, buffer.data(), buffer.size());
+            if (length <= 0)
+            {
+                return;
+            }
+            for (const char *it = buffer.data(); it < buffer.data() + length;)
+            {
+                const inotify_event *event = reinterpret_cast<const inotify_event *>(it);
+                HandleEvent(*event);
+                it += sizeof(inotify_event) + event->len;
+            }
+        }
+    }
+
+    /// handle an event
+    void HandleEvent(const inotify_event &event)
+    {
+        if (event.mask & IN_Q_OVERFLOW)
+        {
+            Rescan();
+            return;
+        }
+        auto watch = mWatches.find(event.wd);
+        if (watch == mWatches.end())
+        {
+            return;
+        }
+        if (event.mask & IN_IGNORED)
+        {
+            // the folder is gone, its parent reported it
+            mWatches.erase(watch);
+            return;
+        }
+        if (event.len == 0)
+        {
+            return;
+        }
+
+        std::string relative = Hidden::JoinRelative(watch->second, event.name);
+        bool directory = event.mask & IN_ISDIR;
+        FileSystem::Flags flags = directory ? FileSystem::Flag::Directory : FileSystem::Flag::File;
+        if (event.mask & IN_CREATE)
+        {
+            Push(FileSystem::Change::Added, flags, relative);
+            Track(relative, flags);
+            if (directory)
+            {
+                // files may be created before the new folder is watched, so its contents are reported too
+                AddWatches(relative, true);
+            }
+        }
+        else if (event.mask & IN_CLOSE_WRITE)
+        {
+            Push(FileSystem::Change::Modified, flags, relative);
+        }
+        else if (event.mask & IN_DELETE)
+        {
+            Push(FileSystem::Change::Removed, flags, relative);
+            Untrack(relative);
+        }
+        else if (event.mask & IN_MOVED_FROM)
+        {
+            mMovedFrom[event.cookie] = { std::move(relative), flags };
+        }
+        else if (event.mask & IN_MOVED_TO)
+        {
+            if (auto from = mMovedFrom.find(event.cookie); from != mMovedFrom.end())
+            {
+                PushRename(flags, relative, from->second.mName);
+                MoveTracked(from->second.mName, relative);
+                if (directory)
+                {
+                    RenameWatches(from->second.mName, relative);
+                }
+                mMovedFrom.erase(from);
+            }
+            else
+            {
+                // moved in from outside the folder
+                Push(FileSystem::Change::Added, flags, relative);
+                Track(relative, flags);
+                if (directory)
+                {
+                    AddWatches(relative, true);
+                }
+            }
+        }
+    }
+
+    /// push the pending changes, renames without a destination moved out of the folder and are removals
+    void Flush()
+    {
+        for (auto &[cookie, movedFrom] : mMovedFrom)
+        {
+            Push(FileSystem::Change::Removed, movedFrom.mFlags, movedFrom.mName);
+            Untrack(movedFrom.mName);
+            if (movedFrom.mFlags.Has(FileSystem::Flag::Directory))
+            {
+                RemoveWatches(movedFrom.mName);
+            }
+        }
+        mMovedFrom.clear();
+
+        std::vector<FileSystem::FileChange> fileBatch;
+        mBatch.Take(fileBatch);
+        if (!fileBatch.empty())
+        {
+            FileSystem::PushFileChangeBatch(std::move(fileBatch));
+        }
+    }
+
+    /// add a change to the pending batch
+    void Push(FileSystem::Change change, FileSystem::Flags flags, const std::string &relative)
+    {
+        mBatch.Push(change, flags, mPrefix + relative);
+    }
+
+    /// add a rename to the pending batch
+    void PushRename(FileSystem::Flags flags, const std::string &relative, const std::string &oldRelative)
+    {
+        mBatch.PushRename(flags, mPrefix + relative, mPrefix + oldRelative);
+    }
+
+    /// watch a folder
+    bool Watch(const std::string &relative)
+    {
+        int watch = inotify_add_watch(mNotify, (mPath / relative).c_str(), Hidden::cWatchMask);
+        if (watch < 0)
+        {
+            DebugLog::Error("Could not watch folder {}, error {}", (mPath / relative).string(), errno);
+            return false;
+        }
+        mWatches[watch] = relative;
+        return true;
+    }
+
+    /// watch a folder tree and track its contents, optionally reporting them as added
+    void AddWatches(const std::string &relative, bool report)
+    {
+        if (!Watch(relative))
+        {
+            return;
+        }
+        const std::filesystem::path folder = mPath / relative;
+        std::error_code error;
+        for (auto it = std::filesystem::recursive_directory_iterator(folder, std::filesystem::directory_options::skip_permission_denied, error);
+             !error && it != std::filesystem::recursive_directory_iterator(); it.increment(error))
+        {
+            // an entry that cannot be checked is skipped, it does not end the walk
+            std::error_code entryError;
+            bool directory = it->is_directory(entryError) && !it->is_symlink(entryError);
+            if (!directory && !it->is_regular_file(entryError))
+            {
+                continue;
+            }
+            std::string entry = Hidden::JoinRelative(relative, it->path().lexically_relative(folder).generic_string());
+            FileSystem::Flags flags = directory ? FileSystem::Flag::Directory : FileSystem::Flag::File;
+            if (directory)
+            {
+                Watch(entry);
+            }
+            if (report)
+            {
+                Push(FileSystem::Change::Added, flags, entry);
+            }
+            Track(entry, flags);
+        }
+        if (error)
+        {
+            DebugLog::Error("Could not walk folder {}, {}", folder.string(), error.message());
+        }
+    }
+
+    /// track a file or folder known to be in the tree
+    void Track(const std::string &relative, FileSystem::Flags flags)
+    {
+        mKnown.insert_or_assign(relative, flags);
+    }
+
+    /// stop tracking a file, and the contents of a folder, they sort together between "name/" and "name0"
+    void Untrack(const std::string &relative)
+    {
+        mKnown.erase(relative);
+        mKnown.erase(mKnown.lower_bound(relative + "/"), mKnown.lower_bound(relative + static_cast<char>('/' + 1)));
+    }
+
+    /// move the tracked entries of a renamed file or folder tree
+    void MoveTracked(const std::string &oldRelative, const std::string &relative)
+    {
+        std::vector<std::pair<std::string, FileSystem::Flags>> moved;
+        if (auto it = mKnown.find(oldRelative); it != mKnown.end())
+        {
+            moved.emplace_back(relative, it->second);
+        }
+        for (auto it = mKnown.lower_bound(oldRelative + "/"), end = mKnown.lower_bound(oldRelative + static_cast<char>('/' + 1)); it != end; ++it)
+        {
+            moved.emplace_back(relative + it->first.substr(oldRelative.size()), it->second);
+        }
+        Untrack(oldRelative);
+        for (auto &[name, flags] : moved)
+        {
+            mKnown.insert_or_assign(std::move(name), flags);
+        }
+    }
+
+    /// update the paths of a renamed folder tree
+    void RenameWatches(const std::string &oldRelative, const std::string &relative)
+    {
+        for (auto &[watch, path] : mWatches)
+        {
+            if (Hidden::IsInsideRelative(path, oldRelative))
+            {
+                path = relative + path.substr(oldRelative.size());
+            }
+        }
+    }
+
+    /// stop watching a folder tree that left the folder
+    void RemoveWatches(const std::string &relative)
+    {
+        for (auto it = mWatches.begin(); it != mWatches.end();)
+        {
+            if (Hidden::IsInsideRelative(it->second, relative))
+            {
+                inotify_rm_watch(mNotify, it->first);
+                it = mWatches.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+    }
+
+    /// events were dropped, walk the tree again to watch new folders, report what appeared or went away since the tracked tree,
+    /// and report every file still there as modified so it is checked again
+    void Rescan()
+    {
+        mMovedFrom.clear();
+        Watch("");
+        std::unordered_set<std::string> seen;
+        std::error_code error;
+        for (auto it = std::filesystem::recursive_directory_iterator(mPath, std::filesystem::directory_options::skip_permission_denied, error);
+             !error && it != std::filesystem::recursive_directory_iterator(); it.increment(error))
+        {
+            // an entry that cannot be checked is skipped, it does not end the walk
+            std::error_code entryError;
+            bool directory = it->is_directory(entryError) && !it->is_symlink(entryError);
+            if (!directory && !it->is_regular_file(entryError))
+            {
+                continue;
+            }
+            std::string entry = it->path().lexically_relative(mPath).generic_string();
+            FileSystem::Flags flags = directory ? FileSystem::Flag::Directory : FileSystem::Flag::File;
+            if (directory)
+            {
+                Watch(entry);
+            }
+            auto known = mKnown.find(entry);
+            if (known != mKnown.end() && known->second != flags)
+            {
+                // replaced by a different kind of entry
+                Push(FileSystem::Change::Removed, known->second, entry);
+                Untrack(entry);
+                known = mKnown.end();
+            }
+            if (known == mKnown.end())
+            {
+                Push(FileSystem::Change::Added, flags, entry);
+                Track(entry, flags);
+            }
+            else if (!directory)
+            {
+                Push(FileSystem::Change::Modified, flags, entry);
+            }
+            seen.insert(std::move(entry));
+        }
+
+        // a partial walk cannot tell what was removed
+        if (error)
+        {
+            DebugLog::Error("Could not walk folder {}, {}", mPath.string(), error.message());
+            return;
+        }
+
+        // the contents of a removed folder are not reported, like a folder moved away
+        std::unordered_set<std::string_view> removedFolders;
+        std::vector<std::string> removed;
+        for (const auto &[name, flags] : mKnown)
+        {
+            if (seen.contains(name))
+            {
+                continue;
+            }
+            size_t separator = name.rfind('/');
+            if (separator == std::string::npos || !removedFolders.contains(std::string_view(name).substr(0, separator)))
+            {
+                Push(FileSystem::Change::Removed, flags, name);
+            }
+            if (flags.Has(FileSystem::Flag::Directory))
+            {
+                removedFolders.insert(name);
+            }
+            removed.push_back(name);
+        }
+        for (const std::string &name : removed)
+        {
+            mKnown.erase(name);
+        }
+    }
+
+    /// close the inotify and wake descriptors
+    void CloseDescriptors()
+    {
+        if (mNotify >= 0)
+        {
+            close(mNotify);
+            mNotify = -1;
+        }
+        if (mWake >= 0)
+        {
+            close(mWake);
+            mWake = -1;
+        }
+    }
+
+    /// moved from struct, the first half of a rename
+    struct MovedFrom
+    {
+        /// relative path
+        std::string mName;
+
+        /// flags
+        FileSystem::Flags mFlags;
+    };
+
+    /// watched folder
+    const std::filesystem::path mPath;
+
+    /// prefix of the change names
+    const std::string mPrefix;
+
+    /// inotify descriptor
+    int mNotify = -1;
+
+    /// event descriptor that wakes the watcher thread to stop
+    int mWake = -1;
+
+    /// watcher thread
+    std::thread mThread;
+
+    /// relative path of each watched folder
+    std::unordered_map<int, std::string> mWatches;
+
+    /// files and folders in the tree, by relative path, ordered so the contents of a folder are one range
+    std::map<std::string, FileSystem::Flags, std::less<>> mKnown;
+
+    /// renames waiting for their destination, by cookie
+    std::unordered_map<uint32_t, MovedFrom> mMovedFrom;
+
+    /// pending changes
+    FileChangeCoalescer mBatch;
+
+    /// when the oldest pending change arrived
+    std::chrono::steady_clock::time_point mPendingSince;
+};
+
+//==============================================================================================================================================================================
+
+/// constructs a folder watcher
+FolderWatcher::FolderWatcher(const std::filesystem::path &path) :
+    mImpl(FolderWatcher::Impl::MakeUniquePtr(FileSystem::NormalizeDirPath(path))) {}
+
+/// destroys the folder watcher, stopping it
+FolderWatcher::~FolderWatcher() = default;
+
+/// creates a smart pointer version of the folder watcher
+FolderWatcherPtr FolderWatcher::MakePtr(const std::filesystem::path &path)
+{
+    return FolderWatcherPtr(new FolderWatcher(path));
+}
+
+/// start watching, the folder tree is walked on the watcher thread
+bool FolderWatcher::Start()
+{
+    return mImpl->Start();
+}
+
+/// stop watching, changes not pushed yet are dropped
+void FolderWatcher::Stop()
+{
+    mImpl->Stop();
+}
+
+/// whether the watcher is running
+bool FolderWatcher::Running() const
+{
+    return mImpl->Running();
+}
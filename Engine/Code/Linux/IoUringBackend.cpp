@@ -0,0 +1,402 @@
+//==============================================================================================================================================================================
+/// \file
+/// \brief     IoUringBackend, io_uring async io backend
+/// \copyright Copyright (c) Gustavo Goedert. All rights reserved.
+//==============================================================================================================================================================================
+
+#include "lIoUringBackend.h"
+#include "lFileSystem.h"
+#include "lThreadPool.h"
+
+/// \cond
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+/// \endcond
+
+using namespace Lumen;
+using namespace Lumen::Linux;
+
+/// Lumen Hidden namespace
+namespace Lumen::Hidden
+{
+    /// user data of the entry that wakes the reaper thread to stop
+    constexpr __u64 cUringStopData = 0;
+
+    /// set up an io_uring, there is no libc wrapper
+    static int UringSetup(unsigned entries, io_uring_params &params)
+    {
+        return static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+    }
+
+    /// submit entries to an io_uring and optionally wait for completions
+    static int UringEnter(int ring, unsigned submit, unsigned wait, unsigned flags)
+    {
+        return static_cast<int>(syscall(__NR_io_uring_enter, ring, submit, wait, flags, nullptr, 0));
+    }
+
+    /// register resources with an io_uring or query it
+    static int UringRegister(int ring, unsigned opcode, void *arg, unsigned count)
+    {
+        return static_cast<int>(syscall(__NR_io_uring_register, ring, opcode, arg, count));
+    }
+}
+
+/// IoUringBackend::Impl class
+class IoUringBackend::Impl
+{
+    CLASS_NO_DEFAULT_CTOR(Impl);
+    CLASS_NO_COPY_MOVE(Impl);
+    CLASS_PTR_UNIQUEMAKER(Impl);
+    friend class IoUringBackend;
+
+public:
+    /// constructs a backend implementation, setting up the io_uring and starting the reaper thread
+    explicit Impl(unsigned depth)
+    {
+        if (Setup(depth))
+        {
+            mThread = std::thread(&Impl::Run, this);
+        }
+    }
+
+    /// destroys the backend implementation, every operation must be done
+    ~Impl()
+    {
+        if (mThread.joinable())
+        {
+            Queue(nullptr);
+            mThread.join();
+        }
+        Unmap();
+    }
+
+    /// whether the io_uring was set up
+    bool Ready() const
+    {
+        return mThread.joinable();
+    }
+
+    /// maximum number of operations in flight
+    size_t Depth() const
+    {
+        return mEntries;
+    }
+
+    /// start an operation
+    void Submit(AsyncIo::Operation &operation)
+    {
+        // files that are not native are read by their file system
+        std::filesystem::path nativePath = FileSystem::NativePath(operation.mPath);
+        if (nativePath.empty())
+        {
+            ThreadPool::Submit([&operation]()
+            {
+                operation.mSize = FileSystem::ReadAt(operation.mPath, operation.mOffset, operation.mBuffer);
+                AsyncIo::Complete(operation);
+            });
+            return;
+        }
+        int file = open(nativePath.c_str(), O_RDONLY | O_CLOEXEC);
+        if (file < 0 || operation.mBuffer.empty())
+        {
+            if (file >= 0)
+            {
+                close(file);
+            }
+            operation.mSize = file < 0 ? SIZE_MAX : 0;
+            AsyncIo::Complete(operation);
+            return;
+        }
+        Queue(new Read { &operation, file, 0 });
+    }
+
+private:
+    /// Read struct, an operation in the io_uring, read again from where it stopped until it is whole
+    struct Read
+    {
+        /// operation
+        AsyncIo::Operation *mOperation;
+
+        /// file descriptor
+        int mFile;
+
+        /// bytes read so far
+        size_t mSize;
+    };
+
+    /// set up the io_uring and map its rings, returns false if io_uring is not available or cannot read files
+    bool Setup(unsigned depth)
+    {
+        io_uring_params params = {};
+        mRing = Hidden::UringSetup(depth, params);
+        if (mRing < 0)
+        {
+            DebugLog::Warning("io_uring is not available, error {}", errno);
+            return false;
+        }
+
+        // both rings may share one mapping
+        mSqRingSize = params.sq_off.array + params.sq_entries * sizeof(__u32);
+        mCqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        bool singleMap = params.features & IORING_FEAT_SINGLE_MMAP;
+        if (singleMap)
+        {
+            mSqRingSize = mCqRingSize = std::max(mSqRingSize, mCqRingSize);
+        }
+        mSqRing = mmap(nullptr, mSqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, mRing, IORING_OFF_SQ_RING);
+        if (mSqRing == MAP_FAILED)
+        {
+            mSqRing = nullptr;
+            DebugLog::Warning("Unable to map the io_uring submission ring, error {}", errno);
+            return false;
+        }
+        if (singleMap)
+        {
+            mCqRing = mSqRing;
+        }
+        else
+        {
+            mCqRing = mmap(nullptr, mCqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, mRing, IORING_OFF_CQ_RING);
+            if (mCqRing == MAP_FAILED)
+            {
+                mCqRing = nullptr;
+                DebugLog::Warning("Unable to map the io_uring completion ring, error {}", errno);
+                return false;
+            }
+        }
+        mSqesSize = params.sq_entries * sizeof(io_uring_sqe);
+        void *sqes = mmap(nullptr, mSqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, mRing, IORING_OFF_SQES);
+        if (sqes == MAP_FAILED)
+        {
+            DebugLog::Warning("Unable to map the io_uring submission entries, error {}", errno);
+            return false;
+        }
+        mSqes = static_cast<io_uring_sqe *>(sqes);
+
+        byte *sqRing = static_cast<byte *>(mSqRing);
+        mSqHead = reinterpret_cast<__u32 *>(sqRing + params.sq_off.head);
+        mSqTail = reinterpret_cast<__u32 *>(sqRing + params.sq_off.tail);
+        mSqMask = *reinterpret_cast<__u32 *>(sqRing + params.sq_off.ring_mask);
+        mSqArray = reinterpret_cast<__u32 *>(sqRing + params.sq_off.array);
+        byte *cqRing = static_cast<byte *>(mCqRing);
+        mCqHead = reinterpret_cast<__u32 *>(cqRing + params.cq_off.head);
+        mCqTail = reinterpret_cast<__u32 *>(cqRing + params.cq_off.tail);
+        mCqMask = *reinterpret_cast<__u32 *>(cqRing + params.cq_off.ring_mask);
+        mCqes = reinterpret_cast<io_uring_cqe *>(cqRing + params.cq_off.cqes);
+        mEntries = params.sq_entries;
+
+        // reads need a newer kernel than the io_uring itself
+        std::vector<byte> probeData(sizeof(io_uring_probe) + 256 * sizeof(io_uring_probe_op));
+        io_uring_probe *probe = reinterpret_cast<io_uring_probe *>(probeData.data());
+        if (Hidden::UringRegister(mRing, IORING_REGISTER_PROBE, probe, 256) < 0 || probe->last_op < IORING_OP_READ ||
+            !(probe->ops[IORING_OP_READ].flags & IO_URING_OP_SUPPORTED))
+        {
+            DebugLog::Warning("io_uring cannot read files on this kernel");
+            return false;
+        }
+        return true;
+    }
+
+    /// unmap the rings and close the io_uring
+    void Unmap()
+    {
+        if (mSqes)
+        {
+            munmap(mSqes, mSqesSize);
+        }
+        if (mCqRing && mCqRing != mSqRing)
+        {
+            munmap(mCqRing, mCqRingSize);
+        }
+        if (mSqRing)
+        {
+            munmap(mSqRing, mSqRingSize);
+        }
+        if (mRing >= 0)
+        {
+            close(mRing);
+        }
+    }
+
+    /// queue the rest of a read, or the entry that stops the reaper thread if null, called from any thread
+    void Queue(Read *read)
+    {
+        std::lock_guard<std::mutex> lock(mSubmitMutex);
+
+        // operations in flight never exceed the depth, so there is always a free entry
+        __u32 tail = *mSqTail;
+        __u32 index = tail & mSqMask;
+        io_uring_sqe &entry = mSqes[index];
+        memset(&entry, 0, sizeof(entry));
+        if (read)
+        {
+            AsyncIo::Operation &operation = *read->mOperation;
+            entry.opcode = IORING_OP_READ;
+            entry.fd = read->mFile;
+            entry.addr = reinterpret_cast<__u64>(operation.mBuffer.data() + read->mSize);
+            entry.len = static_cast<__u32>(std::min<size_t>(operation.mBuffer.size() - read->mSize, INT_MAX));
+            entry.off = operation.mOffset + read->mSize;
+            entry.user_data = reinterpret_cast<__u64>(read);
+        }
+        else
+        {
+            entry.opcode = IORING_OP_NOP;
+            entry.user_data = Hidden::cUringStopData;
+        }
+        mSqArray[index] = index;
+        std::atomic_ref<__u32>(*mSqTail).store(tail + 1, std::memory_order_release);
+
+        // entries left by a submission that failed go with this one
+        __u32 pending = tail + 1 - std::atomic_ref<__u32>(*mSqHead).load(std::memory_order_acquire);
+        while (Hidden::UringEnter(mRing, pending, 0, 0) < 0 && errno == EINTR)
+        {
+        }
+    }
+
+    /// reaper thread, completes the operations as their reads finish
+    void Run()
+    {
+        for (;;)
+        {
+            if (Hidden::UringEnter(mRing, 0, 1, IORING_ENTER_GETEVENTS) < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY)
+            {
+                DebugLog::Error("Unable to wait for io_uring completions, error {}", errno);
+            }
+
+            // the entries are copied out before the head moves, the kernel reuses them after that
+            __u32 head = *mCqHead;
+            __u32 tail = std::atomic_ref<__u32>(*mCqTail).load(std::memory_order_acquire);
+            while (head != tail)
+            {
+                io_uring_cqe entry = mCqes[head & mCqMask];
+                std::atomic_ref<__u32>(*mCqHead).store(++head, std::memory_order_release);
+                if (entry.user_data == Hidden::cUringStopData)
+                {
+                    return;
+                }
+                Finish(reinterpret_cast<Read *>(entry.user_data), entry.res);
+            }
+        }
+    }
+
+    /// finish a read with the result of its entry, a short read is queued again for the rest
+    void Finish(Read *read, int result)
+    {
+        AsyncIo::Operation &operation = *read->mOperation;
+        if (result == -EINTR || result == -EAGAIN)
+        {
+            Queue(read);
+            return;
+        }
+        if (result > 0)
+        {
+            read->mSize += static_cast<size_t>(result);
+            if (read->mSize < operation.mBuffer.size())
+            {
+                Queue(read);
+                return;
+            }
+        }
+        operation.mSize = result < 0 ? SIZE_MAX : read->mSize;
+        close(read->mFile);
+        delete read;
+        AsyncIo::Complete(operation);
+    }
+
+    /// io_uring descriptor
+    int mRing = -1;
+
+    /// number of submission entries
+    size_t mEntries = 0;
+
+    /// submission ring mapping
+    void *mSqRing = nullptr;
+
+    /// submission ring mapping size
+    size_t mSqRingSize = 0;
+
+    /// completion ring mapping, the submission ring mapping if they share one
+    void *mCqRing = nullptr;
+
+    /// completion ring mapping size
+    size_t mCqRingSize = 0;
+
+    /// submission entries
+    io_uring_sqe *mSqes = nullptr;
+
+    /// submission entries mapping size
+    size_t mSqesSize = 0;
+
+    /// submission ring head, advanced by the kernel
+    __u32 *mSqHead = nullptr;
+
+    /// submission ring tail, advanced by the submitters
+    __u32 *mSqTail = nullptr;
+
+    /// submission ring mask
+    __u32 mSqMask = 0;
+
+    /// submission ring indices of the entries
+    __u32 *mSqArray = nullptr;
+
+    /// completion ring head, advanced by the reaper thread
+    __u32 *mCqHead = nullptr;
+
+    /// completion ring tail, advanced by the kernel
+    __u32 *mCqTail = nullptr;
+
+    /// completion ring mask
+    __u32 mCqMask = 0;
+
+    /// completion entries
+    io_uring_cqe *mCqes = nullptr;
+
+    /// mutex protecting the submission ring, operations are submitted from any thread
+    std::mutex mSubmitMutex;
+
+    /// reaper thread
+    std::thread mThread;
+};
+
+//==============================================================================================================================================================================
+
+/// constructs a backend, setting up an io_uring with a queue depth
+IoUringBackend::IoUringBackend(unsigned depth) : mImpl(IoUringBackend::Impl::MakeUniquePtr(depth)) {}
+
+/// destroys the backend, every operation must be done
+IoUringBackend::~IoUringBackend() = default;
+
+/// creates a smart pointer version of the backend with a queue depth, null if the io_uring cannot be set up so AsyncIo falls back to the thread pool
+IAsyncIoBackendPtr IoUringBackend::MakePtr(unsigned depth)
+{
+    std::shared_ptr<IoUringBackend> backend(new IoUringBackend(depth));
+    if (!backend->mImpl->Ready())
+    {
+        return nullptr;
+    }
+    return backend;
+}
+
+/// maximum number of operations in flight
+size_t IoUringBackend::Depth() const
+{
+    return mImpl->Depth();
+}
+
+/// start an operation
+void IoUringBackend::Submit(AsyncIo::Operation &operation)
+{
+    mImpl->Submit(operation);
+}
@@ -5,6 +5,7 @@
 //==============================================================================================================================================================================
 
 #include "lDefs.h"
+#include "lPathId.h"
 #include "lStringMap.h"
 #include "lMaterial.h"
 #include "lTexture.h"
@@ -31,7 +32,7 @@ public:
     static void Register(std::string_view name, std::string_view path)
     {
         // register asset
-        mAssetPaths.insert_or_assign(std::string(name), path);
+        mAssetPaths.insert_or_assign(std::string(name), PathId::Intern(path));
     }
 
     /// find material path from name
@@ -41,7 +42,7 @@ public:
         auto it = mAssetPaths.find(name);
         if (it != mAssetPaths.end())
         {
-            return it->second;
+            return it->second.String();
         }
 
         // none found
@@ -84,14 +85,16 @@ public:
         mShader.reset();
         mProperties.clear();
 
+        Serialized::Reader reader(in, packed);
+
         // load shader
         Serialized::Type shaderName = {};
-        Serialized::DeserializeValue(in, packed, Serialized::cShaderTypeToken, Serialized::cShaderTypeTokenPacked, shaderName);
+        reader.Read(Serialized::cShaderTypeToken, Serialized::cShaderTypeTokenPacked, shaderName);
         if (shaderName.empty())
         {
             throw std::runtime_error(std::format("Unable to load material resource, no shader name in material asset"));
         }
-        Expected<std::string_view> shaderPathExp = Shader::Find(shaderName);
+        Expected<std::string_view> shaderPathExp = Shader::Find(shaderName.get_ref<const std::string &>());
         if (!shaderPathExp.HasValue())
         {
             throw std::runtime_error(std::format("Unable to load {} shader resource, {}", shaderName.get<std::string_view>(), shaderPathExp.Error()));
@@ -104,11 +107,10 @@ public:
         mShader = static_pointer_cast<Shader>(shaderExp.Value());
 
         // load properties
-        Serialized::Type propertiesObj = Serialized::Type::object();
-        if (Serialized::DeserializeValue(in, packed, Serialized::cPropertiesToken, Serialized::cPropertiesTokenPacked, propertiesObj))
+        if (const Serialized::Type *propertiesObj = reader.Find(Serialized::cPropertiesToken, Serialized::cPropertiesTokenPacked))
         {
             Serialized::Type path = {};
-            for (auto &inProperty : propertiesObj.items())
+            for (auto &inProperty : propertiesObj->items())
             {
                 if (inProperty.key() == "diffuseTex")
                 {
@@ -196,11 +198,11 @@ private:
     /// map of properties
     StringMap<PropertyValue> mProperties;
 
-    /// static map of asset names to paths
-    static StringMap<std::string> mAssetPaths;
+    /// static map of asset names to interned paths
+    static StringMap<PathId> mAssetPaths;
 };
 
-StringMap<std::string> Material::Impl::mAssetPaths;
+StringMap<PathId> Material::Impl::mAssetPaths;
 
 //==============================================================================================================================================================================
 
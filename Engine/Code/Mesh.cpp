@@ -5,6 +5,7 @@
 //==============================================================================================================================================================================
 
 #include "lMesh.h"
+#include "lPathId.h"
 #include "lStringMap.h"
 #include "lEngine.h"
 
@@ -29,7 +30,7 @@ public:
     static void Register(std::string_view name, std::string_view path)
     {
         // register asset
-        mAssetPaths.insert_or_assign(std::string(name), path);
+        mAssetPaths.insert_or_assign(std::string(name), PathId::Intern(path));
     }
 
     /// find mesh path from name
@@ -39,7 +40,7 @@ public:
         auto it = mAssetPaths.find(name);
         if (it != mAssetPaths.end())
         {
-            return it->second;
+            return it->second.String();
         }
 
         // none found
@@ -82,11 +83,11 @@ public:
     /// engine mesh id
     Id::Type mMeshId;
 
-    /// static map of asset names to paths
-    static StringMap<std::string> mAssetPaths;
+    /// static map of asset names to interned paths
+    static StringMap<PathId> mAssetPaths;
 };
 
-StringMap<std::string> Mesh::Impl::mAssetPaths;
+StringMap<PathId> Mesh::Impl::mAssetPaths;
 
 //==============================================================================================================================================================================
 
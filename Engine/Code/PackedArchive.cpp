@@ -0,0 +1,189 @@
+//==============================================================================================================================================================================
+/// \file
+/// \brief     packed archive binary format
+/// \copyright Copyright (c) Gustavo Goedert. All rights reserved.
+//==============================================================================================================================================================================
+
+#include "lPackedArchive.h"
+#include "lCompression.h"
+
+/// \cond
+#include <algorithm>
+#include <bit>
+/// \endcond
+
+using namespace Lumen;
+
+// the header and entries are read in place, the layout is little-endian
+static_assert(std::endian::native == std::endian::little, "packed archives require a little-endian host");
+static_assert(sizeof(PackedArchive::Header) == 16);
+static_assert(sizeof(PackedArchive::Entry) == 48);
+
+/// Lumen Hidden namespace
+namespace Lumen::Hidden
+{
+    /// align a size to the packed archive alignment
+    static constexpr size_t ArchiveAlign(size_t size)
+    {
+        return (size + PackedArchive::cAlignment - 1) & ~(PackedArchive::cAlignment - 1);
+    }
+
+    /// entries are sorted by hash, then by path so equal hashes are still ordered
+    static bool ArchiveEntryLess(Hash64 hash, std::string_view path, Hash64 otherHash, std::string_view otherPath)
+    {
+        return hash != otherHash ? hash < otherHash : path < otherPath;
+    }
+}
+
+/// checks if a buffer starts with a packed archive header
+bool PackedArchive::IsPackedArchive(std::span<const byte> data)
+{
+    if (data.size() < sizeof(Header))
+    {
+        return false;
+    }
+    const Header *header = reinterpret_cast<const Header *>(data.data());
+    return header->mMagic == cMagic;
+}
+
+/// opens a view on a buffer, the buffer must outlive the view
+bool PackedArchive::View::Open(std::span<const byte> data)
+{
+    *this = View();
+
+    // validate header
+    if (!IsPackedArchive(data) || reinterpret_cast<uintptr_t>(data.data()) % alignof(Entry) != 0)
+    {
+        DebugLog::Error("Packed archive has an invalid header");
+        return false;
+    }
+    const Header *header = reinterpret_cast<const Header *>(data.data());
+    if (header->mVersion != cVersion)
+    {
+        DebugLog::Error("Packed archive version {} is not supported", header->mVersion);
+        return false;
+    }
+    size_t tablesSize = sizeof(Header) + size_t(header->mEntryCount) * sizeof(Entry);
+    if (header->mEntryCount > (data.size() - sizeof(Header)) / sizeof(Entry) || header->mStringsSize > data.size() - tablesSize)
+    {
+        DebugLog::Error("Packed archive has an invalid table of contents");
+        return false;
+    }
+
+    // validate the entries, so lookups can trust them
+    const Entry *entries = reinterpret_cast<const Entry *>(data.data() + sizeof(Header));
+    for (dword i = 0; i < header->mEntryCount; ++i)
+    {
+        const Entry &entry = entries[i];
+        if (entry.mName > header->mStringsSize || entry.mNameSize > header->mStringsSize - entry.mName ||
+            entry.mOffset > data.size() || entry.mStoredSize > data.size() - entry.mOffset ||
+            (!(entry.mFlags & cCompressedEntry) && entry.mStoredSize != entry.mSize) ||
+            (i > 0 && entries[i - 1].mHash > entry.mHash))
+        {
+            DebugLog::Error("Packed archive entry {} is invalid", i);
+            return false;
+        }
+    }
+
+    mHeader = header;
+    mEntries = entries;
+    mStrings = reinterpret_cast<const char *>(data.data() + tablesSize);
+    mData = data;
+    return true;
+}
+
+/// find the entry of a path, a binary search on the path hash
+const PackedArchive::Entry *PackedArchive::View::Find(std::string_view path) const
+{
+    Hash64 hash = HashString64(path);
+    const Entry *end = mEntries + EntryCount();
+    const Entry *it = std::lower_bound(mEntries, end, hash, [](const Entry &entry, Hash64 value) { return entry.mHash < value; });
+    for (; it != end && it->mHash == hash; ++it)
+    {
+        if (Name(*it) == path)
+        {
+            return it;
+        }
+    }
+    return nullptr;
+}
+
+/// add a file, compressed data is only kept if it gets smaller
+void PackedArchive::Writer::AddFile(std::string_view path, std::span<const byte> data, bool compress)
+{
+    File &file = mFiles.emplace_back(File { std::string(path), {}, data.size(), 0 });
+    if (compress && !data.empty())
+    {
+        file.mData = Compression::Compress(data);
+        if (file.mData.size() < data.size())
+        {
+            file.mFlags |= cCompressedEntry;
+            return;
+        }
+    }
+    file.mData.assign(data.begin(), data.end());
+}
+
+/// build the packed archive, returns an empty buffer if two paths are the same
+std::vector<byte> PackedArchive::Writer::Finish() const
+{
+    // sort the files by path hash
+    std::vector<Hash64> hashes(mFiles.size());
+    std::vector<size_t> order(mFiles.size());
+    for (size_t i = 0; i < mFiles.size(); ++i)
+    {
+        hashes[i] = HashString64(mFiles[i].mPath);
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [this, &hashes](size_t a, size_t b)
+    {
+        return Hidden::ArchiveEntryLess(hashes[a], mFiles[a].mPath, hashes[b], mFiles[b].mPath);
+    });
+    for (size_t i = 1; i < order.size(); ++i)
+    {
+        if (mFiles[order[i - 1]].mPath == mFiles[order[i]].mPath)
+        {
+            DebugLog::Error("Packed archive has the path {} twice", mFiles[order[i]].mPath);
+            return {};
+        }
+    }
+
+    // lay out the header, entries and strings, then the aligned data
+    size_t stringsSize = 0;
+    for (const File &file : mFiles)
+    {
+        stringsSize += file.mPath.size();
+    }
+    L_ASSERT_MSG(stringsSize <= UINT32_MAX, "Packed archive string table is limited to 4GB");
+    size_t tablesSize = sizeof(Header) + mFiles.size() * sizeof(Entry);
+    size_t size = Hidden::ArchiveAlign(tablesSize + stringsSize);
+    std::vector<Entry> entries(mFiles.size());
+    size_t stringOffset = 0;
+    for (size_t i = 0; i < order.size(); ++i)
+    {
+        const File &file = mFiles[order[i]];
+        entries[i] = { hashes[order[i]], size, file.mSize, file.mData.size(), static_cast<dword>(stringOffset), static_cast<dword>(file.mPath.size()), file.mFlags, 0 };
+        stringOffset += file.mPath.size();
+        size = Hidden::ArchiveAlign(size + file.mData.size());
+    }
+
+    // write
+    std::vector<byte> out(size, 0);
+    Header header = { cMagic, cVersion, 0, static_cast<dword>(mFiles.size()), static_cast<dword>(stringsSize) };
+    memcpy(out.data(), &header, sizeof(Header));
+    if (!entries.empty())
+    {
+        memcpy(out.data() + sizeof(Header), entries.data(), entries.size() * sizeof(Entry));
+    }
+    char *strings = reinterpret_cast<char *>(out.data() + tablesSize);
+    for (size_t i = 0; i < order.size(); ++i)
+    {
+        const File &file = mFiles[order[i]];
+        memcpy(strings + entries[i].mName, file.mPath.data(), file.mPath.size());
+        if (!file.mData.empty())
+        {
+            memcpy(out.data() + entries[i].mOffset, file.mData.data(), file.mData.size());
+        }
+    }
+    return out;
+}
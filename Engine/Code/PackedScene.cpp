@@ -0,0 +1,334 @@
+//==============================================================================================================================================================================
+/// \file
+/// \brief     packed scene binary format
+/// \copyright Copyright (c) Gustavo Goedert. All rights reserved.
+//==============================================================================================================================================================================
+
+#include "lPackedScene.h"
+
+/// \cond
+#include <algorithm>
+#include <bit>
+#include <map>
+/// \endcond
+
+using namespace Lumen;
+
+// records are read in place, the file layout is little-endian
+static_assert(std::endian::native == std::endian::little, "packed scenes require a little-endian host");
+static_assert(sizeof(PackedScene::Header) == 60);
+static_assert(sizeof(PackedScene::EntityRecord) == 16);
+static_assert(sizeof(PackedScene::TransformRecord) == 40);
+static_assert(sizeof(PackedScene::ComponentRecord) == 16);
+static_assert(sizeof(PackedScene::TypeRecord) == 12);
+static_assert(sizeof(PackedScene::JournalHeader) == 20);
+
+/// Lumen Hidden namespace
+namespace Lumen::Hidden
+{
+    /// align a size to the packed scene alignment
+    static constexpr size_t PackedAlign(size_t size)
+    {
+        return (size + PackedScene::cAlignment - 1) & ~(PackedScene::cAlignment - 1);
+    }
+
+    /// check if a table of count elements of size elementSize fits in the data at offset
+    static bool PackedTableFits(const PackedScene::Header &header, dword offset, size_t count, size_t elementSize)
+    {
+        if (offset % PackedScene::cAlignment != 0 || offset > header.mSize)
+        {
+            return false;
+        }
+        return count <= (header.mSize - offset) / elementSize;
+    }
+}
+
+/// checks if a buffer starts with a packed scene header
+bool PackedScene::IsPackedScene(std::span<const byte> data)
+{
+    if (data.size() < sizeof(Header))
+    {
+        return false;
+    }
+    const Header *header = reinterpret_cast<const Header *>(data.data());
+    return header->mMagic == cMagic;
+}
+
+/// opens a view on a buffer, the buffer must outlive the view
+bool PackedScene::View::Open(std::span<const byte> data)
+{
+    *this = View();
+
+    // validate header
+    if (!IsPackedScene(data) || reinterpret_cast<uintptr_t>(data.data()) % cAlignment != 0)
+    {
+        DebugLog::Error("Packed scene has an invalid header");
+        return false;
+    }
+    const Header *header = reinterpret_cast<const Header *>(data.data());
+    if (header->mVersion != cVersion)
+    {
+        DebugLog::Error("Packed scene version {} is not supported", header->mVersion);
+        return false;
+    }
+    if (header->mSize != data.size() ||
+        !Hidden::PackedTableFits(*header, header->mEntitiesOffset, header->mEntityCount, sizeof(EntityRecord)) ||
+        !Hidden::PackedTableFits(*header, header->mTransformsOffset, header->mEntityCount, sizeof(TransformRecord)) ||
+        !Hidden::PackedTableFits(*header, header->mComponentsOffset, header->mComponentCount, sizeof(ComponentRecord)) ||
+        !Hidden::PackedTableFits(*header, header->mTypesOffset, header->mTypeCount, sizeof(TypeRecord)) ||
+        !Hidden::PackedTableFits(*header, header->mTypeComponentsOffset, header->mComponentCount, sizeof(dword)) ||
+        !Hidden::PackedTableFits(*header, header->mStringsOffset, header->mStringsSize, 1) ||
+        !Hidden::PackedTableFits(*header, header->mBlobsOffset, header->mBlobsSize, 1))
+    {
+        DebugLog::Error("Packed scene tables are out of bounds");
+        return false;
+    }
+
+    // resolve tables
+    const byte *base = data.data();
+    const EntityRecord *entities = reinterpret_cast<const EntityRecord *>(base + header->mEntitiesOffset);
+    const ComponentRecord *components = reinterpret_cast<const ComponentRecord *>(base + header->mComponentsOffset);
+    const TypeRecord *types = reinterpret_cast<const TypeRecord *>(base + header->mTypesOffset);
+    const dword *typeComponents = reinterpret_cast<const dword *>(base + header->mTypeComponentsOffset);
+
+    // validate records, so accessors can index without checks
+    for (dword i = 0; i < header->mEntityCount; ++i)
+    {
+        const EntityRecord &entity = entities[i];
+        if (entity.mNameOffset > header->mStringsSize || entity.mNameSize > header->mStringsSize - entity.mNameOffset ||
+            entity.mFirstComponent > header->mComponentCount || entity.mComponentCount > header->mComponentCount - entity.mFirstComponent)
+        {
+            DebugLog::Error("Packed scene entity record {} is invalid", i);
+            return false;
+        }
+    }
+    for (dword i = 0; i < header->mComponentCount; ++i)
+    {
+        const ComponentRecord &component = components[i];
+        if (component.mEntity >= header->mEntityCount || component.mBlobOffset > header->mBlobsSize ||
+            component.mBlobSize > header->mBlobsSize - component.mBlobOffset || typeComponents[i] >= header->mComponentCount)
+        {
+            DebugLog::Error("Packed scene component record {} is invalid", i);
+            return false;
+        }
+    }
+    for (dword i = 0; i < header->mTypeCount; ++i)
+    {
+        const TypeRecord &type = types[i];
+        if ((i > 0 && types[i - 1].mType >= type.mType) ||
+            type.mFirst > header->mComponentCount || type.mCount > header->mComponentCount - type.mFirst)
+        {
+            DebugLog::Error("Packed scene type record {} is invalid", i);
+            return false;
+        }
+    }
+
+    mHeader = header;
+    mEntities = entities;
+    mTransforms = reinterpret_cast<const TransformRecord *>(base + header->mTransformsOffset);
+    mComponents = components;
+    mTypes = types;
+    mTypeComponents = typeComponents;
+    mStrings = reinterpret_cast<const char *>(base + header->mStringsOffset);
+    mBlobs = base + header->mBlobsOffset;
+    return true;
+}
+
+/// get entity name
+std::string_view PackedScene::View::Name(size_t index) const
+{
+    const EntityRecord &entity = mEntities[index];
+    return std::string_view(mStrings + entity.mNameOffset, entity.mNameSize);
+}
+
+/// get component blob
+std::span<const byte> PackedScene::View::Blob(const ComponentRecord &component) const
+{
+    return std::span<const byte>(mBlobs + component.mBlobOffset, component.mBlobSize);
+}
+
+/// find the indices of all component records of a type
+std::span<const dword> PackedScene::View::FindComponents(Hash type) const
+{
+    if (!mHeader)
+    {
+        return {};
+    }
+    const TypeRecord *end = mTypes + mHeader->mTypeCount;
+    const TypeRecord *it = std::lower_bound(mTypes, end, type, [](const TypeRecord &record, Hash value) { return record.mType < value; });
+    if (it == end || it->mType != type)
+    {
+        return {};
+    }
+    return std::span<const dword>(mTypeComponents + it->mFirst, it->mCount);
+}
+
+/// add an entity, following components belong to it
+void PackedScene::Writer::AddEntity(std::string_view name, const TransformRecord &transform)
+{
+    mEntities.push_back({
+        static_cast<dword>(mStrings.size()), static_cast<dword>(name.size()),
+        static_cast<dword>(mComponents.size()), 0 });
+    mTransforms.push_back(transform);
+    mStrings.append(name);
+}
+
+/// add a component to the last added entity
+void PackedScene::Writer::AddComponent(Hash type, std::span<const byte> blob)
+{
+    L_ASSERT_MSG(!mEntities.empty(), "Packed scene component added before any entity");
+    mEntities.back().mComponentCount++;
+    mComponents.push_back({ type, static_cast<dword>(mEntities.size() - 1), static_cast<dword>(mBlobs.size()), static_cast<dword>(blob.size()) });
+    mBlobs.insert(mBlobs.end(), blob.begin(), blob.end());
+    mBlobs.resize(Hidden::PackedAlign(mBlobs.size()), 0);
+}
+
+/// append the entities and components of another writer, so parts of a scene can be written in parallel
+void PackedScene::Writer::Append(const Writer &other)
+{
+    dword entityBase = static_cast<dword>(mEntities.size());
+    dword componentBase = static_cast<dword>(mComponents.size());
+    dword stringBase = static_cast<dword>(mStrings.size());
+    dword blobBase = static_cast<dword>(mBlobs.size());
+    for (EntityRecord entity : other.mEntities)
+    {
+        entity.mNameOffset += stringBase;
+        entity.mFirstComponent += componentBase;
+        mEntities.push_back(entity);
+    }
+    mTransforms.insert(mTransforms.end(), other.mTransforms.begin(), other.mTransforms.end());
+    for (ComponentRecord component : other.mComponents)
+    {
+        component.mEntity += entityBase;
+        component.mBlobOffset += blobBase;
+        mComponents.push_back(component);
+    }
+    mStrings.append(other.mStrings);
+
+    // blobs of both writers are padded to the alignment, so the appended ones stay aligned
+    mBlobs.insert(mBlobs.end(), other.mBlobs.begin(), other.mBlobs.end());
+}
+
+/// build the packed scene
+std::vector<byte> PackedScene::Writer::Finish() const
+{
+    // group component indices by type, keeping the scene order inside each type
+    std::map<Hash, std::vector<dword>> componentsByType;
+    for (dword i = 0; i < mComponents.size(); ++i)
+    {
+        componentsByType[mComponents[i].mType].push_back(i);
+    }
+    std::vector<TypeRecord> types;
+    std::vector<dword> typeComponents;
+    types.reserve(componentsByType.size());
+    typeComponents.reserve(mComponents.size());
+    for (const auto &[type, indices] : componentsByType)
+    {
+        types.push_back({ type, static_cast<dword>(typeComponents.size()), static_cast<dword>(indices.size()) });
+        typeComponents.insert(typeComponents.end(), indices.begin(), indices.end());
+    }
+
+    // lay out the tables
+    Header header = {};
+    header.mMagic = cMagic;
+    header.mVersion = cVersion;
+    header.mEntityCount = static_cast<dword>(mEntities.size());
+    header.mComponentCount = static_cast<dword>(mComponents.size());
+    header.mTypeCount = static_cast<dword>(types.size());
+    size_t offset = sizeof(Header);
+    auto place = [&offset](dword &tableOffset, size_t tableSize)
+    {
+        tableOffset = static_cast<dword>(offset);
+        offset = Hidden::PackedAlign(offset + tableSize);
+    };
+    place(header.mEntitiesOffset, mEntities.size() * sizeof(EntityRecord));
+    place(header.mTransformsOffset, mTransforms.size() * sizeof(TransformRecord));
+    place(header.mComponentsOffset, mComponents.size() * sizeof(ComponentRecord));
+    place(header.mTypesOffset, types.size() * sizeof(TypeRecord));
+    place(header.mTypeComponentsOffset, typeComponents.size() * sizeof(dword));
+    place(header.mStringsOffset, mStrings.size());
+    place(header.mBlobsOffset, mBlobs.size());
+    header.mStringsSize = static_cast<dword>(mStrings.size());
+    header.mBlobsSize = static_cast<dword>(mBlobs.size());
+    header.mSize = static_cast<dword>(offset);
+
+    // write the tables
+    std::vector<byte> data(offset, 0);
+    auto write = [&data](dword tableOffset, const void *table, size_t tableSize)
+    {
+        if (tableSize)
+        {
+            memcpy(data.data() + tableOffset, table, tableSize);
+        }
+    };
+    write(0, &header, sizeof(Header));
+    write(header.mEntitiesOffset, mEntities.data(), mEntities.size() * sizeof(EntityRecord));
+    write(header.mTransformsOffset, mTransforms.data(), mTransforms.size() * sizeof(TransformRecord));
+    write(header.mComponentsOffset, mComponents.data(), mComponents.size() * sizeof(ComponentRecord));
+    write(header.mTypesOffset, types.data(), types.size() * sizeof(TypeRecord));
+    write(header.mTypeComponentsOffset, typeComponents.data(), typeComponents.size() * sizeof(dword));
+    write(header.mStringsOffset, mStrings.data(), mStrings.size());
+    write(header.mBlobsOffset, mBlobs.data(), mBlobs.size());
+    return data;
+}
+
+/// build a journal entry replacing the base entities at the given indices, one per added entity
+std::vector<byte> PackedScene::Writer::FinishJournalEntry(std::span<const dword> entities, Hash64 base) const
+{
+    L_ASSERT(entities.size() == mEntities.size());
+    std::vector<byte> scene = Finish();
+    JournalHeader header = { cJournalMagic, static_cast<dword>(entities.size()), 0, static_cast<dword>(base), static_cast<dword>(base >> 32) };
+    size_t sceneOffset = sizeof(JournalHeader) + entities.size_bytes();
+    header.mSize = static_cast<dword>(sceneOffset + scene.size());
+    std::vector<byte> data(header.mSize);
+    memcpy(data.data(), &header, sizeof(JournalHeader));
+    if (!entities.empty())
+    {
+        memcpy(data.data() + sizeof(JournalHeader), entities.data(), entities.size_bytes());
+    }
+    memcpy(data.data() + sceneOffset, scene.data(), scene.size());
+    return data;
+}
+
+/// opens a journal of the scene with the base content hash on a buffer, the buffer must outlive the journal
+bool PackedScene::Journal::Open(std::span<const byte> data, Hash64 base)
+{
+    *this = Journal();
+    if (reinterpret_cast<uintptr_t>(data.data()) % cAlignment != 0)
+    {
+        DebugLog::Error("Packed scene journal is not aligned");
+        return false;
+    }
+
+    size_t offset = 0;
+    while (data.size() - offset >= sizeof(JournalHeader))
+    {
+        const JournalHeader *header = reinterpret_cast<const JournalHeader *>(data.data() + offset);
+        size_t sceneOffset = sizeof(JournalHeader) + size_t(header->mEntityCount) * sizeof(dword);
+        if (header->mMagic != cJournalMagic || header->mSize > data.size() - offset || header->mSize < sceneOffset || header->mSize % cAlignment != 0)
+        {
+            break;
+        }
+
+        // a full save replaces the scene before it empties the journal, an interrupted one leaves entries of the old scene behind
+        if (header->Base() != base)
+        {
+            DebugLog::Warning("Packed scene journal was written for another version of the scene, ignored");
+            break;
+        }
+        Entry entry;
+        entry.mEntities = std::span<const dword>(reinterpret_cast<const dword *>(header + 1), header->mEntityCount);
+        if (!entry.mScene.Open(data.subspan(offset + sceneOffset, header->mSize - sceneOffset)) || entry.mScene.EntityCount() != header->mEntityCount)
+        {
+            break;
+        }
+        mEntries.push_back(entry);
+        offset += header->mSize;
+    }
+    mSize = offset;
+    if (mSize != data.size())
+    {
+        DebugLog::Warning("Packed scene journal has {} unreadable bytes at the end", data.size() - mSize);
+    }
+    return true;
+}
@@ -0,0 +1,274 @@
+//==============================================================================================================================================================================
+/// \file
+/// \brief     path id
+/// \copyright Copyright (c) Gustavo Goedert. All rights reserved.
+//==============================================================================================================================================================================
+
+#include "lPathId.h"
+
+/// \cond
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+/// \endcond
+
+using namespace Lumen;
+
+/// Lumen Hidden namespace
+namespace Lumen::Hidden
+{
+    /// paths per chunk, chunks never move so paths are read without locking
+    constexpr size_t cPathChunkSize = 4096;
+
+    /// most chunks
+    constexpr size_t cPathChunkCount = 4096;
+
+    /// size of the blocks path strings are stored in
+    constexpr size_t cPathBlockSize = 64 * 1024;
+
+    /// interned path
+    struct PathEntry
+    {
+        /// normalized path
+        std::string_view mString;
+
+        /// parent path
+        PathId mParent;
+
+        /// offset of the file name
+        dword mFilename = 0;
+
+        /// offset of the extension, the size of the path if it has none
+        dword mExtension = 0;
+    };
+
+    /// path table struct
+    struct PathTable
+    {
+        CLASS_NO_COPY_MOVE(PathTable);
+
+        /// default constructor, the first path is the empty path
+        explicit PathTable()
+        {
+            mChunkStorage.push_back(std::make_unique<PathEntry[]>(cPathChunkSize));
+            mChunks[0].store(mChunkStorage.back().get(), std::memory_order_release);
+            mCount = 1;
+            mSpellings.emplace(std::string_view(), 0);
+        }
+
+        /// copy a string into the blocks, where it never moves
+        std::string_view Store(std::string_view string)
+        {
+            if (string.size() > mBlockSize - mBlockUsed)
+            {
+                mBlockSize = std::max(cPathBlockSize, string.size());
+                mBlocks.push_back(std::make_unique<char[]>(mBlockSize));
+                mBlockUsed = 0;
+            }
+            char *data = mBlocks.back().get() + mBlockUsed;
+            std::copy(string.begin(), string.end(), data);
+            mBlockUsed += string.size();
+            return std::string_view(data, string.size());
+        }
+
+        /// mutex protecting the spellings, the count and the storage
+        std::shared_mutex mMutex;
+
+        /// id of each spelling of a path, normalized or not
+        std::unordered_map<std::string_view, PathId::Type> mSpellings;
+
+        /// chunks of paths, published once allocated
+        std::array<std::atomic<PathEntry *>, cPathChunkCount> mChunks = {};
+
+        /// storage of the chunks
+        std::vector<std::unique_ptr<PathEntry[]>> mChunkStorage;
+
+        /// number of paths
+        size_t mCount = 0;
+
+        /// blocks of path strings
+        std::vector<std::unique_ptr<char[]>> mBlocks;
+
+        /// size of the last block
+        size_t mBlockSize = 0;
+
+        /// used size of the last block
+        size_t mBlockUsed = 0;
+    };
+
+    /// get the path table, made on first use so paths can be interned during static initialization
+    static PathTable &GetPathTable()
+    {
+        static PathTable table;
+        return table;
+    }
+
+    /// get the entry of a path id
+    static const PathEntry &GetPathEntry(PathId::Type value)
+    {
+        const PathEntry *chunk = GetPathTable().mChunks[value / cPathChunkSize].load(std::memory_order_acquire);
+        return chunk[value % cPathChunkSize];
+    }
+
+    /// check if a path is already normalized, so most paths are interned without normalizing
+    static bool IsNormalPath(std::string_view path)
+    {
+        if (path.find('\\') != std::string_view::npos || path.find("//") != std::string_view::npos)
+        {
+            return false;
+        }
+        size_t begin = 0;
+        while (begin <= path.size())
+        {
+            size_t end = std::min(path.find('/', begin), path.size());
+            std::string_view element = path.substr(begin, end - begin);
+            if (element == "." || element == "..")
+            {
+                return false;
+            }
+            begin = end + 1;
+        }
+        return true;
+    }
+
+    /// get the parent of a normalized path, the root has none
+    static std::string_view ParentPath(std::string_view path)
+    {
+        size_t slash = path.find_last_of('/');
+        if (slash == std::string_view::npos || path == "/")
+        {
+            return {};
+        }
+        return path.substr(0, slash ? slash : 1);
+    }
+}
+
+/// intern a path, spellings that normalize the same give the same id
+PathId PathId::Intern(std::string_view path)
+{
+    Hidden::PathTable &table = Hidden::GetPathTable();
+    {
+        std::shared_lock<std::shared_mutex> lock(table.mMutex);
+        if (auto it = table.mSpellings.find(path); it != table.mSpellings.end())
+        {
+            return PathId(it->second);
+        }
+    }
+
+    // normalized like FileSystem::NormalizeFilePath
+    std::string normalized;
+    std::string_view normalPath = path;
+    if (!Hidden::IsNormalPath(path))
+    {
+        normalized = std::filesystem::path(path).lexically_normal().generic_string();
+        normalPath = normalized;
+    }
+
+    // the parent is interned first, outside the lock
+    PathId parent;
+    if (std::string_view parentPath = Hidden::ParentPath(normalPath); !parentPath.empty())
+    {
+        parent = Intern(parentPath);
+    }
+
+    std::unique_lock<std::shared_mutex> lock(table.mMutex);
+    if (auto it = table.mSpellings.find(path); it != table.mSpellings.end())
+    {
+        return PathId(it->second);
+    }
+    Type value;
+    if (auto it = table.mSpellings.find(normalPath); it != table.mSpellings.end())
+    {
+        value = it->second;
+    }
+    else
+    {
+        value = static_cast<Type>(table.mCount);
+        L_ASSERT_MSG(value < Hidden::cPathChunkSize * Hidden::cPathChunkCount, "Too many paths");
+        if (value % Hidden::cPathChunkSize == 0)
+        {
+            table.mChunkStorage.push_back(std::make_unique<Hidden::PathEntry[]>(Hidden::cPathChunkSize));
+            table.mChunks[value / Hidden::cPathChunkSize].store(table.mChunkStorage.back().get(), std::memory_order_release);
+        }
+        Hidden::PathEntry &entry = table.mChunks[value / Hidden::cPathChunkSize].load(std::memory_order_relaxed)[value % Hidden::cPathChunkSize];
+        entry.mString = table.Store(normalPath);
+        entry.mParent = parent;
+        size_t slash = normalPath.find_last_of('/');
+        entry.mFilename = static_cast<dword>(slash == std::string_view::npos ? 0 : slash + 1);
+        std::string_view filename = normalPath.substr(entry.mFilename);
+        size_t dot = filename.find_last_of('.');
+        entry.mExtension = static_cast<dword>((dot == std::string_view::npos || dot == 0 || filename == "..") ? normalPath.size() : entry.mFilename + dot);
+        table.mSpellings.emplace(entry.mString, value);
+        ++table.mCount;
+    }
+
+    // other spellings are kept too, so they are not normalized again
+    if (normalPath.size() != path.size() || normalPath.data() != path.data())
+    {
+        table.mSpellings.emplace(table.Store(path), value);
+    }
+    return PathId(value);
+}
+
+/// intern a path, spellings that normalize the same give the same id
+PathId PathId::Intern(const std::filesystem::path &path)
+{
+    if constexpr (std::is_same_v<std::filesystem::path::value_type, char>)
+    {
+        return Intern(std::string_view(path.native()));
+    }
+    else
+    {
+        return Intern(std::string_view(path.generic_string()));
+    }
+}
+
+/// number of interned paths
+size_t PathId::Count()
+{
+    Hidden::PathTable &table = Hidden::GetPathTable();
+    std::shared_lock<std::shared_mutex> lock(table.mMutex);
+    return table.mCount;
+}
+
+/// get the normalized path, with forward slashes
+std::string_view PathId::String() const
+{
+    return Hidden::GetPathEntry(mValue).mString;
+}
+
+/// get the parent path, empty if it has none
+PathId PathId::Parent() const
+{
+    return Hidden::GetPathEntry(mValue).mParent;
+}
+
+/// get the file name, the last element of the path
+std::string_view PathId::Filename() const
+{
+    const Hidden::PathEntry &entry = Hidden::GetPathEntry(mValue);
+    return entry.mString.substr(entry.mFilename);
+}
+
+/// get the file name without its extension
+std::string_view PathId::Stem() const
+{
+    const Hidden::PathEntry &entry = Hidden::GetPathEntry(mValue);
+    return entry.mString.substr(entry.mFilename, entry.mExtension - entry.mFilename);
+}
+
+/// get the extension of the file name with its dot, empty if it has none
+std::string_view PathId::Extension() const
+{
+    const Hidden::PathEntry &entry = Hidden::GetPathEntry(mValue);
+    return entry.mString.substr(entry.mExtension);
+}
+
+/// make a filesystem path
+std::filesystem::path PathId::Path() const
+{
+    return std::filesystem::path(String());
+}
@@ -27,10 +27,15 @@ public:
     /// constructs a renderer
     explicit Impl(Renderer &owner, const EngineWeakPtr &engine) : mOwner(owner), mEngine(engine) {}
 
+    /// serialized fields
+    SERIALIZED_FIELDS(
+        SERIALIZED_FIELD(Impl, mMaterialPath, "Lumen::Material", PathId()));
+
     /// serialize
     void Serialize(Serialized::Type &out, bool packed) const
     {
-        Serialized::SerializeValue(out, packed, Serialized::cMaterialTypeToken, Serialized::cMaterialTypeTokenPacked, mMaterial->Path().string());
+        static_assert(std::get<0>(SerializedFields()).mNamePacked == Serialized::cMaterialTypeTokenPacked, "the material field keeps the key of the material token");
+        Serialized::SerializeFields(out, packed, *this, SerializedFields());
     }
 
     /// deserialize
@@ -39,13 +44,12 @@ public:
         mMaterial.reset();
 
         // load material
-        Serialized::Type path = {};
-        Serialized::DeserializeValue(in, packed, Serialized::cMaterialTypeToken, Serialized::cMaterialTypeTokenPacked, path);
-        if (path.empty())
+        Serialized::DeserializeFields(in, packed, *this, SerializedFields(), "Renderer");
+        if (!mMaterialPath.Valid())
         {
             throw std::runtime_error(std::format("Unable to load material resource, no path in material asset"));
         }
-        Expected<AssetPtr> materialExp = AssetManagerOld::Import(Material::Type(), path);
+        Expected<AssetPtr> materialExp = AssetManagerOld::Import(Material::Type(), mMaterialPath.Path());
         if (!materialExp.HasValue())
         {
             throw std::runtime_error(std::format("Unable to load material resource, {}", materialExp.Error()));
@@ -57,7 +61,12 @@ public:
     [[nodiscard]] MaterialPtr GetMaterial() const { return mMaterial; }
 
     /// set material
-    void SetMaterial(const MaterialPtr &material) { mMaterial = material; }
+    void SetMaterial(const MaterialPtr &material)
+    {
+        mMaterial = material;
+        mMaterialPath = material ? PathId::Intern(material->Path()) : PathId();
+        mOwner.SetDirty();
+    }
 
     /// render with a geometry
     void Render()
@@ -98,6 +107,9 @@ public:
 
     /// material
     MaterialPtr mMaterial;
+
+    /// material path, the serialized state of the material
+    PathId mMaterialPath;
 };
 
 //==============================================================================================================================================================================
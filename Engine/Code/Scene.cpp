@@ -5,10 +5,19 @@
 //==============================================================================================================================================================================
 
 #include "lScene.h"
+#include "lPathId.h"
 #include "lStringMap.h"
 #include "lAssetManager.h"
 #include "lEntity.h"
 #include "lSceneManager.h"
+#include "lPackedScene.h"
+#include "lThreadPool.h"
+#include "lCompression.h"
+#include "lContentHasher.h"
+
+/// \cond
+#include <unordered_set>
+/// \endcond
 
 using namespace Lumen;
 
@@ -30,7 +39,7 @@ public:
     static void Register(std::string_view name, std::string_view path)
     {
         // register asset
-        mAssetPaths.insert_or_assign(std::string(name), path);
+        mAssetPaths.insert_or_assign(std::string(name), PathId::Intern(path));
     }
 
     /// find scene path from name
@@ -40,7 +49,7 @@ public:
         auto it = mAssetPaths.find(name);
         if (it != mAssetPaths.end())
         {
-            return it->second;
+            return it->second.String();
         }
 
         // none found
@@ -70,27 +79,327 @@ public:
     /// deserialize
     void Deserialize(const Serialized::Type &in, bool packed)
     {
+        mPackedInSync = false;
+        mTextInSync = false;
         for (auto &entity : in.items())
         {
-            if (auto entityLock = mEntities.emplace_back(Lumen::Entity::MakePtr(mApplication, entity.key())).lock())
+            DeserializeEntity(entity.key(), entity.value(), packed);
+        }
+    }
+
+    /// deserialize one entity
+    void DeserializeEntity(std::string_view name, const Serialized::Type &in, bool packed)
+    {
+        if (auto entityLock = mEntities.emplace_back(Lumen::Entity::MakePtr(mApplication, name)).lock())
+        {
+            entityLock->Deserialize(in, packed);
+        }
+    }
+
+    /// serialize into a packed scene
+    void Serialize(PackedScene::Writer &out) const
+    {
+        // encoding the components dominates, so ranges of entities are written in parallel and appended in scene order
+        size_t chunkCount = std::min(mEntities.size(), (ThreadPool::ThreadCount() + 1) * 4);
+        if (ThreadPool::ThreadCount() == 0 || chunkCount < 2)
+        {
+            Serialize(out, 0, mEntities.size());
+            return;
+        }
+        std::vector<PackedScene::Writer> chunks(chunkCount);
+        ThreadPool::ParallelFor(chunkCount, [this, &chunks](size_t i)
+        {
+            Serialize(chunks[i], mEntities.size() * i / chunks.size(), mEntities.size() * (i + 1) / chunks.size());
+        });
+        for (const PackedScene::Writer &chunk : chunks)
+        {
+            out.Append(chunk);
+        }
+    }
+
+    /// serialize a range of entities into a packed scene
+    void Serialize(PackedScene::Writer &out, size_t begin, size_t end) const
+    {
+        for (size_t i = begin; i < end; ++i)
+        {
+            if (auto entityLock = mEntities[i].lock())
             {
-                entityLock->Deserialize(entity.value(), packed);
+                entityLock->Serialize(out);
             }
         }
     }
 
+    /// entity record of a packed scene
+    struct PackedEntity
+    {
+        /// packed scene holding the record
+        const PackedScene::View *mView;
+
+        /// record index
+        size_t mIndex;
+    };
+
+    /// deserialize from a packed scene, entities replaced by the journal are read from their latest entry
+    void Deserialize(const PackedScene::View &in, const PackedScene::Journal &journal)
+    {
+        std::vector<PackedEntity> entities(in.EntityCount());
+        for (size_t i = 0; i < entities.size(); ++i)
+        {
+            entities[i] = { &in, i };
+        }
+        for (const PackedScene::Journal::Entry &entry : journal.Entries())
+        {
+            for (size_t i = 0; i < entry.mEntities.size(); ++i)
+            {
+                if (entry.mEntities[i] >= entities.size())
+                {
+                    throw std::runtime_error(std::format("Unable to apply the scene journal, entity {} is out of range", entry.mEntities[i]));
+                }
+                entities[entry.mEntities[i]] = { &entry.mScene, i };
+            }
+        }
+        Deserialize(entities, mEntities);
+    }
+
+    /// deserialize packed scene entity records, appending the created entities to out
+    void Deserialize(std::span<const PackedEntity> entities, Entities &out)
+    {
+        // decode the component blobs in parallel, they do not touch the scene
+        std::vector<size_t> firstComponents(entities.size() + 1, 0);
+        for (size_t i = 0; i < entities.size(); ++i)
+        {
+            firstComponents[i + 1] = firstComponents[i] + entities[i].mView->Entity(entities[i].mIndex).mComponentCount;
+        }
+        std::vector<Serialized::Type> components(firstComponents.back());
+        ThreadPool::ParallelFor(entities.size(), [&entities, &firstComponents, &components](size_t i)
+        {
+            const PackedScene::View &view = *entities[i].mView;
+            const PackedScene::EntityRecord &entity = view.Entity(entities[i].mIndex);
+            for (dword j = 0; j < entity.mComponentCount; ++j)
+            {
+                std::span<const byte> blob = view.Blob(view.Component(entity.mFirstComponent + j));
+                components[firstComponents[i] + j] = Serialized::Type::from_cbor(blob.begin(), blob.end());
+            }
+        });
+
+        // create the entities serially in file order, so registration and asset imports stay deterministic
+        std::span<const Serialized::Type> decoded = components;
+        for (size_t i = 0; i < entities.size(); ++i)
+        {
+            const auto &[view, index] = entities[i];
+            if (auto entityLock = out.emplace_back(Lumen::Entity::MakePtr(mApplication, view->Name(index))).lock())
+            {
+                entityLock->Deserialize(*view, index, decoded.subspan(firstComponents[i], firstComponents[i + 1] - firstComponents[i]));
+            }
+        }
+    }
+
+    /// checks if the scene is stored in the packed scene format, on a packed file system or by its extension
+    [[nodiscard]] static bool StoredPacked(const std::filesystem::path &path)
+    {
+        return path.extension() == PackedScene::cExtension || FileSystem::IsPacked(path);
+    }
+
+    /// path of the journal of a packed scene
+    [[nodiscard]] std::filesystem::path JournalPath() const
+    {
+        std::filesystem::path path = mOwner.Path();
+        path += ".journal";
+        return path;
+    }
+
+    /// clear the save changed marks of every entity
+    void ClearDirty() const
+    {
+        for (auto &entity : mEntities)
+        {
+            if (auto entityLock = entity.lock())
+            {
+                entityLock->ClearDirty(DirtyMark::cSave);
+            }
+        }
+    }
+
+    /// collect the indices of entities changed since the last load or save, returns false if an entity is gone and the indices no longer match the saved scene
+    bool DirtyEntities(std::vector<dword> &dirty) const
+    {
+        for (size_t i = 0; i < mEntities.size(); ++i)
+        {
+            auto entityLock = mEntities[i].lock();
+            if (!entityLock)
+            {
+                return false;
+            }
+            if (entityLock->Dirty(DirtyMark::cSave))
+            {
+                dirty.push_back(static_cast<dword>(i));
+            }
+        }
+        return true;
+    }
+
+    /// save a packed scene, changed entities are appended to the journal until it grows past half the scene, then the scene is compacted
+    bool SavePacked(const std::filesystem::path &path) const
+    {
+        std::vector<dword> dirty;
+        if (mPackedInSync && mEntities.size() == mPackedEntityCount && DirtyEntities(dirty))
+        {
+            if (dirty.empty())
+            {
+                return true;
+            }
+            PackedScene::Writer writer;
+            for (dword index : dirty)
+            {
+                mEntities[index].lock()->Serialize(writer);
+            }
+            std::vector<byte> entry = writer.FinishJournalEntry(dirty, mPackedHash);
+            if (mJournalSize + entry.size() <= mPackedSize / 2)
+            {
+                if (!FileSystem::AppendBinaryData(JournalPath(), entry))
+                {
+                    // the journal may hold a torn entry now, the next save compacts
+                    mPackedInSync = false;
+                    return false;
+                }
+                mJournalSize += entry.size();
+                ClearDirty();
+                return true;
+            }
+        }
+
+        // full save, the journal is folded into the scene
+        PackedScene::Writer writer;
+        Serialize(writer);
+        std::vector<byte> data = writer.Finish();
+        mPackedInSync = false;
+        if (!FileSystem::WriteBinaryData(path, data))
+        {
+            return false;
+        }
+        std::filesystem::path journalPath = JournalPath();
+        if ((mJournalSize || FileSystem::Exists(journalPath)) && !FileSystem::WriteBinaryData(journalPath, {}))
+        {
+            return false;
+        }
+        mPackedInSync = true;
+        mPackedSize = data.size();
+        mPackedHash = ContentHasher::Hash(data);
+        mPackedEntityCount = writer.EntityCount();
+        mJournalSize = 0;
+        ClearDirty();
+        return true;
+    }
+
     /// save scene
     bool Save() const
     {
         const std::filesystem::path &path = mOwner.Path();
         Lumen::DebugLog::Info("Scene::Save {}", path.string());
 
+        // packed scenes are written in the packed scene binary format
+        if (StoredPacked(path))
+        {
+            return SavePacked(path);
+        }
+
+        // text scenes are rewritten whole, skipped if nothing changed since they were loaded or saved
+        std::vector<dword> dirty;
+        if (mTextInSync && DirtyEntities(dirty) && dirty.empty())
+        {
+            return true;
+        }
+
         // serialize the scene
         Serialized::Type data;
-        Serialize(data, FileSystem::IsPacked(path));
+        Serialize(data, false);
 
         // write the scene
-        return FileSystem::WriteSerializedData(path, data);
+        mTextInSync = FileSystem::WriteSerializedData(path, data);
+        if (mTextInSync)
+        {
+            ClearDirty();
+        }
+        return mTextInSync;
+    }
+
+    /// load a packed scene view of packedSize bytes and packedHash content hash, and the journal of entities saved since the last full save
+    bool LoadPacked(const PackedScene::View &view, size_t packedSize, Hash64 packedHash, std::span<const byte> journalData)
+    {
+        PackedScene::Journal journal;
+        if (!journal.Open(journalData, packedHash))
+        {
+            Lumen::DebugLog::Error("Unable to read the scene journal");
+            return false;
+        }
+        try
+        {
+            Deserialize(view, journal);
+        }
+        catch (const std::exception &e)
+        {
+            Lumen::DebugLog::Error("{}", e.what());
+            return false;
+        }
+
+        // a journal with a torn entry at the end, or left by an interrupted full save, is compacted by the next save
+        mPackedInSync = journal.Size() == journalData.size();
+        mPackedSize = packedSize;
+        mPackedHash = packedHash;
+        mPackedEntityCount = view.EntityCount();
+        mJournalSize = journal.Size();
+        return true;
+    }
+
+    /// load a packed scene from its data, older packed scenes are plain cbor
+    bool LoadPacked(std::span<const byte> data)
+    {
+        std::vector<byte> decompressed;
+        if (Compression::IsCompressed(data))
+        {
+            if (!Compression::Decompress(data, decompressed))
+            {
+                Lumen::DebugLog::Error("Unable to decompress the scene");
+                return false;
+            }
+            data = decompressed;
+        }
+        if (!PackedScene::IsPackedScene(data))
+        {
+            try
+            {
+                Deserialize(Serialized::Type::from_cbor(data.begin(), data.end()), true);
+            }
+            catch (const std::exception &e)
+            {
+                Lumen::DebugLog::Error("{}", e.what());
+                return false;
+            }
+            return true;
+        }
+        PackedScene::View view;
+        if (!view.Open(data))
+        {
+            Lumen::DebugLog::Error("Unable to open the packed scene");
+            return false;
+        }
+
+        // the journal is appended uncompressed, it stays mapped while the entities are read
+        Hash64 packedHash = ContentHasher::Hash(data);
+        std::filesystem::path journalPath = JournalPath();
+        if (!FileSystem::Exists(journalPath))
+        {
+            return LoadPacked(view, data.size(), packedHash, {});
+        }
+        Id::Type journalFile = FileSystem::Map(journalPath);
+        if (journalFile == Id::Invalid)
+        {
+            Lumen::DebugLog::Error("Unable to read the scene journal");
+            return false;
+        }
+        bool result = LoadPacked(view, data.size(), packedHash, FileSystem::MappedData(journalFile));
+        FileSystem::Close(journalFile);
+        return result;
     }
 
     /// load scene
@@ -99,31 +408,164 @@ public:
         const std::filesystem::path &path = mOwner.Path();
         Lumen::DebugLog::Info("Scene::Load {}", path.string());
 
-        // read the scene
-        Serialized::Type data;
-        if (!FileSystem::ReadSerializedData(path, data))
+        // packed scenes are read in place from the mapped file
+        if (StoredPacked(path))
+        {
+            Id::Type file = FileSystem::Map(path);
+            if (file == Id::Invalid)
+            {
+                Lumen::DebugLog::Error("Unable to read the scene");
+                return false;
+            }
+            bool result = LoadPacked(FileSystem::MappedData(file));
+            FileSystem::Close(file);
+            if (result)
+            {
+                ClearDirty();
+            }
+            return result;
+        }
+
+        // stream the scene, deserializing one entity at a time
+        std::string error;
+        bool result = FileSystem::ReadSerializedEntries(path, [this, &error](std::string_view name, Serialized::Type &entity)
+        {
+            try
+            {
+                DeserializeEntity(name, entity, false);
+            }
+            catch (const std::exception &e)
+            {
+                // stop reading, the rest of the file would be discarded
+                error = e.what();
+                return false;
+            }
+            return true;
+        });
+        if (!error.empty())
+        {
+            Lumen::DebugLog::Error("{}", error);
+            return false;
+        }
+        if (!result)
         {
             Lumen::DebugLog::Error("Unable to read the scene");
             return false;
         }
 
-        // deserialize the scene
+        mTextInSync = true;
+        ClearDirty();
+        return true;
+    }
+
+#ifdef EDITOR
+    /// capture a play mode snapshot
+    void CaptureSnapshot(Snapshot &out)
+    {
+        PackedScene::Writer writer;
+        Serialize(writer);
+        out.mData = writer.Finish();
+        out.mEntities.clear();
+        out.mEntities.reserve(writer.EntityCount());
+        for (auto &entity : mEntities)
+        {
+            if (auto entityLock = entity.lock())
+            {
+                out.mEntities.push_back(entity);
+                entityLock->ClearDirty(DirtyMark::cSnapshot);
+            }
+        }
+    }
+
+    /// restore a play mode snapshot, only entities changed since the capture are deserialized and only missing ones are created
+    bool RestoreSnapshot(const Snapshot &in)
+    {
+        PackedScene::View view;
+        if (!view.Open(in.mData) || view.EntityCount() != in.mEntities.size())
+        {
+            Lumen::DebugLog::Error("Unable to open the scene snapshot");
+            return false;
+        }
+
         try
         {
-            Deserialize(data, FileSystem::IsPacked(path));
+            // restore the captured entities that still exist in place, the save marks set while playing stay set
+            Entities entities(view.EntityCount());
+            std::unordered_set<const Lumen::Entity *> kept;
+            std::vector<PackedEntity> created;
+            for (size_t i = 0; i < view.EntityCount(); ++i)
+            {
+                auto entityLock = in.mEntities[i].lock();
+                if (entityLock && entityLock->Restore(view, i))
+                {
+                    entityLock->ClearDirty(DirtyMark::cSnapshot);
+                    entities[i] = entityLock;
+                    kept.insert(entityLock.get());
+                }
+                else
+                {
+                    created.push_back({ &view, i });
+                }
+            }
+
+            // create the missing entities into their own list, so a failure leaves the scene entities untouched
+            Entities createdEntities;
+            try
+            {
+                Deserialize(created, createdEntities);
+            }
+            catch (...)
+            {
+                for (auto &entity : createdEntities)
+                {
+                    SceneManager::UnregisterEntity(entity);
+                }
+                throw;
+            }
+
+            // destroy the entities that are not kept
+            bool changed = !created.empty();
+            for (auto &entity : mEntities)
+            {
+                auto entityLock = entity.lock();
+                if (entityLock && !kept.contains(entityLock.get()))
+                {
+                    SceneManager::UnregisterEntity(entity);
+                    changed = true;
+                }
+            }
+            if (changed)
+            {
+                mPackedInSync = false;
+                mTextInSync = false;
+            }
+
+            // place the created entities in their captured place, they differ from what is on disk
+            for (size_t i = 0; i < created.size(); ++i)
+            {
+                if (auto entityLock = createdEntities[i].lock())
+                {
+                    entityLock->SetDirty();
+                    entityLock->ClearDirty(DirtyMark::cSnapshot);
+                }
+                entities[created[i].mIndex] = createdEntities[i];
+            }
+            mEntities.swap(entities);
         }
         catch (const std::exception &e)
         {
             Lumen::DebugLog::Error("{}", e.what());
             return false;
         }
-
         return true;
     }
+#endif
 
     /// release scene
     void Release()
     {
+        mPackedInSync = false;
+        mTextInSync = false;
         if (!mEntities.empty())
         {
             Lumen::DebugLog::Info("Scene::Release");
@@ -144,11 +586,29 @@ public:
     /// entities in the scene
     Entities mEntities;
 
-    /// static map of asset names to paths
-    static StringMap<std::string> mAssetPaths;
+    /// the packed scene and its journal on disk match the entities, apart from their changed marks
+    mutable bool mPackedInSync = false;
+
+    /// size of the packed scene on disk
+    mutable size_t mPackedSize = 0;
+
+    /// content hash of the packed scene on disk, journal entries are tied to it
+    mutable Hash64 mPackedHash = 0;
+
+    /// number of entities in the packed scene on disk
+    mutable size_t mPackedEntityCount = 0;
+
+    /// size of the journal on disk
+    mutable size_t mJournalSize = 0;
+
+    /// the text scene on disk matches the entities, apart from their changed marks
+    mutable bool mTextInSync = false;
+
+    /// static map of asset names to interned paths
+    static StringMap<PathId> mAssetPaths;
 };
 
-StringMap<std::string> Scene::Impl::mAssetPaths;
+StringMap<PathId> Scene::Impl::mAssetPaths;
 
 //==============================================================================================================================================================================
 
@@ -209,3 +669,30 @@ void Scene::Release()
 {
     mImpl->Release();
 }
+
+/// number of entities in the scene
+size_t Scene::EntityCount() const
+{
+    return mImpl->mEntities.size();
+}
+
+/// get entity by index, in scene order
+EntityWeakPtr Scene::GetEntity(size_t index) const
+{
+    L_ASSERT(index < mImpl->mEntities.size());
+    return mImpl->mEntities[index];
+}
+
+#ifdef EDITOR
+/// capture a play mode snapshot
+void Scene::CaptureSnapshot(Snapshot &out)
+{
+    mImpl->CaptureSnapshot(out);
+}
+
+/// restore a play mode snapshot, only entities changed since the capture are deserialized and only missing ones are created
+bool Scene::RestoreSnapshot(const Snapshot &in)
+{
+    return mImpl->RestoreSnapshot(in);
+}
+#endif
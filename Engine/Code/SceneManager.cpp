@@ -34,8 +34,8 @@ namespace Lumen::Hidden
         std::unordered_map<HashType, std::vector<ComponentPtr>, HashTypeHasher, HashTypeEqual> mComponentsMap;
 
 #ifdef EDITOR
-        /// scene state
-        Serialized::Type mSceneState;
+        /// play mode snapshot
+        Scene::Snapshot mSnapshot;
 #endif
     };
 
@@ -199,18 +199,16 @@ void SceneManager::Run()
 /// capture current scene state
 void SceneManager::CaptureSnapshot()
 {
-    Hidden::gSceneManagerState->mSceneState.clear();
-    Hidden::gSceneManagerState->mCurrentScene->Serialize(Hidden::gSceneManagerState->mSceneState, true);
+    Hidden::gSceneManagerState->mCurrentScene->CaptureSnapshot(Hidden::gSceneManagerState->mSnapshot);
 }
 
 /// restore scene state from the last captured snapshot
 void SceneManager::RestoreSnapshot()
 {
-    if (!Hidden::gSceneManagerState->mSceneState.empty())
+    if (!Hidden::gSceneManagerState->mSnapshot.mData.empty())
     {
-        Hidden::gSceneManagerState->mCurrentScene->Release();
-        Hidden::gSceneManagerState->mCurrentScene->Deserialize(Hidden::gSceneManagerState->mSceneState, true);
-        Hidden::gSceneManagerState->mSceneState.clear();
+        Hidden::gSceneManagerState->mCurrentScene->RestoreSnapshot(Hidden::gSceneManagerState->mSnapshot);
+        Hidden::gSceneManagerState->mSnapshot = {};
     }
 }
 #endif
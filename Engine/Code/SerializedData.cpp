@@ -6,39 +6,192 @@
 
 #include "lSerializedData.h"
 
+/// \cond
+#include <bit>
+/// \endcond
+
 using namespace Lumen;
 
 const std::string Serialized::cUUIDToken = std::string("UUID");
-const Hash        Serialized::cUUIDTokenPacked = HashString(Serialized::cUUIDToken.c_str());
 
 const std::string Serialized::cTypeToken = std::string("Type");
-const Hash        Serialized::cTypeTokenPacked = HashString(Serialized::cTypeToken.c_str());
 
 const std::string Serialized::cTransformToken = std::string("Transform");
-const Hash        Serialized::cTransformTokenPacked = HashString(Serialized::cTransformToken.c_str());
 
 const std::string Serialized::cComponentsToken = std::string("Components");
-const Hash        Serialized::cComponentsTokenPacked = HashString(Serialized::cComponentsToken.c_str());
-
-const std::string Serialized::cPositionToken = std::string("Position");
-const Hash        Serialized::cPositionTokenPacked = HashString(Serialized::cPositionToken.c_str());
-const std::string Serialized::cRotationToken = std::string("Rotation");
-const Hash        Serialized::cRotationTokenPacked = HashString(Serialized::cRotationToken.c_str());
-const std::string Serialized::cScaleToken = std::string("Scale");
-const Hash        Serialized::cScaleTokenPacked = HashString(Serialized::cScaleToken.c_str());
-
-const std::string Serialized::cBackgroundColorToken = std::string("BackgroundColor");
-const Hash        Serialized::cBackgroundColorTokenPacked = HashString(Serialized::cBackgroundColorToken.c_str());
 
 const std::string Serialized::cMeshTypeToken = std::string("Lumen::Mesh");
-const Hash        Serialized::cMeshTypeTokenPacked = HashString(Serialized::cMeshTypeToken.c_str());
 
 const std::string Serialized::cMaterialTypeToken = std::string("Lumen::Material");
-const Hash        Serialized::cMaterialTypeTokenPacked = HashString(Serialized::cMaterialTypeToken.c_str());
 const std::string Serialized::cPropertiesToken = std::string("Properties");
-const Hash        Serialized::cPropertiesTokenPacked = HashString(Serialized::cPropertiesToken.c_str());
 const std::string Serialized::cTextureTypeToken = std::string("Lumen::Texture");
-const Hash        Serialized::cTextureTypeTokenPacked = HashString(Serialized::cTextureTypeToken.c_str());
 
 const std::string Serialized::cShaderTypeToken = std::string("Lumen::Shader");
-const Hash        Serialized::cShaderTypeTokenPacked = HashString(Serialized::cShaderTypeToken.c_str());
+
+const std::string Serialized::cContentHashToken = std::string("ContentHash");
+
+/// constructs a reader, packed data is indexed by key hash
+Serialized::Reader::Reader(const Type &in, bool packed) : mIn(in), mPacked(packed)
+{
+    if (!mPacked || !mIn.is_array())
+    {
+        return;
+    }
+
+    // collect the key / value pairs
+    size_t count = mIn.size() / 2;
+    Field *fields = mInlineFields.data();
+    if (count > cInlineFields)
+    {
+        mOverflowFields.resize(count);
+        fields = mOverflowFields.data();
+    }
+    size_t size = 0;
+    for (size_t i = 1; i < mIn.size(); i += 2)
+    {
+        const auto &obj = mIn[i - 1];
+        if (obj.is_number_unsigned())
+        {
+            fields[size++] = { obj.get<Hash>(), &mIn[i] };
+        }
+    }
+    mFields = std::span<Field>(fields, size);
+
+    // sort by key, values keep their stored order on duplicate keys so the first one wins
+    std::sort(mFields.begin(), mFields.end(), [](const Field &a, const Field &b)
+        { return a.mKey < b.mKey || (a.mKey == b.mKey && a.mValue < b.mValue); });
+}
+
+/// find a value, returns null if not found
+const Serialized::Type *Serialized::Reader::Find(const std::string &key, Hash keyPacked) const
+{
+    if (mPacked)
+    {
+        auto it = std::lower_bound(mFields.begin(), mFields.end(), keyPacked, [](const Field &field, Hash value) { return field.mKey < value; });
+        if (it != mFields.end() && it->mKey == keyPacked)
+        {
+            return it->mValue;
+        }
+    }
+    else if (mIn.is_object())
+    {
+        auto it = mIn.find(key);
+        if (it != mIn.end())
+        {
+            return &it.value();
+        }
+    }
+    return nullptr;
+}
+
+/// read a value
+bool Serialized::Reader::Read(const std::string &key, Hash keyPacked, Type &value) const
+{
+    if (const Type *found = Find(key, keyPacked))
+    {
+        value = *found;
+        return true;
+    }
+    return false;
+}
+
+/// read an UUID
+bool Serialized::Reader::ReadUUID(const std::string &key, Hash keyPacked, UUID &uuid) const
+{
+    const Type *found = Find(key, keyPacked);
+    if (!found)
+    {
+        return false;
+    }
+    if (mPacked)
+    {
+        if (found->is_binary())
+        {
+            const auto &binary = found->get_binary();
+            if (binary.size() == sizeof(UUID))
+            {
+                memcpy(&uuid, binary.data(), sizeof(UUID));
+                return true;
+            }
+        }
+    }
+    else if (found->is_string())
+    {
+        uuid = UUIDFromString(found->get_ref<const std::string &>());
+        return true;
+    }
+    return false;
+}
+
+/// serialize floats, packed data is stored as a raw little-endian float block
+void Serialized::SerializeFloats(Type &out, bool packed, const std::string &key, const Hash &keyPacked, std::span<const float> values)
+{
+    if (packed)
+    {
+        std::vector<byte> block(values.size() * sizeof(float));
+        for (size_t i = 0; i < values.size(); ++i)
+        {
+            dword bits = std::bit_cast<dword>(values[i]);
+            if constexpr (std::endian::native == std::endian::big)
+            {
+                bits = (bits >> 24) | ((bits >> 8) & 0x0000FF00) | ((bits << 8) & 0x00FF0000) | (bits << 24);
+            }
+            memcpy(block.data() + i * sizeof(float), &bits, sizeof(float));
+        }
+        out.push_back(keyPacked);
+        out.push_back(Type::binary(std::move(block)));
+    }
+    else
+    {
+        Type array = Type::array();
+        for (float value : values)
+        {
+            array.push_back(value);
+        }
+        out[key] = std::move(array);
+    }
+}
+
+/// deserialize floats into a destination without allocating, accepts float blocks and number arrays
+bool Serialized::DeserializeFloats(const Type &value, std::span<float> values)
+{
+    if (value.is_binary())
+    {
+        const auto &block = value.get_binary();
+        if (block.size() != values.size() * sizeof(float))
+        {
+            return false;
+        }
+        if constexpr (std::endian::native == std::endian::little)
+        {
+            memcpy(values.data(), block.data(), block.size());
+        }
+        else
+        {
+            for (size_t i = 0; i < values.size(); ++i)
+            {
+                dword bits;
+                memcpy(&bits, block.data() + i * sizeof(float), sizeof(float));
+                bits = (bits >> 24) | ((bits >> 8) & 0x0000FF00) | ((bits << 8) & 0x00FF0000) | (bits << 24);
+                values[i] = std::bit_cast<float>(bits);
+            }
+        }
+        return true;
+    }
+
+    if (value.is_array() && value.size() == values.size())
+    {
+        for (size_t i = 0; i < values.size(); ++i)
+        {
+            const Type &element = value[i];
+            if (!element.is_number())
+            {
+                return false;
+            }
+            values[i] = element.get<float>();
+        }
+        return true;
+    }
+
+    return false;
+}
@@ -5,6 +5,7 @@
 //==============================================================================================================================================================================
 
 #include "lTexture.h"
+#include "lPathId.h"
 #include "lStringMap.h"
 #include "lEngine.h"
 
@@ -28,7 +29,7 @@ public:
     static void Register(std::string_view name, std::string_view path)
     {
         // register asset
-        mAssetPaths.insert_or_assign(std::string(name), path);
+        mAssetPaths.insert_or_assign(std::string(name), PathId::Intern(path));
     }
 
     /// find texture path from name
@@ -38,7 +39,7 @@ public:
         auto it = mAssetPaths.find(name);
         if (it != mAssetPaths.end())
         {
-            return it->second;
+            return it->second.String();
         }
 
         // none found
@@ -97,11 +98,11 @@ public:
     /// engine texture id
     Id::Type mTextureId;
 
-    /// static map of asset names to paths
-    static StringMap<std::string> mAssetPaths;
+    /// static map of asset names to interned paths
+    static StringMap<PathId> mAssetPaths;
 };
 
-StringMap<std::string> Texture::Impl::mAssetPaths;
+StringMap<PathId> Texture::Impl::mAssetPaths;
 
 //==============================================================================================================================================================================
 
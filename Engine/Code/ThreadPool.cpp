@@ -0,0 +1,225 @@
+//==============================================================================================================================================================================
+/// \file
+/// \brief     thread pool
+/// \copyright Copyright (c) Gustavo Goedert. All rights reserved.
+//==============================================================================================================================================================================
+
+#include "lThreadPool.h"
+
+/// \cond
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+/// \endcond
+
+using namespace Lumen;
+
+/// Lumen Hidden namespace
+namespace Lumen::Hidden
+{
+    /// thread pool state struct
+    struct ThreadPoolState
+    {
+        CLASS_NO_COPY_MOVE(ThreadPoolState);
+
+        /// default constructor
+        explicit ThreadPoolState() = default;
+
+        /// worker threads
+        std::vector<std::thread> mThreads;
+
+        /// mutex protecting the task queue
+        std::mutex mMutex;
+
+        /// signaled when a task is queued or on stop
+        std::condition_variable mCondition;
+
+        /// task queue
+        std::deque<ThreadPool::Task> mTasks;
+
+        /// stop flag
+        bool mStop = false;
+    };
+
+    /// global thread pool state
+    static std::unique_ptr<ThreadPoolState> gThreadPoolState;
+
+    /// parallel for job, shared between the calling thread and the helper tasks
+    struct ParallelForJob
+    {
+        CLASS_NO_COPY_MOVE(ParallelForJob);
+
+        /// constructs a job
+        explicit ParallelForJob(size_t count, size_t grain, const ThreadPool::ForBody &body) : mCount(count), mGrain(grain), mBody(body) {}
+
+        /// claim and run chunks until none are left
+        void Work()
+        {
+            for (;;)
+            {
+                size_t begin = mNext.fetch_add(mGrain);
+                if (begin >= mCount)
+                {
+                    return;
+                }
+                size_t end = std::min(begin + mGrain, mCount);
+                try
+                {
+                    for (size_t i = begin; i < end; ++i)
+                    {
+                        mBody(i);
+                    }
+                }
+                catch (...)
+                {
+                    std::lock_guard<std::mutex> lock(mMutex);
+                    if (!mException)
+                    {
+                        mException = std::current_exception();
+                    }
+                }
+                if (mDone.fetch_add(end - begin) + (end - begin) == mCount)
+                {
+                    std::lock_guard<std::mutex> lock(mMutex);
+                    mCondition.notify_all();
+                }
+            }
+        }
+
+        /// wait until all items are done
+        void Wait()
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mCondition.wait(lock, [this]() { return mDone.load() == mCount; });
+        }
+
+        /// number of items
+        const size_t mCount;
+
+        /// items claimed at a time
+        const size_t mGrain;
+
+        /// body, owned by the caller which outlives the job's work
+        const ThreadPool::ForBody &mBody;
+
+        /// next item to claim
+        std::atomic<size_t> mNext = 0;
+
+        /// items done
+        std::atomic<size_t> mDone = 0;
+
+        /// mutex protecting the exception and the wait
+        std::mutex mMutex;
+
+        /// signaled when all items are done
+        std::condition_variable mCondition;
+
+        /// first exception thrown by body
+        std::exception_ptr mException;
+    };
+
+    /// worker thread loop
+    static void ThreadPoolWorker(ThreadPoolState &state)
+    {
+        for (;;)
+        {
+            ThreadPool::Task task;
+            {
+                std::unique_lock<std::mutex> lock(state.mMutex);
+                state.mCondition.wait(lock, [&state]() { return state.mStop || !state.mTasks.empty(); });
+                if (state.mTasks.empty())
+                {
+                    return;
+                }
+                task = std::move(state.mTasks.front());
+                state.mTasks.pop_front();
+            }
+            task();
+        }
+    }
+}
+
+/// initialize thread pool namespace, zero threads uses the hardware concurrency minus the calling thread
+void ThreadPool::Initialize(size_t threadCount)
+{
+    L_ASSERT(!Hidden::gThreadPoolState);
+    if (threadCount == 0)
+    {
+        threadCount = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+    }
+    Hidden::gThreadPoolState = std::make_unique<Hidden::ThreadPoolState>();
+    Hidden::gThreadPoolState->mThreads.reserve(threadCount);
+    for (size_t i = 0; i < threadCount; ++i)
+    {
+        Hidden::gThreadPoolState->mThreads.emplace_back(Hidden::ThreadPoolWorker, std::ref(*Hidden::gThreadPoolState));
+    }
+}
+
+/// shutdown thread pool namespace, pending tasks are finished first
+void ThreadPool::Shutdown()
+{
+    L_ASSERT(Hidden::gThreadPoolState);
+    {
+        std::lock_guard<std::mutex> lock(Hidden::gThreadPoolState->mMutex);
+        Hidden::gThreadPoolState->mStop = true;
+    }
+    Hidden::gThreadPoolState->mCondition.notify_all();
+    for (std::thread &thread : Hidden::gThreadPoolState->mThreads)
+    {
+        thread.join();
+    }
+    Hidden::gThreadPoolState.reset();
+}
+
+/// get the number of worker threads, zero if not initialized
+size_t ThreadPool::ThreadCount()
+{
+    return Hidden::gThreadPoolState ? Hidden::gThreadPoolState->mThreads.size() : 0;
+}
+
+/// submit a task to run on a worker thread, runs immediately if not initialized
+void ThreadPool::Submit(Task &&task)
+{
+    if (!Hidden::gThreadPoolState)
+    {
+        task();
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(Hidden::gThreadPoolState->mMutex);
+        L_ASSERT(!Hidden::gThreadPoolState->mStop);
+        Hidden::gThreadPoolState->mTasks.push_back(std::move(task));
+    }
+    Hidden::gThreadPoolState->mCondition.notify_one();
+}
+
+/// run body for every index in [0, count), the calling thread takes part and it returns when all are done
+void ThreadPool::ParallelFor(size_t count, const ForBody &body)
+{
+    size_t threadCount = ThreadCount();
+    if (threadCount == 0 || count < 2)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            body(i);
+        }
+        return;
+    }
+
+    // several chunks per thread to balance uneven items
+    size_t helpers = std::min(threadCount, count - 1);
+    size_t grain = std::max<size_t>(1, count / ((helpers + 1) * 4));
+    auto job = std::make_shared<Hidden::ParallelForJob>(count, grain, body);
+    for (size_t i = 0; i < helpers; ++i)
+    {
+        Submit([job]() { job->Work(); });
+    }
+    job->Work();
+    job->Wait();
+    if (job->mException)
+    {
+        std::rethrow_exception(job->mException);
+    }
+}
@@ -22,68 +22,36 @@ public:
     /// destroys transform
     ~Impl() = default;
 
+    /// serialized fields
+    SERIALIZED_FIELDS(
+        SERIALIZED_FIELD(Impl, mPosition, "Position", Math::Vector3(0.f, 0.f, 0.f)),
+        SERIALIZED_FIELD(Impl, mRotation, "Rotation", Math::Quaternion(0.f, 0.f, 0.f, 1.f)),
+        SERIALIZED_FIELD(Impl, mScale, "Scale", Math::Vector3(1.f, 1.f, 1.f)));
+
     /// serialize
     void Serialize(Serialized::Type &out, bool packed) const
     {
-        // set position
-        if (mPosition != Math::Vector3::cZero)
-        {
-            Serialized::SerializeValue(out, packed, Serialized::cPositionToken, Serialized::cPositionTokenPacked,
-                std::array { mPosition.x, mPosition.y, mPosition.z });
-        }
-
-        // set rotation
-        if (mRotation != Math::Quaternion::cIdentity)
-        {
-            Serialized::SerializeValue(out, packed, Serialized::cRotationToken, Serialized::cRotationTokenPacked,
-                std::array { mRotation.x, mRotation.y, mRotation.z, mRotation.w });
-        }
-
-        // set scale
-        if (mScale != Math::Vector3::cOne)
-        {
-            Serialized::SerializeValue(out, packed, Serialized::cScaleToken, Serialized::cScaleTokenPacked,
-                std::array { mScale.x, mScale.y, mScale.z });
-        }
+        Serialized::SerializeFields(out, packed, *this, SerializedFields());
     }
 
     /// deserialize
     void Deserialize(const Serialized::Type &in, bool packed)
     {
-        Serialized::Type value;
-
-        // get position
-        mPosition = Math::Vector3::cZero;
-        if (Serialized::DeserializeValue(in, packed, Serialized::cPositionToken, Serialized::cPositionTokenPacked, value))
-        {
-            if (value.size() != 3)
-            {
-                throw std::runtime_error(std::format("Unable to read Transform::Position"));
-            }
-            mPosition = Math::Vector3 { value.get<std::vector<float>>().data() };
-        }
+        Serialized::DeserializeFields(in, packed, *this, SerializedFields(), "Transform");
+    }
 
-        // get rotation
-        mRotation = Math::Quaternion::cIdentity;
-        if (Serialized::DeserializeValue(in, packed, Serialized::cRotationToken, Serialized::cRotationTokenPacked, value))
-        {
-            if (value.size() != 4)
-            {
-                throw std::runtime_error(std::format("Unable to read Transform::Rotation"));
-            }
-            mRotation = Math::Vector4 { value.get<std::vector<float>>().data() };
-        }
+    /// serialize to a packed scene record
+    void Serialize(PackedScene::TransformRecord &out) const
+    {
+        out = { { mPosition.x, mPosition.y, mPosition.z }, { mRotation.x, mRotation.y, mRotation.z, mRotation.w }, { mScale.x, mScale.y, mScale.z } };
+    }
 
-        // get scale
-        mScale = Math::Vector3::cOne;
-        if (Serialized::DeserializeValue(in, packed, Serialized::cScaleToken, Serialized::cScaleTokenPacked, value))
-        {
-            if (value.size() != 3)
-            {
-                throw std::runtime_error(std::format("Unable to read Transform::Scale"));
-            }
-            mScale = Math::Vector3 { value.get<std::vector<float>>().data() };
-        }
+    /// deserialize from a packed scene record
+    void Deserialize(const PackedScene::TransformRecord &in)
+    {
+        mPosition = Math::Vector3 { in.mPosition };
+        mRotation = Math::Quaternion { in.mRotation };
+        mScale = Math::Vector3 { in.mScale };
     }
 
     /// get owning entity
@@ -103,7 +71,11 @@ public:
     [[nodiscard]] const Math::Vector3 &GetPosition() const { return mPosition; }
 
     /// set position
-    void SetPosition(const Math::Vector3 &position) { mPosition = position; }
+    void SetPosition(const Math::Vector3 &position)
+    {
+        mPosition = position;
+        mDirty = DirtyMark::cAll;
+    }
 
     /// translate by x, y, z
     void Translate(float x, float y, float z)
@@ -111,13 +83,18 @@ public:
         mPosition.x += x;
         mPosition.y += y;
         mPosition.z += z;
+        mDirty = DirtyMark::cAll;
     }
 
     /// get rotation
     [[nodiscard]] const Math::Quaternion &GetRotation() const { return mRotation; }
 
     /// set rotation
-    void SetRotation(const Math::Quaternion &rotation) { mRotation = rotation; }
+    void SetRotation(const Math::Quaternion &rotation)
+    {
+        mRotation = rotation;
+        mDirty = DirtyMark::cAll;
+    }
 
     /// rotate by euler angles in degrees
     void Rotate(float xAngle, float yAngle, float zAngle)
@@ -127,13 +104,18 @@ public:
 
         // normalize to avoid drift over time
         mRotation.Normalize();
+        mDirty = DirtyMark::cAll;
     }
 
     /// get scale
     [[nodiscard]] const Math::Vector3 &GetScale() const { return mScale; }
 
     /// set scale
-    void SetScale(const Math::Vector3 &absoluteScale) { mScale = absoluteScale; }
+    void SetScale(const Math::Vector3 &absoluteScale)
+    {
+        mScale = absoluteScale;
+        mDirty = DirtyMark::cAll;
+    }
 
     /// scale
     void Scale(const Math::Vector3 &relativeScale)
@@ -141,6 +123,7 @@ public:
         mScale.x *= relativeScale.x;
         mScale.y *= relativeScale.y;
         mScale.z *= relativeScale.z;
+        mDirty = DirtyMark::cAll;
     }
 
     /// get world matrix
@@ -177,6 +160,9 @@ public:
 
     /// scale
     Math::Vector3 mScale = Math::Vector3::cOne;
+
+    /// changed marks
+    DirtyMark::Type mDirty = 0;
 };
 
 //==============================================================================================================================================================================
@@ -205,6 +191,18 @@ void Transform::Deserialize(const Serialized::Type &in, bool packed)
     mImpl->Deserialize(in, packed);
 }
 
+/// serialize to a packed scene record
+void Transform::Serialize(PackedScene::TransformRecord &out) const
+{
+    mImpl->Serialize(out);
+}
+
+/// deserialize from a packed scene record
+void Transform::Deserialize(const PackedScene::TransformRecord &in)
+{
+    mImpl->Deserialize(in);
+}
+
 /// get owning entity
 EntityWeakPtr Transform::Entity() const
 {
@@ -282,3 +280,15 @@ void Transform::GetWorldMatrix(Math::Matrix44 &world) const
 {
     return mImpl->GetWorldMatrix(world);
 }
+
+/// check if the transform changed since a mark was last cleared
+bool Transform::Dirty(DirtyMark::Type mark) const
+{
+    return (mImpl->mDirty & mark) != 0;
+}
+
+/// clear changed marks, called by the consumers of changes
+void Transform::ClearDirty(DirtyMark::Type marks)
+{
+    mImpl->mDirty &= ~marks;
+}
@@ -7,6 +7,7 @@
 #include "lAssetManager.h"
 #include "lEngineWindows.h"
 #include "lFolderFileSystem.h"
+#include "lArchiveFileSystem.h"
 
 #include "EngineWindows.h"
 
@@ -112,16 +113,16 @@ private:
     static BYTE sBuffer[65536];
     static OVERLAPPED sOverlapped;
     static HANDLE sDirHandle;
-    static std::string sMonitorDir;
 #endif
+    static std::string sMonitorDir;
 };
 
 #ifdef EDITOR
 BYTE EngineWindows::Impl::sBuffer[65536];
 OVERLAPPED EngineWindows::Impl::sOverlapped;
 HANDLE EngineWindows::Impl::sDirHandle;
-std::string EngineWindows::Impl::sMonitorDir = "Assets";
 #endif
+std::string EngineWindows::Impl::sMonitorDir = "Assets";
 
 /// simple windows events
 Lumen::HashType EngineWindows::DisplayChanged = Lumen::EncodeType("EngineWindows::DisplayChanged");
@@ -253,7 +254,23 @@ void EngineWindows::Impl::FileChangeCallback()
 /// set configuration
 bool EngineWindows::Impl::Config(const Object &config)
 {
-    mAssetsFileSystem = Lumen::FolderFileSystem::MakePtr(sMonitorDir);
+#ifndef EDITOR
+    // shipped assets are read from a packed archive next to the executable when there is one
+    const std::string archivePath = sMonitorDir + ".lpak";
+    if (std::filesystem::exists(archivePath))
+    {
+        mAssetsFileSystem = Lumen::ArchiveFileSystem::MakePtr(Lumen::FolderFileSystem::MakePtr("."), archivePath, sMonitorDir);
+    }
+    else
+#endif
+    {
+#ifdef EDITOR
+        // the editor keeps an index of the folder between sessions, so startup only hashes what changed
+        mAssetsFileSystem = Lumen::FolderFileSystem::MakePtr(sMonitorDir, sMonitorDir + ".index");
+#else
+        mAssetsFileSystem = Lumen::FolderFileSystem::MakePtr(sMonitorDir);
+#endif
+    }
     mAssetsFileSystem->Initialize();
 
     mWindow = static_cast<const Windows::Config &>(config).mWindow;
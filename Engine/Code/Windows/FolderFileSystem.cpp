@@ -5,10 +5,12 @@
 //==============================================================================================================================================================================
 
 #include "lFolderFileSystem.h"
+#include "lFileIndex.h"
+#include "lHandleMap.h"
+#include "lFramework.h"
 
 /// \cond
 #include <fstream>
-#include <unordered_map>
 /// \endcond
 
 using namespace Lumen;
@@ -23,24 +25,40 @@ class FolderFileSystem::Impl
 
 public:
     /// constructs a folder file system implementation
-    explicit Impl(const std::filesystem::path &path) : mPath(path) {}
+    explicit Impl(const std::filesystem::path &path, const std::filesystem::path &indexPath) : mPath(path), mIndexPath(indexPath) {}
 
-    /// initialize file system
+    /// destroys the folder file system implementation, unmapping files that were not closed
+    ~Impl()
+    {
+        mMappedFiles.ForEach([](Id::Type, MappedFile &mappedFile)
+        {
+            Unmap(mappedFile);
+        });
+    }
+
+    /// initialize file system, only the files that changed since the saved index are hashed
+    /// the folder is scanned in the background and its changes pushed a chunk at a time, so processing starts before the scan is done
     void Initialize()
     {
-        std::vector<FileSystem::FileChange> fileBatch;
-        for (const auto &entry : std::filesystem::recursive_directory_iterator(mPath))
+        if (!mIndexPath.empty())
         {
-            if (entry.is_regular_file() || entry.is_directory())
-            {
-                FileSystem::Flags flags = entry.is_directory() ? FileSystem::Flag::Directory : FileSystem::Flag::File;
-                std::string filename = entry.path().lexically_relative(mPath).generic_string();
-                fileBatch.push_back({ FileSystem::Change::Added, flags, (mPath / filename).string(), "" });
-            }
+            mIndex.Load(mIndexPath);
         }
-        if (!fileBatch.empty())
+        mIndex.UpdateAsync(mPath, [](std::vector<FileSystem::FileChange> &&fileBatch)
         {
             FileSystem::PushFileChangeBatch(std::move(fileBatch));
+        });
+    }
+
+    /// shutdown file system, the index is brought up to date with the folder and saved
+    void Shutdown()
+    {
+        mIndex.Wait();
+        if (!mIndexPath.empty())
+        {
+            std::vector<FileSystem::FileChange> fileBatch;
+            mIndex.Update(mPath, fileBatch);
+            mIndex.Save(mIndexPath);
         }
     }
 
@@ -53,7 +71,7 @@ public:
     /// whether this file system handles the specified file handle
     bool Handles(Id::Type handle)
     {
-        return mOpenFiles.find(handle) != mOpenFiles.end();
+        return mOpenFiles.Contains(handle) || mMappedFiles.Contains(handle);
     }
 
     /// check if a file exists
@@ -103,7 +121,7 @@ public:
         if (file.is_open())
         {
             Id::Type fileId = FileSystem::GenerateFileId();
-            mOpenFiles.emplace(fileId, std::move(file));
+            mOpenFiles.Emplace(fileId, std::move(file));
             return fileId;
         }
         return Id::Invalid;
@@ -112,18 +130,103 @@ public:
     /// closes a file handle
     void Close(const Id::Type handle)
     {
-        mOpenFiles.erase(handle);
+        if (MappedFile *mappedFile = mMappedFiles.Find(handle))
+        {
+            Unmap(*mappedFile);
+            mMappedFiles.Erase(handle);
+            return;
+        }
+        mOpenFiles.Erase(handle);
+    }
+
+    /// maps a whole file read-only, the data stays valid until the handle is closed
+    Id::Type Map(const std::filesystem::path &path, std::span<const byte> &data)
+    {
+        std::filesystem::path fullPath = mPath / path;
+        HANDLE file = CreateFileW(fullPath.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+        {
+            return Id::Invalid;
+        }
+
+        // empty files cannot be mapped, they are read into a copy instead
+        LARGE_INTEGER size = {};
+        if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+        {
+            CloseHandle(file);
+            return Id::Invalid;
+        }
+        MappedFile mappedFile = { file, CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr), nullptr };
+        if (mappedFile.mMapping)
+        {
+            mappedFile.mView = MapViewOfFile(mappedFile.mMapping, FILE_MAP_READ, 0, 0, 0);
+        }
+        if (!mappedFile.mView)
+        {
+            Unmap(mappedFile);
+            return Id::Invalid;
+        }
+
+        Id::Type fileId = FileSystem::GenerateFileId();
+        mMappedFiles.Emplace(fileId, mappedFile);
+        data = std::span<const byte>(static_cast<const byte *>(mappedFile.mView), static_cast<size_t>(size.QuadPart));
+        return fileId;
+    }
+
+    /// reads bytes at an offset of a file without a handle, each read opens the file so io threads share no state
+    size_t ReadAt(const std::filesystem::path &path, size_t offset, std::span<byte> buffer)
+    {
+        std::filesystem::path fullPath = mPath / path;
+        HANDLE file = CreateFileW(fullPath.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+        {
+            return SIZE_MAX;
+        }
+
+        // positional reads, ReadFile reads at most 4GB at a time
+        size_t size = 0;
+        while (size < buffer.size())
+        {
+            OVERLAPPED overlapped = {};
+            ULARGE_INTEGER position;
+            position.QuadPart = offset + size;
+            overlapped.Offset = position.LowPart;
+            overlapped.OffsetHigh = position.HighPart;
+            DWORD count = static_cast<DWORD>(std::min<size_t>(buffer.size() - size, MAXDWORD));
+            DWORD read = 0;
+            if (!ReadFile(file, buffer.data() + size, count, &read, &overlapped))
+            {
+                if (GetLastError() != ERROR_HANDLE_EOF)
+                {
+                    size = SIZE_MAX;
+                }
+                break;
+            }
+            if (read == 0)
+            {
+                break;
+            }
+            size += read;
+        }
+        CloseHandle(file);
+        return size;
+    }
+
+    /// path of a file on the native file system
+    std::filesystem::path NativePath(const std::filesystem::path &path) const
+    {
+        return mPath / path;
     }
 
     /// reads bytes from a file handle
     size_t ReadBytes(const Id::Type handle, void *buffer, const size_t size)
     {
-        auto it = mOpenFiles.find(handle);
-        if (it == mOpenFiles.end())
+        FileState *state = mOpenFiles.Find(handle);
+        if (!state)
         {
             return false;
         }
-        std::fstream &file = it->second.mFileStream;
+        std::fstream &file = state->mFileStream;
         file.read(static_cast<char *>(const_cast<void *>(buffer)), size);
         return file.gcount();
     }
@@ -131,92 +234,182 @@ public:
     /// writes bytes to a file handle
     bool WriteBytes(const Id::Type handle, const void *buffer, const size_t size)
     {
-        auto it = mOpenFiles.find(handle);
-        if (it == mOpenFiles.end())
+        FileState *state = mOpenFiles.Find(handle);
+        if (!state)
         {
             return false;
         }
-        std::fstream &file = it->second.mFileStream;
+        std::fstream &file = state->mFileStream;
         file.write(static_cast<const char *>(buffer), size);
         return true;
     }
 
-    /// reads text from a file handle
+    /// reads text from a file handle, a negative line count reads to the end, the text is returned as stored
     std::string ReadText(const Id::Type handle, int lineCount)
     {
-        std::string serializedData;
+        std::string text;
 
-        auto it = mOpenFiles.find(handle);
-        if (it == mOpenFiles.end())
+        FileState *state = mOpenFiles.Find(handle);
+        if (!state)
         {
-            return serializedData;
+            return text;
         }
-        std::fstream &file = it->second.mFileStream;
+        std::fstream &file = state->mFileStream;
 
-        std::string line;
-        if (lineCount == -1)
+        if (lineCount < 0)
         {
-            while (std::getline(file, line))
+            // the rest of the file in one read, sized from the file
+            const std::streampos current = file.tellg();
+            file.seekg(0, std::ios::end);
+            const std::streampos end = file.tellg();
+            file.seekg(current, std::ios::beg);
+            if (current < 0 || end <= current)
             {
-                serializedData += std::move(line);
+                return text;
             }
+            text.resize(static_cast<size_t>(end - current));
+            file.read(text.data(), text.size());
+
+            // text mode may translate line endings, so fewer characters than bytes can be read
+            text.resize(static_cast<size_t>(file.gcount()));
+            file.clear();
         }
         else
         {
-            while (std::getline(file, line) && lineCount--)
+            // only the requested lines are read, newlines included
+            std::streambuf *buffer = file.rdbuf();
+            while (lineCount > 0)
             {
-                serializedData += std::move(line);
+                int c = buffer->sbumpc();
+                if (c == std::char_traits<char>::eof())
+                {
+                    break;
+                }
+                text.push_back(static_cast<char>(c));
+                if (c == '\n')
+                {
+                    --lineCount;
+                }
             }
         }
 
-        return serializedData;
+        return text;
     }
 
     /// writes text to a file handle
     bool WriteText(const Id::Type handle, const std::string &text)
     {
-        auto it = mOpenFiles.find(handle);
-        if (it == mOpenFiles.end())
+        FileState *state = mOpenFiles.Find(handle);
+        if (!state)
         {
             return false;
         }
-        std::fstream &file = it->second.mFileStream;
+        std::fstream &file = state->mFileStream;
 
         file << text;
         return true;
     }
 
+    /// write a whole file aside of its path, called from any thread
+    bool WriteAside(const std::filesystem::path &path, std::span<const byte> data)
+    {
+        std::filesystem::path asidePath = mPath / path;
+        asidePath += FileSystem::cAsideSuffix;
+        HANDLE file = CreateFileW(asidePath.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+        {
+            return false;
+        }
+
+        // WriteFile writes at most 4GB at a time
+        bool result = true;
+        size_t size = 0;
+        while (size < data.size())
+        {
+            DWORD count = static_cast<DWORD>(std::min<size_t>(data.size() - size, MAXDWORD));
+            DWORD written = 0;
+            if (!::WriteFile(file, data.data() + size, count, &written, nullptr))
+            {
+                result = false;
+                break;
+            }
+            size += written;
+        }
+        CloseHandle(file);
+        if (!result)
+        {
+            DeleteFileW(asidePath.c_str());
+        }
+        return result;
+    }
+
+    /// replace files with the files written aside of them, a durable commit flushes them to disk once for all files
+    bool CommitAside(std::span<const std::filesystem::path> paths, FileSystem::Durability durability)
+    {
+        bool durable = durability == FileSystem::Durability::Durable;
+
+        // flushing a whole volume needs elevation, so each file is flushed, but only once all are written
+        if (durable)
+        {
+            for (const std::filesystem::path &path : paths)
+            {
+                std::filesystem::path asidePath = mPath / path;
+                asidePath += FileSystem::cAsideSuffix;
+                HANDLE file = CreateFileW(asidePath.c_str(), GENERIC_WRITE, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+                if (file != INVALID_HANDLE_VALUE)
+                {
+                    FlushFileBuffers(file);
+                    CloseHandle(file);
+                }
+            }
+        }
+
+        bool result = true;
+        for (const std::filesystem::path &path : paths)
+        {
+            std::filesystem::path fullPath = mPath / path;
+            std::filesystem::path asidePath = fullPath;
+            asidePath += FileSystem::cAsideSuffix;
+            if (!MoveFileExW(asidePath.c_str(), fullPath.c_str(), MOVEFILE_REPLACE_EXISTING | (durable ? MOVEFILE_WRITE_THROUGH : 0)))
+            {
+                DeleteFileW(asidePath.c_str());
+                result = false;
+            }
+        }
+        return result;
+    }
+
     /// gets the current position in the file by handle
     size_t Tell(const Id::Type handle)
     {
-        auto it = mOpenFiles.find(handle);
-        if (it == mOpenFiles.end())
+        FileState *state = mOpenFiles.Find(handle);
+        if (!state)
         {
             return 0;
         }
-        return static_cast<size_t>(it->second.mFileStream.tellg());
+        return static_cast<size_t>(state->mFileStream.tellg());
     }
 
     /// seeks to a position in the file by handle
     void Seek(const Id::Type handle, const size_t position)
     {
-        auto it = mOpenFiles.find(handle);
-        if (it == mOpenFiles.end())
+        FileState *state = mOpenFiles.Find(handle);
+        if (!state)
         {
             return;
         }
-        it->second.mFileStream.seekg(static_cast<std::streamoff>(position), std::ios::beg);
+        state->mFileStream.seekg(static_cast<std::streamoff>(position), std::ios::beg);
     }
 
     /// gets the size of the file by handle
     size_t Size(const Id::Type handle)
     {
-        auto it = mOpenFiles.find(handle);
-        if (it == mOpenFiles.end())
+        FileState *state = mOpenFiles.Find(handle);
+        if (!state)
         {
             return static_cast<size_t>(-1);
         }
-        std::fstream &file = it->second.mFileStream;
+        std::fstream &file = state->mFileStream;
 
         // get file size by seeking to the end and back
         const std::streampos current = file.tellg();
@@ -228,6 +421,33 @@ public:
     }
 
 private:
+    /// mapped file struct
+    struct MappedFile
+    {
+        /// file handle
+        HANDLE mFile;
+
+        /// file mapping handle
+        HANDLE mMapping;
+
+        /// mapped view
+        const void *mView;
+    };
+
+    /// unmaps a file and closes its handles
+    static void Unmap(const MappedFile &mappedFile)
+    {
+        if (mappedFile.mView)
+        {
+            UnmapViewOfFile(mappedFile.mView);
+        }
+        if (mappedFile.mMapping)
+        {
+            CloseHandle(mappedFile.mMapping);
+        }
+        CloseHandle(mappedFile.mFile);
+    }
+
     /// file state struct
     struct FileState
     {
@@ -238,20 +458,29 @@ private:
     /// path
     const std::filesystem::path mPath;
 
+    /// index path, empty if the index is not saved
+    const std::filesystem::path mIndexPath;
+
+    /// index of the folder
+    FileIndex mIndex;
+
     /// open files
-    std::unordered_map<Id::Type, FileState> mOpenFiles;
+    HandleMap<FileState> mOpenFiles;
+
+    /// mapped files
+    HandleMap<MappedFile> mMappedFiles;
 };
 
 //==============================================================================================================================================================================
 
 /// constructs a folder file system
-FolderFileSystem::FolderFileSystem(const std::filesystem::path &path) :
-    IFileSystem(), mImpl(FolderFileSystem::Impl::MakeUniquePtr(FileSystem::NormalizeDirPath(path))) {}
+FolderFileSystem::FolderFileSystem(const std::filesystem::path &path, const std::filesystem::path &indexPath) :
+    IFileSystem(), mImpl(FolderFileSystem::Impl::MakeUniquePtr(FileSystem::NormalizeDirPath(path), indexPath)) {}
 
 /// creates a smart pointer version of the folder file system
-IFileSystemPtr FolderFileSystem::MakePtr(const std::filesystem::path &path)
+IFileSystemPtr FolderFileSystem::MakePtr(const std::filesystem::path &path, const std::filesystem::path &indexPath)
 {
-    return IFileSystemPtr(new FolderFileSystem(path));
+    return IFileSystemPtr(new FolderFileSystem(path, indexPath));
 }
 
 /// initialize file system
@@ -260,6 +489,12 @@ void FolderFileSystem::Initialize()
     return mImpl->Initialize();
 }
 
+/// shutdown file system
+void FolderFileSystem::Shutdown()
+{
+    mImpl->Shutdown();
+}
+
 /// whether this file system is packed
 bool FolderFileSystem::Packed() const
 {
@@ -296,6 +531,24 @@ void FolderFileSystem::Close(const Id::Type handle)
     mImpl->Close(handle);
 }
 
+/// maps a whole file read-only, the data stays valid until the handle is closed
+Id::Type FolderFileSystem::Map(const std::filesystem::path &path, std::span<const byte> &data)
+{
+    return mImpl->Map(path, data);
+}
+
+/// reads bytes at an offset of a file without a handle
+size_t FolderFileSystem::ReadAt(const std::filesystem::path &path, size_t offset, std::span<byte> buffer)
+{
+    return mImpl->ReadAt(path, offset, buffer);
+}
+
+/// path of a file on the native file system
+std::filesystem::path FolderFileSystem::NativePath(const std::filesystem::path &path)
+{
+    return mImpl->NativePath(path);
+}
+
 /// reads bytes from a file handle
 size_t FolderFileSystem::ReadBytes(const Id::Type handle, void *buffer, const size_t size)
 {
@@ -320,6 +573,18 @@ bool FolderFileSystem::WriteText(const Id::Type handle, const std::string &text)
     return mImpl->WriteText(handle, text);
 }
 
+/// write a whole file aside of its path, called from any thread
+bool FolderFileSystem::WriteAside(const std::filesystem::path &path, std::span<const byte> data)
+{
+    return mImpl->WriteAside(path, data);
+}
+
+/// replace files with the files written aside of them, a durable commit flushes them to disk once for all files
+bool FolderFileSystem::CommitAside(std::span<const std::filesystem::path> paths, FileSystem::Durability durability)
+{
+    return mImpl->CommitAside(paths, durability);
+}
+
 /// gets the current position in the file by handle
 size_t FolderFileSystem::Tell(const Id::Type handle)
 {
@@ -0,0 +1,45 @@
+//==============================================================================================================================================================================
+/// \file
+/// \brief     FolderWatcher interface
+/// \copyright Copyright (c) Gustavo Goedert. All rights reserved.
+//==============================================================================================================================================================================
+#pragma once
+
+#include "lFileSystem.h"
+
+/// Lumen Linux namespace
+namespace Lumen::Linux
+{
+    CLASS_PTR_DEF(FolderWatcher);
+
+    /// FolderWatcher class, watches a folder tree with inotify on a background thread
+    /// changes are coalesced and pushed with FileSystem::PushFileChangeBatch, named like the folder file system on the same path
+    class FolderWatcher
+    {
+        CLASS_NO_DEFAULT_CTOR(FolderWatcher);
+        CLASS_NO_COPY_MOVE(FolderWatcher);
+
+    public:
+        /// destroys the folder watcher, stopping it
+        ~FolderWatcher();
+
+        /// creates a smart pointer version of the folder watcher
+        static FolderWatcherPtr MakePtr(const std::filesystem::path &path);
+
+        /// start watching, the folder tree is walked on the watcher thread
+        bool Start();
+
+        /// stop watching, changes not pushed yet are dropped
+        void Stop();
+
+        /// whether the watcher is running
+        [[nodiscard]] bool Running() const;
+
+    private:
+        /// constructs a folder watcher
+        explicit FolderWatcher(const std::filesystem::path &path);
+
+        /// private implementation
+        CLASS_PIMPL_DEF(Impl);
+    };
+}
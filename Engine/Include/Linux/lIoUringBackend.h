@@ -0,0 +1,40 @@
+//==============================================================================================================================================================================
+/// \file
+/// \brief     IoUringBackend interface
+/// \copyright Copyright (c) Gustavo Goedert. All rights reserved.
+//==============================================================================================================================================================================
+#pragma once
+
+#include "lAsyncIo.h"
+
+/// Lumen Linux namespace
+namespace Lumen::Linux
+{
+    /// IoUringBackend class, async io backend that reads native files through an io_uring, completions are reaped on a background thread
+    /// files that are not stored as native files are read on the thread pool
+    class IoUringBackend : public IAsyncIoBackend
+    {
+        CLASS_NO_DEFAULT_CTOR(IoUringBackend);
+        CLASS_NO_COPY_MOVE(IoUringBackend);
+
+    public:
+        /// destroys the backend, every operation must be done
+        ~IoUringBackend() override;
+
+        /// creates a smart pointer version of the backend with a queue depth, null if the io_uring cannot be set up so AsyncIo falls back to the thread pool
+        static IAsyncIoBackendPtr MakePtr(unsigned depth = 64);
+
+        /// maximum number of operations in flight
+        size_t Depth() const override;
+
+        /// start an operation
+        void Submit(AsyncIo::Operation &operation) override;
+
+    private:
+        /// constructs a backend, setting up an io_uring with a queue depth
+        explicit IoUringBackend(unsigned depth);
+
+        /// private implementation
+        CLASS_PIMPL_DEF(Impl);
+    };
+}
@@ -0,0 +1,85 @@
+//==============================================================================================================================================================================
+/// \file
+/// \brief     ArchiveFileSystem interface
+/// \copyright Copyright (c) Gustavo Goedert. All rights reserved.
+//==============================================================================================================================================================================
+#pragma once
+
+#include "lFileSystem.h"
+
+/// Lumen namespace
+namespace Lumen
+{
+    /// ArchiveFileSystem class, a read-only packed file system over a packed archive
+    class ArchiveFileSystem : public IFileSystem
+    {
+        CLASS_NO_DEFAULT_CTOR(ArchiveFileSystem);
+        CLASS_NO_COPY_MOVE(ArchiveFileSystem);
+
+    public:
+        /// creates a smart pointer version of the archive file system, the archive is mapped from the source file system
+        /// file changes are reported with the root prefixed, it should be the mount point
+        static IFileSystemPtr MakePtr(const IFileSystemPtr &source, const std::filesystem::path &archivePath, const std::filesystem::path &root);
+
+        /// initialize file system
+        void Initialize() override;
+
+        /// whether this file system is packed
+        bool Packed() const override;
+
+        /// whether this file system handles the specified file handle
+        bool Handles(Id::Type handle) override;
+
+        /// check if a file exists
+        bool Exists(const std::filesystem::path &path) override;
+
+        /// list files in a directory
+        std::vector<FileSystem::FileEntry> ListFiles(const std::filesystem::path &path) override;
+
+        /// opens a file on the specified path
+        Id::Type Open(const std::filesystem::path &path, bool write, bool binary) override;
+
+        /// closes a file handle
+        void Close(const Id::Type handle) override;
+
+        /// maps a whole file read-only, the data stays valid until the handle is closed
+        Id::Type Map(const std::filesystem::path &path, std::span<const byte> &data) override;
+
+        /// reads bytes at an offset of a file without a handle
+        size_t ReadAt(const std::filesystem::path &path, size_t offset, std::span<byte> buffer) override;
+
+        /// reads bytes from a file handle
+        size_t ReadBytes(const Id::Type handle, void *buffer, const size_t size = SIZE_MAX) override;
+
+        /// writes bytes to a file handle
+        bool WriteBytes(const Id::Type handle, const void *buffer, const size_t size) override;
+
+        /// reads text from a file handle
+        std::string ReadText(const Id::Type handle, const int lineCount = -1) override;
+
+        /// writes text to a file handle
+        bool WriteText(const Id::Type handle, const std::string &text) override;
+
+        /// write a whole file aside of its path, the archive is read-only
+        bool WriteAside(const std::filesystem::path &path, std::span<const byte> data) override;
+
+        /// replace files with the files written aside of them, the archive is read-only
+        bool CommitAside(std::span<const std::filesystem::path> paths, FileSystem::Durability durability) override;
+
+        /// gets the current position in the file by handle
+        size_t Tell(const Id::Type handle) override;
+
+        /// seeks to a position in the file by handle
+        void Seek(const Id::Type handle, const size_t position) override;
+
+        /// gets the size of the file by handle
+        size_t Size(const Id::Type handle) override;
+
+    private:
+        /// constructs an archive file system
+        explicit ArchiveFileSystem(const IFileSystemPtr &source, const std::filesystem::path &archivePath, const std::filesystem::path &root);
+
+        /// private implementation
+        CLASS_PIMPL_DEF(Impl);
+    };
+}
@@ -6,6 +6,7 @@
 #pragma once
 
 #include "lExpected.h"
+#include "lHash.h"
 #include "lUUID.h"
 
 /// \cond
@@ -17,6 +18,7 @@ namespace Lumen
 {
     CLASS_PTR_DEF(AssetInfo);
     CLASS_WEAK_PTR_DEF(AssetInfo);
+    class BatchWriter;
 
     /// AssetInfo class
     class AssetInfo
@@ -40,6 +42,9 @@ namespace Lumen
         /// save assetinfo
         bool Save() const;
 
+        /// save assetinfo as part of a batch, it is on disk once the batch finishes
+        void Save(BatchWriter &writer) const;
+
         /// load assetinfo
         bool Load();
 
@@ -47,7 +52,13 @@ namespace Lumen
         const std::filesystem::path &Path() const;
 
         /// get UUID
-        const UUID UUID() const;
+        const Lumen::UUID UUID() const;
+
+        /// get the content hash of the asset file, zero if unknown
+        Hash64 ContentHash() const;
+
+        /// set the content hash of the asset file
+        void SetContentHash(Hash64 hash);
 
     private:
         /// constructs an assetinfo
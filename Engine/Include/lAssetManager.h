@@ -8,6 +8,7 @@
 #include "lDefs.h"
 #include "lAsset.h"
 #include "lAssetInfo.h"
+#include "lPathId.h"
 
 /// Lumen namespace
 namespace Lumen
@@ -44,10 +45,10 @@ namespace Lumen
         [[nodiscard]] float Priority() const noexcept { return mPriority; }
 
         /// check if asset exists
-        [[nodiscard]] virtual bool Exists(const std::filesystem::path &path) const = 0;
+        [[nodiscard]] virtual bool Exists(PathId path) const = 0;
 
         /// import asset
-        [[nodiscard]] virtual Expected<AssetPtr> Import(EngineWeakPtr &engine, HashType type, const std::filesystem::path &path) const = 0;
+        [[nodiscard]] virtual Expected<AssetPtr> Import(EngineWeakPtr &engine, HashType type, PathId path) const = 0;
 
     private:
         /// priority
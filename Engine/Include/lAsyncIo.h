@@ -0,0 +1,94 @@
+//==============================================================================================================================================================================
+/// \file
+/// \brief     asynchronous file read interface
+/// \copyright Copyright (c) Gustavo Goedert. All rights reserved.
+//==============================================================================================================================================================================
+#pragma once
+
+#include "lDefs.h"
+#include "lId.h"
+
+/// \cond
+#include <filesystem>
+#include <functional>
+#include <span>
+/// \endcond
+
+/// Lumen namespace
+namespace Lumen
+{
+    CLASS_PTR_DEF(IAsyncIoBackend);
+
+    /// AsyncIo namespace
+    namespace AsyncIo
+    {
+        /// priority class, higher priorities are dispatched first
+        enum class Priority : byte { High, Normal, Low };
+
+        /// number of priority classes
+        constexpr size_t cPriorityCount = 3;
+
+        /// largest read that adjacent requests are merged into
+        constexpr size_t cMaxMergeSize = 1024 * 1024;
+
+        /// completion callback, receives the request and the bytes read, SIZE_MAX if the read failed
+        using Callback = std::function<void(Id::Type request, size_t size)>;
+
+        /// Operation struct, a read performed by a backend, adjacent requests are merged into one operation
+        struct Operation
+        {
+            /// path of the file, resolved through the registered file systems
+            std::filesystem::path mPath;
+
+            /// offset in the file
+            size_t mOffset = 0;
+
+            /// destination, its size is the number of bytes to read
+            std::span<byte> mBuffer;
+
+            /// bytes read, set by the backend before it completes the operation, SIZE_MAX if the read failed
+            size_t mSize = 0;
+        };
+
+        /// initialize async io namespace, without a backend reads are run on the thread pool
+        void Initialize(const IAsyncIoBackendPtr &backend = {});
+
+        /// shutdown async io namespace, pending reads are finished and their callbacks run first
+        void Shutdown();
+
+        /// submit a read of buffer.size() bytes at an offset of a file, the buffer must stay valid until the request is retired
+        Id::Type Read(const std::filesystem::path &path, size_t offset, std::span<byte> buffer, Priority priority = Priority::Normal, Callback &&callback = {});
+
+        /// checks if a request is done, retired requests are done
+        [[nodiscard]] bool Done(Id::Type request);
+
+        /// wait for a request and retire it, running its callback, returns the bytes read or SIZE_MAX if it failed or was already retired
+        size_t Wait(Id::Type request);
+
+        /// retire the requests that are done, running their callbacks on the calling thread
+        void Update();
+
+        /// called by backends from any thread when an operation is done
+        void Complete(Operation &operation);
+    }
+
+    /// asynchronous io backend interface class
+    class IAsyncIoBackend
+    {
+        CLASS_NO_COPY_MOVE(IAsyncIoBackend);
+
+    public:
+        /// maximum number of operations in flight
+        virtual size_t Depth() const = 0;
+
+        /// start an operation, the backend calls AsyncIo::Complete when it is done, possibly before returning
+        virtual void Submit(AsyncIo::Operation &operation) = 0;
+
+        /// virtual destructor
+        virtual ~IAsyncIoBackend() = default;
+
+    protected:
+        /// default constructor
+        explicit IAsyncIoBackend() = default;
+    };
+}
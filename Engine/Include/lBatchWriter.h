@@ -0,0 +1,39 @@
+//==============================================================================================================================================================================
+/// \file
+/// \brief     BatchWriter interface
+/// \copyright Copyright (c) Gustavo Goedert. All rights reserved.
+//==============================================================================================================================================================================
+#pragma once
+
+#include "lFileSystem.h"
+
+/// Lumen namespace
+namespace Lumen
+{
+    /// BatchWriter class, writes many files aside on a thread pool worker and replaces them all when finished
+    /// each file is replaced atomically, and a durable batch is flushed to disk once instead of once per file
+    class BatchWriter
+    {
+        CLASS_NO_COPY_MOVE(BatchWriter);
+
+    public:
+        /// constructs a batch writer
+        explicit BatchWriter(FileSystem::Durability durability = FileSystem::Durability::Durable);
+
+        /// destructor, finishes the batch
+        ~BatchWriter();
+
+        /// queue a whole file write, a path written again in the same batch keeps the last data
+        void Write(const std::filesystem::path &path, std::vector<byte> &&data);
+
+        /// queue serialized data encoded the way it is stored at a path
+        void WriteSerializedData(const std::filesystem::path &path, const Serialized::Type &data);
+
+        /// wait for the queued writes and replace their files, returns false if any file was not written
+        bool Finish();
+
+    private:
+        /// private implementation
+        CLASS_PIMPL_DEF(Impl);
+    };
+}
@@ -22,10 +22,10 @@ namespace Lumen
         static AssetFactoryOldPtr MakePtr(float priority);
 
         /// check if asset exists
-        [[nodiscard]] bool Exists(const std::filesystem::path &path) const override;
+        [[nodiscard]] bool Exists(PathId path) const override;
 
         /// import asset
-        [[nodiscard]] Expected<AssetPtr> Import(EngineWeakPtr &engine, HashType type, const std::filesystem::path &path) const override;
+        [[nodiscard]] Expected<AssetPtr> Import(EngineWeakPtr &engine, HashType type, PathId path) const override;
 
     private:
         /// constructor
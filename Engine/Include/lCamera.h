@@ -27,6 +27,9 @@ namespace Lumen
         /// deserialize
         void Deserialize(const Serialized::Type &in, bool packed) override;
 
+        /// every setter marks the component as changed
+        [[nodiscard]] bool TracksChanges() const override { return true; }
+
         /// get the camera's background color
         [[nodiscard]] const Math::Vector4 &GetBackgroundColor() const;
 
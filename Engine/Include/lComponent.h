@@ -35,6 +35,18 @@ namespace Lumen
         /// get owning entity
         [[nodiscard]] EntityWeakPtr Entity() const;
 
+        /// mark the component as changed, sets every changed mark
+        void SetDirty();
+
+        /// check if the component changed since a mark was last cleared, components that do not track their changes are always changed
+        [[nodiscard]] bool Dirty(DirtyMark::Type mark) const;
+
+        /// true if every change to the serialized state calls SetDirty, components with fields changed directly keep the default
+        [[nodiscard]] virtual bool TracksChanges() const { return false; }
+
+        /// clear changed marks, called by the consumers of changes
+        void ClearDirty(DirtyMark::Type marks);
+
     protected:
         /// constructs a component with type, name, and parent. called by derived classes
         explicit Component(HashType type, std::string_view name, const EntityWeakPtr &entity);
@@ -0,0 +1,99 @@
+//==============================================================================================================================================================================
+/// \file
+/// \brief     block compression interface
+/// \copyright Copyright (c) Gustavo Goedert. All rights reserved.
+//==============================================================================================================================================================================
+#pragma once
+
+#include "lDefs.h"
+
+/// \cond
+#include <span>
+#include <vector>
+/// \endcond
+
+/// Lumen Compression namespace
+namespace Lumen::Compression
+{
+    /// file magic, "LZBK" in little-endian, data without it is not compressed
+    constexpr dword cMagic = 0x4B425A4C;
+
+    /// current format version
+    constexpr word cVersion = 1;
+
+    /// default uncompressed block size, blocks are compressed independently
+    constexpr size_t cBlockSize = 64 * 1024;
+
+    /// block table entry flag, the block is stored uncompressed
+    constexpr dword cStoredBlock = 0x80000000;
+
+    /// compressed data header, followed by a block table of dword sizes and the block data
+    struct Header
+    {
+        /// magic
+        dword mMagic;
+
+        /// version
+        word mVersion;
+
+        /// flags, reserved
+        word mFlags;
+
+        /// uncompressed size
+        dword mSize;
+
+        /// uncompressed block size, the last block may be smaller
+        dword mBlockSize;
+
+        /// number of blocks
+        dword mBlockCount;
+    };
+
+    /// checks if a buffer starts with a compressed data header
+    [[nodiscard]] bool IsCompressed(std::span<const byte> data);
+
+    /// compress data in independent blocks, blocks are compressed in parallel
+    [[nodiscard]] std::vector<byte> Compress(std::span<const byte> data, size_t blockSize = cBlockSize);
+
+    /// decompress data, blocks are decompressed in parallel
+    bool Decompress(std::span<const byte> data, std::vector<byte> &out);
+
+    /// View class, decompresses single blocks of compressed data so it can be streamed
+    class View
+    {
+    public:
+        /// default constructor
+        explicit View() = default;
+
+        /// opens a view on compressed data, the data must outlive the view
+        bool Open(std::span<const byte> data);
+
+        /// uncompressed size
+        [[nodiscard]] size_t Size() const { return mHeader ? mHeader->mSize : 0; }
+
+        /// number of blocks
+        [[nodiscard]] size_t BlockCount() const { return mHeader ? mHeader->mBlockCount : 0; }
+
+        /// uncompressed offset of a block
+        [[nodiscard]] size_t BlockOffset(size_t index) const { return index * mHeader->mBlockSize; }
+
+        /// uncompressed size of a block
+        [[nodiscard]] size_t BlockSize(size_t index) const;
+
+        /// decompress a block, out must hold BlockSize(index) bytes
+        bool DecompressBlock(size_t index, std::span<byte> out) const;
+
+    private:
+        /// header
+        const Header *mHeader = nullptr;
+
+        /// block table
+        const dword *mBlocks = nullptr;
+
+        /// compressed offset of every block, relative to the data
+        std::vector<size_t> mOffsets;
+
+        /// data
+        std::span<const byte> mData;
+    };
+}
@@ -8,6 +8,7 @@
 #include "lDefs.h"
 
 /// \cond
+#include <list>
 #include <mutex>
 /// \endcond
 
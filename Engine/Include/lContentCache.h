@@ -0,0 +1,108 @@
+//==============================================================================================================================================================================
+/// \file
+/// \brief     ContentCache interface
+/// \copyright Copyright (c) Gustavo Goedert. All rights reserved.
+//==============================================================================================================================================================================
+#pragma once
+
+#include "lFileSystem.h"
+#include "lHash.h"
+#include "lPathId.h"
+
+/// \cond
+#include <list>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <unordered_map>
+/// \endcond
+
+/// Lumen namespace
+namespace Lumen
+{
+    /// ContentCache class, a thread safe least recently used cache of whole file contents, holding at most a budget of bytes
+    /// entries are dropped when their file changes, and an entry read before a change is never stored after it
+    class ContentCache
+    {
+        CLASS_NO_COPY_MOVE(ContentCache);
+
+    public:
+        /// Content struct, the cached content of a file
+        struct Content
+        {
+            /// data
+            std::vector<byte> mData;
+
+            /// content hash of the data
+            Hash64 mHash;
+        };
+
+        /// content pointer type, content stays valid while used even if it is dropped from the cache
+        using ContentPtr = std::shared_ptr<const Content>;
+
+        /// counters type
+        using Stats = FileSystem::CacheStats;
+
+        /// constructs a cache with a budget in bytes
+        explicit ContentCache(size_t budget);
+
+        /// find the content of a path, null if it is not cached
+        [[nodiscard]] ContentPtr Find(PathId path);
+
+        /// get the invalidation generation, taken before reading content that is stored afterwards
+        [[nodiscard]] qword Generation() const;
+
+        /// store the content of a path read at a generation, it is not stored if anything was invalidated since or it is too large
+        void Insert(PathId path, std::span<const byte> data, qword generation);
+
+        /// drop the content of a path
+        void Invalidate(PathId path);
+
+        /// drop the content of every path in a folder and its subfolders
+        void InvalidateFolder(PathId folder);
+
+        /// set the budget in bytes, zero disables the cache
+        void SetBudget(size_t budget);
+
+        /// largest content stored, a fraction of the budget so one file cannot flush the cache
+        [[nodiscard]] size_t MaxContentSize() const;
+
+        /// get the counters
+        [[nodiscard]] Stats GetStats() const;
+
+    private:
+        /// Entry struct
+        struct Entry
+        {
+            /// path
+            PathId mPath;
+
+            /// content
+            ContentPtr mContent;
+        };
+
+        /// drop the least recently used entries until the cache is in budget, the mutex must be held
+        void Trim();
+
+        /// drop an entry, the mutex must be held
+        void Erase(std::list<Entry>::iterator it);
+
+        /// mutex protecting the entries and the counters
+        mutable std::mutex mMutex;
+
+        /// entries, most recently used first
+        std::list<Entry> mEntries;
+
+        /// entry of each path
+        std::unordered_map<PathId, std::list<Entry>::iterator> mIndex;
+
+        /// budget in bytes
+        size_t mBudget;
+
+        /// invalidation generation
+        qword mGeneration = 0;
+
+        /// counters
+        Stats mStats;
+    };
+}
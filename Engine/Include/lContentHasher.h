@@ -0,0 +1,56 @@
+//==============================================================================================================================================================================
+/// \file
+/// \brief     ContentHasher interface
+/// \copyright Copyright (c) Gustavo Goedert. All rights reserved.
+//==============================================================================================================================================================================
+#pragma once
+
+#include "lHash.h"
+
+/// \cond
+#include <span>
+/// \endcond
+
+/// Lumen namespace
+namespace Lumen
+{
+    /// ContentHasher class, a fast non-cryptographic 64 bit hash of file contents
+    /// data is hashed in 64 byte stripes with simd when available, every path gives the same hash
+    class ContentHasher
+    {
+    public:
+        /// stripe size
+        static constexpr size_t cStripeSize = 64;
+
+        /// stripes per block, the accumulators are scrambled after each block
+        static constexpr size_t cBlockStripes = 16;
+
+        /// default constructor
+        explicit ContentHasher();
+
+        /// hash more data
+        void Update(std::span<const byte> data);
+
+        /// get the hash of all data so far, more data can still be added
+        [[nodiscard]] Hash64 Finish() const;
+
+        /// hash data in one call
+        [[nodiscard]] static Hash64 Hash(std::span<const byte> data);
+
+    private:
+        /// accumulators
+        alignas(16) qword mAccumulators[8];
+
+        /// partial stripe
+        alignas(16) byte mBuffer[cStripeSize];
+
+        /// size of the partial stripe
+        size_t mBufferSize = 0;
+
+        /// stripe index in the current block
+        size_t mStripe = 0;
+
+        /// total size hashed
+        qword mLength = 0;
+    };
+}
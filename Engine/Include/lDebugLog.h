@@ -17,9 +17,12 @@ namespace Lumen::DebugLog
     enum class LogLevel { Detail, Info, Warning, Error, Count };
     using LogCallback = std::function<void(LogLevel level, std::string_view message)>;
 
-    /// set log callback
+    /// set log callback, it is only called on this thread, messages logged from other threads wait for Update
     void SetCallback(LogCallback callback);
 
+    /// send the messages logged from other threads to the callback, from the thread that set it
+    void Update();
+
     /// log implementation
     void LogImpl(LogLevel level, std::string_view format, std::format_args args);
 
@@ -311,3 +311,9 @@ static const bool mRegistered
 const std::string TYPE::mName = std::string(TYPE::CacheName());                                                  \
 const bool TYPE::mRegistered = TYPE::Register();                                                                 \
 bool TYPE::Register() { Lumen::SceneManager::RegisterComponentMaker(TYPE::Type(), TYPE::MakePtr); return true; }
+
+#define SERIALIZED_FIELDS(...) \
+static consteval auto SerializedFields() { return std::make_tuple(__VA_ARGS__); }
+
+#define SERIALIZED_FIELD(OWNER, MEMBER, NAME, DEFAULT) \
+Lumen::Serialized::MakeField<OWNER, decltype(OWNER::MEMBER)>(NAME, &OWNER::MEMBER, DEFAULT)
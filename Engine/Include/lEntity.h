@@ -6,6 +6,7 @@
 #pragma once
 
 #include "lSerializedData.h"
+#include "lPackedScene.h"
 #include "lObject.h"
 #include "lApplication.h"
 #include "lSceneManager.h"
@@ -40,6 +41,16 @@ namespace Lumen
         /// deserialize
         void Deserialize(const Serialized::Type &in, bool packed);
 
+        /// serialize into a packed scene
+        void Serialize(PackedScene::Writer &out) const;
+
+        /// deserialize an entity record of a packed scene, the decoded components of the record are given in order
+        void Deserialize(const PackedScene::View &in, size_t index, std::span<const Serialized::Type> components);
+
+        /// restore an entity record of a packed scene in place, only the transform and components changed since the last snapshot are deserialized
+        /// returns false without changes if the components no longer match the record
+        bool Restore(const PackedScene::View &in, size_t index);
+
         /// get application
         [[nodiscard]] Application &GetApplication();
 
@@ -55,6 +66,15 @@ namespace Lumen
         /// add a component
         [[maybe_unused]] ComponentWeakPtr AddComponent(Hash type);
 
+        /// mark the entity as changed, sets every changed mark
+        void SetDirty();
+
+        /// check if the entity, its transform or any of its components changed since a mark was last cleared
+        [[nodiscard]] bool Dirty(DirtyMark::Type mark) const;
+
+        /// clear changed marks of the entity, its transform and its components
+        void ClearDirty(DirtyMark::Type marks);
+
     protected:
         /// called on state change
         void OnState(Lumen::Application::State newState);
@@ -0,0 +1,51 @@
+//==============================================================================================================================================================================
+/// \file
+/// \brief     FileChangeCoalescer interface
+/// \copyright Copyright (c) Gustavo Goedert. All rights reserved.
+//==============================================================================================================================================================================
+#pragma once
+
+#include "lFileSystem.h"
+
+/// \cond
+#include <unordered_map>
+/// \endcond
+
+/// Lumen namespace
+namespace Lumen
+{
+    /// FileChangeCoalescer class, collects file changes and folds the ones of the same file into one, keeping the order they first arrived in
+    class FileChangeCoalescer
+    {
+        CLASS_NO_COPY_MOVE(FileChangeCoalescer);
+
+    public:
+        /// default constructor
+        explicit FileChangeCoalescer() = default;
+
+        /// add a change, coalescing it with the pending change of the same file
+        void Push(FileSystem::Change change, FileSystem::Flags flags, std::string name);
+
+        /// add a rename, a file added and renamed before being taken is just added
+        void PushRename(FileSystem::Flags flags, std::string name, std::string oldName);
+
+        /// add a file change of any kind
+        void Push(FileSystem::FileChange &&fileChange);
+
+        /// whether there are no pending changes
+        [[nodiscard]] bool Empty() const { return mBatch.empty(); }
+
+        /// move the pending changes to the end of a batch
+        void Take(std::vector<FileSystem::FileChange> &fileBatch);
+
+        /// drop the pending changes
+        void Clear();
+
+    private:
+        /// pending changes, coalesced changes have an empty name
+        std::vector<FileSystem::FileChange> mBatch;
+
+        /// index of the pending change of each name
+        std::unordered_map<std::string, size_t> mBatchIndex;
+    };
+}
@@ -0,0 +1,96 @@
+//==============================================================================================================================================================================
+/// \file
+/// \brief     FileIndex interface
+/// \copyright Copyright (c) Gustavo Goedert. All rights reserved.
+//==============================================================================================================================================================================
+#pragma once
+
+#include "lFileSystem.h"
+#include "lHash.h"
+
+/// Lumen namespace
+namespace Lumen
+{
+    /// FileIndex class, a snapshot of a folder tree kept between sessions so a startup scan only reports what changed
+    class FileIndex
+    {
+        CLASS_NO_COPY_MOVE(FileIndex);
+
+    public:
+        /// file magic, "LIDX" in little-endian
+        static constexpr dword cMagic = 0x5844494C;
+
+        /// current format version
+        static constexpr word cVersion = 2;
+
+        /// changes per reported chunk, a chunk can be larger since the changes of a folder are never split
+        static constexpr size_t cChunkSize = 1024;
+
+        /// chunk callback type, called from the scan threads one chunk at a time, so it must be quick
+        using ChunkCallback = std::function<void(std::vector<FileSystem::FileChange> &&fileBatch)>;
+
+        /// record struct
+        struct Record
+        {
+            /// path relative to the folder, with forward slashes
+            std::string mName;
+
+            /// flags
+            FileSystem::Flags mFlags;
+
+            /// size
+            qword mSize;
+
+            /// last write time, in ticks of the file clock
+            qword mTime;
+
+            /// content hash, zero until the file is seen changing
+            Hash64 mHash;
+        };
+
+        /// default constructor
+        explicit FileIndex();
+
+        /// destructor, waits for a scan in progress
+        ~FileIndex();
+
+        /// load an index, returns false and leaves the index empty if it is missing or invalid
+        bool Load(const std::filesystem::path &indexPath);
+
+        /// save the index
+        bool Save(const std::filesystem::path &indexPath) const;
+
+        /// scan a folder and report what changed since the index, then update the index to the scan
+        /// files are only hashed if their size or write time changed, and a file with the same hash is not modified
+        /// unchanged files are reported as added with the unchanged flag, so listeners can still rebuild their state
+        /// the records of a folder that cannot be listed are kept, not reported removed
+        void Update(const std::filesystem::path &folder, std::vector<FileSystem::FileChange> &fileBatch);
+
+        /// start scanning a folder on the thread pool and report what changed since the index a chunk at a time, then update the index to the scan
+        /// every folder is listed by its own task as soon as its parent is, a folder is reported before its contents and removals come last
+        /// returns at once, call Wait before saving or reading the index
+        void UpdateAsync(const std::filesystem::path &folder, ChunkCallback &&callback);
+
+        /// wait for a scan started by UpdateAsync to finish
+        void Wait();
+
+        /// number of records
+        [[nodiscard]] size_t RecordCount() const { return mRecords.size(); }
+
+    private:
+        /// walk struct, the state of a scan shared by its folder tasks
+        struct Walk;
+
+        /// list a folder of a scan, compare it to the index and queue its subfolders
+        void ScanFolder(Walk &walk, const std::string &relative);
+
+        /// report the removed records once every folder of a scan is listed, and update the index to the scan
+        void FinishWalk(Walk &walk);
+
+        /// records, sorted by name, not changed while a scan is in progress
+        std::vector<Record> mRecords;
+
+        /// scan in progress, null if none
+        std::unique_ptr<Walk> mWalk;
+    };
+}
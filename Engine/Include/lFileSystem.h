@@ -12,6 +12,8 @@
 
 /// \cond
 #include <filesystem>
+#include <functional>
+#include <span>
 /// \endcond
 
 /// Lumen namespace
@@ -20,18 +22,24 @@ namespace Lumen
     CLASS_WEAK_PTR_DEF(Engine);
     CLASS_PTR_DEF(IFileSystem);
 
-    /// FileSystem namespace
+    /// FileSystem namespace, files can be opened, read and closed from any thread, a handle is used by one thread at a time
     namespace FileSystem
     {
         /// change type
         enum class Change { Added, Modified, Renamed, Removed };
 
-        /// change flag type
-        enum class Flag : byte { None = 0x0, File = 0x1, Directory = 0x2 };
+        /// change flag type, unchanged marks files a startup scan found as they were in the last session
+        enum class Flag : byte { None = 0x0, File = 0x1, Directory = 0x2, Unchanged = 0x4 };
 
         /// change flags type
         using Flags = Lumen::Flags<Flag>;
 
+        /// durability type, durable writes are flushed to disk before replacing a file, cached writes leave it to the os
+        enum class Durability : byte { Cached, Durable };
+
+        /// suffix of files written aside, they replace the file they are named after once committed and are never reported as changes
+        constexpr std::string_view cAsideSuffix = ".tmp";
+
         /// FileEntry struct
         struct FileEntry
         {
@@ -42,6 +50,28 @@ namespace Lumen
             std::string mName;
         };
 
+        /// CacheStats struct, counters of the cache of small file contents
+        struct CacheStats
+        {
+            /// lookups that found their content
+            qword mHits = 0;
+
+            /// lookups that did not
+            qword mMisses = 0;
+
+            /// entries dropped to stay in budget
+            qword mEvictions = 0;
+
+            /// entries dropped because their file changed
+            qword mInvalidations = 0;
+
+            /// cached bytes
+            size_t mBytes = 0;
+
+            /// cached entries
+            size_t mEntries = 0;
+        };
+
         /// FileChange struct
         struct FileChange
         {
@@ -73,15 +103,33 @@ namespace Lumen
 
             /// old name
             std::string mOldName;
+
+            /// new content hash of a modified file, stored in its infofile once the change is handled, 0 if unknown
+            Hash64 mContentHash = 0;
         };
 #endif
 
+        /// serialized entry callback, receives each top level key / value of a serialized object, returns false to stop reading
+        using EntryCallback = std::function<bool(std::string_view key, Serialized::Type &value)>;
+
         /// initialize file namespace
         void Initialize(const EngineWeakPtr &engine);
 
         /// shutdown file namespace
         void Shutdown();
 
+        /// enable compression of binary data written to packed file systems, compressed data is always readable
+        void SetCompressPacked(bool compress);
+
+        /// whether binary data written to packed file systems is compressed
+        [[nodiscard]] bool CompressPacked();
+
+        /// set the budget in bytes of the cache of small file contents read by Map, zero disables it
+        void SetContentCacheBudget(size_t budget);
+
+        /// get the counters of the cache of small file contents
+        [[nodiscard]] CacheStats ContentCacheStats();
+
         /// normalize a directory path
         const std::filesystem::path NormalizeDirPath(const std::filesystem::path &dirPath);
 
@@ -103,9 +151,37 @@ namespace Lumen
         /// read serialized data from a path
         bool ReadSerializedData(const std::filesystem::path &path, Serialized::Type &data);
 
-        /// write serialized data to a path
+        /// write serialized data to a path, the file is replaced atomically
         bool WriteSerializedData(const std::filesystem::path &path, const Serialized::Type &data);
 
+        /// read the top level entries of serialized data from a path one at a time, without building the whole document
+        /// returns false if the data could not be read or the callback stopped the read
+        bool ReadSerializedEntries(const std::filesystem::path &path, const EntryCallback &callback);
+
+        /// read binary data from a path
+        bool ReadBinaryData(const std::filesystem::path &path, std::vector<byte> &data);
+
+        /// write binary data to a path, the file is replaced atomically
+        bool WriteBinaryData(const std::filesystem::path &path, std::span<const byte> data);
+
+        /// encode serialized data the way it is stored at a path
+        std::vector<byte> EncodeSerializedData(const std::filesystem::path &path, const Serialized::Type &data);
+
+        /// write a whole file atomically, readers see the old or the new file but never a partial one
+        bool WriteAtomic(const std::filesystem::path &path, std::span<const byte> data, Durability durability = Durability::Durable);
+
+        /// write a whole file aside of its path, safe to call from any thread, the file is replaced by CommitAside
+        bool WriteAside(const std::filesystem::path &path, std::span<const byte> data);
+
+        /// replace files with the files written aside of them, a durable commit flushes them to disk once for all files
+        bool CommitAside(std::span<const std::filesystem::path> paths, Durability durability);
+
+        /// append binary data to a path, the file is created if missing and appended data is never compressed
+        bool AppendBinaryData(const std::filesystem::path &path, std::span<const byte> data);
+
+        /// hash the content of a file, returns false if it cannot be read
+        bool ContentHash(const std::filesystem::path &path, Hash64 &hash);
+
         /// checks if a path is packed
         bool IsPacked(const std::filesystem::path &path);
 
@@ -121,13 +197,28 @@ namespace Lumen
         /// closes a file handle
         void Close(const Id::Type handle);
 
+        /// maps a whole file read-only, files that cannot be mapped are read into a copy, the data stays valid until the handle is closed
+        /// small files are served from a cache of their contents, dropped when the file is written or reported changed
+        Id::Type Map(const std::filesystem::path &path);
+
+        /// gets the data of a mapped file by handle
+        std::span<const byte> MappedData(const Id::Type handle);
+
+        /// reads bytes at an offset of a file without a handle, returns the bytes read or SIZE_MAX if the file cannot be read
+        /// safe to call from any thread, packed data is read as stored
+        size_t ReadAt(const std::filesystem::path &path, size_t offset, std::span<byte> buffer);
+
+        /// path of a file on the native file system, so io backends can read it themselves, empty if it is not stored as a native file
+        /// safe to call from any thread
+        std::filesystem::path NativePath(const std::filesystem::path &path);
+
         /// reads bytes from a file handle
         size_t ReadBytes(const Id::Type handle, void *buffer, const size_t size = SIZE_MAX);
 
         /// writes bytes to a file handle
         bool WriteBytes(const Id::Type handle, const void *buffer, const size_t size);
 
-        /// reads text from a file handle
+        /// reads text from a file handle, a negative line count reads to the end, line breaks are kept
         std::string ReadText(const Id::Type handle, int lineCount = -1);
 
         /// writes text to a file handle
@@ -149,7 +240,7 @@ namespace Lumen
         size_t Size(const Id::Type handle);
     };
 
-    /// FileSystem interface class
+    /// FileSystem interface class, implementations must be safe to call from many threads with different handles
     class IFileSystem
     {
         CLASS_NO_COPY_MOVE(IFileSystem);
@@ -158,6 +249,9 @@ namespace Lumen
         /// initialize file system
         virtual void Initialize() = 0;
 
+        /// shutdown file system, called by FileSystem::Shutdown for every registered file system
+        virtual void Shutdown() {}
+
         /// whether this file system is packed
         virtual bool Packed() const = 0;
 
@@ -176,18 +270,36 @@ namespace Lumen
         /// closes a file handle
         virtual void Close(const Id::Type handle) = 0;
 
+        /// maps a whole file read-only, the data stays valid until the handle is closed
+        /// returns an invalid handle if the file system cannot map the file, FileSystem::Map then reads it into a copy
+        virtual Id::Type Map(const std::filesystem::path &path, std::span<const byte> &data) { return Id::Invalid; }
+
+        /// reads bytes at an offset of a file without a handle, returns the bytes read or SIZE_MAX if the file cannot be read
+        /// called from io threads, so it must not use the state of open handles
+        virtual size_t ReadAt(const std::filesystem::path &path, size_t offset, std::span<byte> buffer) = 0;
+
+        /// path of a file on the native file system, empty if the file system does not store it as a native file
+        /// called from io threads, so it must not use the state of open handles
+        virtual std::filesystem::path NativePath(const std::filesystem::path &path) { return {}; }
+
         /// reads bytes from a file handle
         virtual size_t ReadBytes(const Id::Type handle, void *buffer, const size_t size = SIZE_MAX) = 0;
 
         /// writes bytes to a file handle
         virtual bool WriteBytes(const Id::Type handle, const void *buffer, const size_t size) = 0;
 
-        /// reads text from a file handle
+        /// reads text from a file handle, a negative line count reads to the end, line breaks are kept
         virtual std::string ReadText(const Id::Type handle, int lineCount = -1) = 0;
 
         /// writes text to a file handle
         virtual bool WriteText(const Id::Type handle, const std::string &text) = 0;
 
+        /// write a whole file aside of its path, called from any thread
+        virtual bool WriteAside(const std::filesystem::path &path, std::span<const byte> data) = 0;
+
+        /// replace files with the files written aside of them, a durable commit flushes them to disk once for all files
+        virtual bool CommitAside(std::span<const std::filesystem::path> paths, FileSystem::Durability durability) = 0;
+
         /// gets the current position in the file by handle
         virtual size_t Tell(const Id::Type handle) = 0;
 
@@ -18,11 +18,15 @@ namespace Lumen
 
     public:
         /// creates a smart pointer version of the folder file system
-        static IFileSystemPtr MakePtr(const std::filesystem::path &path);
+        /// with an index path, the folder index is saved on shutdown so the next startup only hashes files that changed
+        static IFileSystemPtr MakePtr(const std::filesystem::path &path, const std::filesystem::path &indexPath = {});
 
         /// initialize file system
         void Initialize() override;
 
+        /// shutdown file system
+        void Shutdown() override;
+
         /// whether this file system is packed
         bool Packed() const override;
 
@@ -41,6 +45,15 @@ namespace Lumen
         /// closes a file handle
         void Close(const Id::Type handle) override;
 
+        /// maps a whole file read-only, the data stays valid until the handle is closed
+        Id::Type Map(const std::filesystem::path &path, std::span<const byte> &data) override;
+
+        /// reads bytes at an offset of a file without a handle
+        size_t ReadAt(const std::filesystem::path &path, size_t offset, std::span<byte> buffer) override;
+
+        /// path of a file on the native file system
+        std::filesystem::path NativePath(const std::filesystem::path &path) override;
+
         /// reads bytes from a file handle
         size_t ReadBytes(const Id::Type handle, void *buffer, const size_t size = SIZE_MAX) override;
 
@@ -53,6 +66,12 @@ namespace Lumen
         /// writes text to a file handle
         bool WriteText(const Id::Type handle, const std::string &text) override;
 
+        /// write a whole file aside of its path, called from any thread
+        bool WriteAside(const std::filesystem::path &path, std::span<const byte> data) override;
+
+        /// replace files with the files written aside of them, a durable commit flushes them to disk once for all files
+        bool CommitAside(std::span<const std::filesystem::path> paths, FileSystem::Durability durability) override;
+
         /// gets the current position in the file by handle
         size_t Tell(const Id::Type handle) override;
 
@@ -64,7 +83,7 @@ namespace Lumen
 
     private:
         /// constructs a folder file system
-        explicit FolderFileSystem(const std::filesystem::path &path);
+        explicit FolderFileSystem(const std::filesystem::path &path, const std::filesystem::path &indexPath);
 
         /// private implementation
         CLASS_PIMPL_DEF(Impl);
@@ -0,0 +1,99 @@
+//==============================================================================================================================================================================
+/// \file
+/// \brief     HandleMap is a thread safe map of per handle state
+/// \copyright Copyright (c) Gustavo Goedert. All rights reserved.
+//==============================================================================================================================================================================
+#pragma once
+
+#include "lDefs.h"
+#include "lId.h"
+
+/// \cond
+#include <array>
+#include <mutex>
+#include <unordered_map>
+/// \endcond
+
+/// Lumen namespace
+namespace Lumen
+{
+    /// HandleMap template class, the state of each open handle split in shards so threads using different handles rarely share a lock
+    /// the state of a handle stays in place until it is erased, so it is used outside the lock by the thread owning the handle
+    template<typename T>
+    class HandleMap
+    {
+        CLASS_NO_COPY_MOVE(HandleMap);
+
+    public:
+        /// number of shards
+        static constexpr size_t cShardCount = 16;
+
+        /// default constructor
+        explicit HandleMap() = default;
+
+        /// add the state of a handle
+        template<typename... Args>
+        T &Emplace(Id::Type handle, Args &&...args)
+        {
+            Shard &shard = GetShard(handle);
+            std::lock_guard<std::mutex> lock(shard.mMutex);
+            return shard.mItems.try_emplace(handle, std::forward<Args>(args)...).first->second;
+        }
+
+        /// find the state of a handle, null if it has none
+        [[nodiscard]] T *Find(Id::Type handle)
+        {
+            Shard &shard = GetShard(handle);
+            std::lock_guard<std::mutex> lock(shard.mMutex);
+            auto it = shard.mItems.find(handle);
+            return it != shard.mItems.end() ? &it->second : nullptr;
+        }
+
+        /// checks if a handle has state
+        [[nodiscard]] bool Contains(Id::Type handle)
+        {
+            return Find(handle) != nullptr;
+        }
+
+        /// remove the state of a handle, returns false if it had none
+        bool Erase(Id::Type handle)
+        {
+            Shard &shard = GetShard(handle);
+            std::lock_guard<std::mutex> lock(shard.mMutex);
+            return shard.mItems.erase(handle) > 0;
+        }
+
+        /// call a function with every handle and its state, not while other threads use the map
+        template<typename Function>
+        void ForEach(Function &&function)
+        {
+            for (Shard &shard : mShards)
+            {
+                for (auto &[handle, item] : shard.mItems)
+                {
+                    function(handle, item);
+                }
+            }
+        }
+
+    private:
+        /// shard struct, on its own cache line
+        struct alignas(64) Shard
+        {
+            /// mutex protecting the items
+            std::mutex mMutex;
+
+            /// state by handle
+            std::unordered_map<Id::Type, T> mItems;
+        };
+
+        /// get the shard of a handle, picked by the low bits of its slot, which differ between handles generated on different threads
+        Shard &GetShard(Id::Type handle)
+        {
+            return mShards[handle % cShardCount];
+        }
+
+        /// shards
+        std::array<Shard, cShardCount> mShards;
+    };
+}
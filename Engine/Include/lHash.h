@@ -38,6 +38,24 @@ namespace Lumen
         return HashStringRange(string, 0, std::string_view(string).size());
     }
 
+    /// 64 bit hash, for large sets of keys such as file paths
+    using Hash64 = qword;
+
+    constexpr Hash64 HASH64_PRIME = static_cast<Hash64>(0x00000100000001B3);
+    constexpr Hash64 HASH64_OFFSET = static_cast<Hash64>(0xCBF29CE484222325);
+
+    /// hash (FNV-1a, 64 bit) string evaluated at compile time
+    constexpr Hash64 HashString64(std::string_view string)
+    {
+        Hash64 hash = HASH64_OFFSET;
+        for (char c : string)
+        {
+            hash ^= static_cast<byte>(c);
+            hash *= HASH64_PRIME;
+        }
+        return hash;
+    }
+
 #ifdef TYPEINFO
     /// typeinfo version of HashType
     struct HashType
@@ -7,6 +7,10 @@
 
 #include "lDefs.h"
 
+/// \cond
+#include <atomic>
+/// \endcond
+
 /// Lumen Id namespace
 namespace Lumen::Id
 {
@@ -16,7 +20,7 @@ namespace Lumen::Id
     /// invalid id
     static constexpr Type Invalid = static_cast<Type>(-1);
 
-    /// id generator class
+    /// id generator class, ids can be generated from any thread
     class Generator
     {
         CLASS_NO_COPY_MOVE(Generator);
@@ -26,10 +30,10 @@ namespace Lumen::Id
         explicit inline Generator() noexcept : mCurrent(static_cast<Type>(-1)) {}
 
         /// get next id and advance
-        [[nodiscard]] inline Type Next() noexcept { return ++mCurrent; }
+        [[nodiscard]] inline Type Next() noexcept { return mCurrent.fetch_add(1, std::memory_order_relaxed) + 1; }
 
     private:
         /// current id
-        Type mCurrent;
+        std::atomic<Type> mCurrent;
     };
 }
@@ -0,0 +1,125 @@
+//==============================================================================================================================================================================
+/// \file
+/// \brief     LockFreeQueue is a lock free multiple producer single consumer queue
+/// \copyright Copyright (c) Gustavo Goedert. All rights reserved.
+//==============================================================================================================================================================================
+#pragma once
+
+#include "lDefs.h"
+
+/// \cond
+#include <atomic>
+/// \endcond
+
+/// Lumen namespace
+namespace Lumen
+{
+    /// LockFreeQueue template class, any thread can push and a single thread pops, neither ever blocks
+    /// pushing is one exchange, so a pop can briefly miss an item whose push has not linked it yet
+    template<typename T>
+    class LockFreeQueue
+    {
+        CLASS_NO_COPY_MOVE(LockFreeQueue);
+
+    public:
+        /// default constructor
+        explicit LockFreeQueue() = default;
+
+        /// destructor, items still queued are destroyed
+        ~LockFreeQueue()
+        {
+            T item;
+            while (Pop(item))
+            {
+            }
+        }
+
+        /// push an item, from any thread
+        void Push(T &&item)
+        {
+            Link(new Node(std::move(item)));
+        }
+
+        /// pop the oldest item, only from the consumer thread
+        bool Pop(T &item)
+        {
+            Node *tail = mTail;
+            Node *next = tail->mNext.load(std::memory_order_acquire);
+
+            // skip the stub
+            if (tail == &mStub)
+            {
+                if (!next)
+                {
+                    return false;
+                }
+                mTail = next;
+                tail = next;
+                next = next->mNext.load(std::memory_order_acquire);
+            }
+            if (next)
+            {
+                mTail = next;
+                item = std::move(tail->mItem);
+                delete tail;
+                return true;
+            }
+
+            // the last node is only popped once the stub is linked behind it, unless a push is still linking
+            if (tail != mHead.load(std::memory_order_acquire))
+            {
+                return false;
+            }
+            mStub.mNext.store(nullptr, std::memory_order_relaxed);
+            Link(&mStub);
+            next = tail->mNext.load(std::memory_order_acquire);
+            if (next)
+            {
+                mTail = next;
+                item = std::move(tail->mItem);
+                delete tail;
+                return true;
+            }
+            return false;
+        }
+
+        /// whether the queue looks empty, only from the consumer thread
+        [[nodiscard]] bool Empty() const
+        {
+            return mTail == &mStub && !mStub.mNext.load(std::memory_order_acquire);
+        }
+
+    private:
+        /// node struct
+        struct Node
+        {
+            /// default constructor
+            explicit Node() = default;
+
+            /// constructs a node holding an item
+            explicit Node(T &&item) : mItem(std::move(item)) {}
+
+            /// item
+            T mItem;
+
+            /// next node, towards the newest
+            std::atomic<Node *> mNext = nullptr;
+        };
+
+        /// link a node as the newest
+        void Link(Node *node)
+        {
+            Node *previous = mHead.exchange(node, std::memory_order_acq_rel);
+            previous->mNext.store(node, std::memory_order_release);
+        }
+
+        /// stub node, keeps the queue from ever being without nodes
+        Node mStub;
+
+        /// newest node, where producers link
+        alignas(64) std::atomic<Node *> mHead = &mStub;
+
+        /// oldest node, owned by the consumer
+        alignas(64) Node *mTail = &mStub;
+    };
+}
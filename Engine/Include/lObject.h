@@ -10,6 +10,22 @@
 /// Lumen namespace
 namespace Lumen
 {
+    /// changed marks, a change sets every mark and each consumer of changes clears its own
+    namespace DirtyMark
+    {
+        /// mark bits
+        using Type = byte;
+
+        /// changed since the scene was last loaded or saved
+        constexpr Type cSave = 1 << 0;
+
+        /// changed since the last play mode snapshot
+        constexpr Type cSnapshot = 1 << 1;
+
+        /// every mark
+        constexpr Type cAll = cSave | cSnapshot;
+    }
+
     /// Object class
     class Object
     {
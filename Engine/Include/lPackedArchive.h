@@ -0,0 +1,158 @@
+//==============================================================================================================================================================================
+/// \file
+/// \brief     packed archive binary format interface
+/// \copyright Copyright (c) Gustavo Goedert. All rights reserved.
+//==============================================================================================================================================================================
+#pragma once
+
+#include "lHash.h"
+
+/// \cond
+#include <span>
+#include <string>
+#include <vector>
+/// \endcond
+
+/// Lumen PackedArchive namespace
+namespace Lumen::PackedArchive
+{
+    /// file magic, "LPAK" in little-endian
+    constexpr dword cMagic = 0x4B41504C;
+
+    /// current format version
+    constexpr word cVersion = 1;
+
+    /// alignment of the entry data, so mapped entries can be read in place
+    constexpr size_t cAlignment = 64;
+
+    /// entry flag, the data is compressed in the block compression format
+    constexpr dword cCompressedEntry = 0x1;
+
+    /// file header, followed by the entries sorted by path hash, the string table and the entry data
+    struct Header
+    {
+        /// magic
+        dword mMagic;
+
+        /// version
+        word mVersion;
+
+        /// flags, reserved
+        word mFlags;
+
+        /// number of entries
+        dword mEntryCount;
+
+        /// size of the string table
+        dword mStringsSize;
+    };
+
+    /// entry record
+    struct Entry
+    {
+        /// hash of the path
+        Hash64 mHash;
+
+        /// offset of the data, relative to the start of the file
+        qword mOffset;
+
+        /// uncompressed size
+        qword mSize;
+
+        /// stored size
+        qword mStoredSize;
+
+        /// offset of the path in the string table, paths are relative and use forward slashes
+        dword mName;
+
+        /// size of the path
+        dword mNameSize;
+
+        /// flags
+        dword mFlags;
+
+        /// reserved
+        dword mReserved;
+    };
+
+    /// checks if a buffer starts with a packed archive header
+    bool IsPackedArchive(std::span<const byte> data);
+
+    /// View class, reads a packed archive in place without copying
+    class View
+    {
+    public:
+        /// default constructor
+        explicit View() = default;
+
+        /// opens a view on a buffer, the buffer must outlive the view
+        bool Open(std::span<const byte> data);
+
+        /// number of entries
+        [[nodiscard]] size_t EntryCount() const { return mHeader ? mHeader->mEntryCount : 0; }
+
+        /// get entry record
+        [[nodiscard]] const Entry &GetEntry(size_t index) const { return mEntries[index]; }
+
+        /// find the entry of a path, a binary search on the path hash
+        [[nodiscard]] const Entry *Find(std::string_view path) const;
+
+        /// get entry path
+        [[nodiscard]] std::string_view Name(const Entry &entry) const { return std::string_view(mStrings + entry.mName, entry.mNameSize); }
+
+        /// get entry data as stored
+        [[nodiscard]] std::span<const byte> Data(const Entry &entry) const { return mData.subspan(entry.mOffset, entry.mStoredSize); }
+
+    private:
+        /// header
+        const Header *mHeader = nullptr;
+
+        /// entry records
+        const Entry *mEntries = nullptr;
+
+        /// string table
+        const char *mStrings = nullptr;
+
+        /// data
+        std::span<const byte> mData;
+    };
+
+    /// Writer class, builds a packed archive
+    class Writer
+    {
+        CLASS_NO_COPY_MOVE(Writer);
+
+    public:
+        /// default constructor
+        explicit Writer() = default;
+
+        /// add a file, compressed data is only kept if it gets smaller
+        void AddFile(std::string_view path, std::span<const byte> data, bool compress);
+
+        /// number of files added
+        [[nodiscard]] size_t FileCount() const { return mFiles.size(); }
+
+        /// build the packed archive, returns an empty buffer if two paths are the same
+        [[nodiscard]] std::vector<byte> Finish() const;
+
+    private:
+        /// file struct
+        struct File
+        {
+            /// path
+            std::string mPath;
+
+            /// stored data
+            std::vector<byte> mData;
+
+            /// uncompressed size
+            size_t mSize;
+
+            /// flags
+            dword mFlags;
+        };
+
+        /// files
+        std::vector<File> mFiles;
+    };
+}
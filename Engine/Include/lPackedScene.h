@@ -0,0 +1,308 @@
+//==============================================================================================================================================================================
+/// \file
+/// \brief     packed scene binary format interface
+/// \copyright Copyright (c) Gustavo Goedert. All rights reserved.
+//==============================================================================================================================================================================
+#pragma once
+
+#include "lHash.h"
+
+/// \cond
+#include <span>
+#include <string_view>
+#include <vector>
+/// \endcond
+
+/// Lumen PackedScene namespace
+namespace Lumen::PackedScene
+{
+    /// file magic, "LSCN" in little-endian
+    constexpr dword cMagic = 0x4E43534C;
+
+    /// current format version
+    constexpr word cVersion = 1;
+
+    /// alignment of every table in the file
+    constexpr size_t cAlignment = 4;
+
+    /// journal entry magic, "LJRN" in little-endian
+    constexpr dword cJournalMagic = 0x4E524A4C;
+
+    /// extension of scenes stored packed on any file system, lets folder file system scenes use the packed format and its journal
+    constexpr std::string_view cExtension = ".lumenpack";
+
+    /// file header, all offsets are relative to the start of the file
+    struct Header
+    {
+        /// magic
+        dword mMagic;
+
+        /// version
+        word mVersion;
+
+        /// flags, reserved
+        word mFlags;
+
+        /// total size of the file
+        dword mSize;
+
+        /// number of entity and transform records
+        dword mEntityCount;
+
+        /// number of component records
+        dword mComponentCount;
+
+        /// number of component type records
+        dword mTypeCount;
+
+        /// entity table offset
+        dword mEntitiesOffset;
+
+        /// transform table offset
+        dword mTransformsOffset;
+
+        /// component table offset
+        dword mComponentsOffset;
+
+        /// component type table offset
+        dword mTypesOffset;
+
+        /// component indices sorted by type offset
+        dword mTypeComponentsOffset;
+
+        /// string table offset
+        dword mStringsOffset;
+
+        /// string table size
+        dword mStringsSize;
+
+        /// component blob area offset
+        dword mBlobsOffset;
+
+        /// component blob area size
+        dword mBlobsSize;
+    };
+
+    /// entity record, the transform record with the same index belongs to this entity
+    struct EntityRecord
+    {
+        /// name offset in the string table
+        dword mNameOffset;
+
+        /// name size
+        dword mNameSize;
+
+        /// first component record
+        dword mFirstComponent;
+
+        /// number of component records
+        dword mComponentCount;
+    };
+
+    /// fixed size transform record
+    struct TransformRecord
+    {
+        /// position
+        float mPosition[3];
+
+        /// rotation quaternion
+        float mRotation[4];
+
+        /// scale
+        float mScale[3];
+    };
+
+    /// component record
+    struct ComponentRecord
+    {
+        /// component type
+        Hash mType;
+
+        /// owning entity record
+        dword mEntity;
+
+        /// blob offset in the blob area
+        dword mBlobOffset;
+
+        /// blob size
+        dword mBlobSize;
+    };
+
+    /// component type record, indexes a range of the type sorted component indices
+    struct TypeRecord
+    {
+        /// component type
+        Hash mType;
+
+        /// first index in the type sorted component indices
+        dword mFirst;
+
+        /// number of components of this type
+        dword mCount;
+    };
+
+    /// journal entry header, followed by the base entity index of every journaled entity and a packed scene holding them
+    struct JournalHeader
+    {
+        /// magic
+        dword mMagic;
+
+        /// number of journaled entities
+        dword mEntityCount;
+
+        /// total size of the entry
+        dword mSize;
+
+        /// low half of the content hash of the scene the entry applies to, split so the header stays dword aligned
+        dword mBaseLow;
+
+        /// high half of the content hash of the scene the entry applies to
+        dword mBaseHigh;
+
+        /// content hash of the scene the entry applies to
+        [[nodiscard]] Hash64 Base() const { return (Hash64(mBaseHigh) << 32) | mBaseLow; }
+    };
+
+    /// checks if a buffer starts with a packed scene header
+    bool IsPackedScene(std::span<const byte> data);
+
+    /// View class, reads a packed scene in place without copying
+    class View
+    {
+    public:
+        /// default constructor
+        explicit View() = default;
+
+        /// opens a view on a buffer, the buffer must outlive the view
+        bool Open(std::span<const byte> data);
+
+        /// number of entities
+        [[nodiscard]] size_t EntityCount() const { return mHeader ? mHeader->mEntityCount : 0; }
+
+        /// get entity record
+        [[nodiscard]] const EntityRecord &Entity(size_t index) const { return mEntities[index]; }
+
+        /// get entity name
+        [[nodiscard]] std::string_view Name(size_t index) const;
+
+        /// get entity transform record
+        [[nodiscard]] const TransformRecord &Transform(size_t index) const { return mTransforms[index]; }
+
+        /// number of components
+        [[nodiscard]] size_t ComponentCount() const { return mHeader ? mHeader->mComponentCount : 0; }
+
+        /// get component record
+        [[nodiscard]] const ComponentRecord &Component(size_t index) const { return mComponents[index]; }
+
+        /// get component blob
+        [[nodiscard]] std::span<const byte> Blob(const ComponentRecord &component) const;
+
+        /// find the indices of all component records of a type
+        [[nodiscard]] std::span<const dword> FindComponents(Hash type) const;
+
+    private:
+        /// header
+        const Header *mHeader = nullptr;
+
+        /// entity records
+        const EntityRecord *mEntities = nullptr;
+
+        /// transform records
+        const TransformRecord *mTransforms = nullptr;
+
+        /// component records
+        const ComponentRecord *mComponents = nullptr;
+
+        /// component type records
+        const TypeRecord *mTypes = nullptr;
+
+        /// component indices sorted by type
+        const dword *mTypeComponents = nullptr;
+
+        /// string table
+        const char *mStrings = nullptr;
+
+        /// blob area
+        const byte *mBlobs = nullptr;
+    };
+
+    /// Writer class, builds a packed scene
+    class Writer
+    {
+        CLASS_NO_COPY_MOVE(Writer);
+
+    public:
+        /// default constructor
+        explicit Writer() = default;
+
+        /// add an entity, following components belong to it
+        void AddEntity(std::string_view name, const TransformRecord &transform);
+
+        /// add a component to the last added entity
+        void AddComponent(Hash type, std::span<const byte> blob);
+
+        /// append the entities and components of another writer, so parts of a scene can be written in parallel
+        void Append(const Writer &other);
+
+        /// number of entities added
+        [[nodiscard]] size_t EntityCount() const { return mEntities.size(); }
+
+        /// build the packed scene
+        [[nodiscard]] std::vector<byte> Finish() const;
+
+        /// build a journal entry replacing the base entities at the given indices, one per added entity
+        /// base is the content hash of the scene the entry applies to, so a journal left next to a newer scene is not applied
+        [[nodiscard]] std::vector<byte> FinishJournalEntry(std::span<const dword> entities, Hash64 base) const;
+
+    private:
+        /// entity records
+        std::vector<EntityRecord> mEntities;
+
+        /// transform records
+        std::vector<TransformRecord> mTransforms;
+
+        /// component records
+        std::vector<ComponentRecord> mComponents;
+
+        /// string table
+        std::string mStrings;
+
+        /// blob area
+        std::vector<byte> mBlobs;
+    };
+
+    /// Journal class, reads the entries appended to a packed scene journal in place
+    class Journal
+    {
+    public:
+        /// journal entry
+        struct Entry
+        {
+            /// base entity index of every entity in the scene
+            std::span<const dword> mEntities;
+
+            /// packed scene holding the journaled entities
+            View mScene;
+        };
+
+        /// default constructor
+        explicit Journal() = default;
+
+        /// opens a journal of the scene with the base content hash on a buffer, the buffer must outlive the journal
+        /// reading stops at the first invalid entry or one written for another scene, a torn append leaves the entries before it readable
+        bool Open(std::span<const byte> data, Hash64 base);
+
+        /// size of the valid entries
+        [[nodiscard]] size_t Size() const { return mSize; }
+
+        /// journal entries, in append order
+        [[nodiscard]] std::span<const Entry> Entries() const { return mEntries; }
+
+    private:
+        /// entries
+        std::vector<Entry> mEntries;
+
+        /// size of the valid entries
+        size_t mSize = 0;
+    };
+}
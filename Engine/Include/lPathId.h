@@ -0,0 +1,94 @@
+//==============================================================================================================================================================================
+/// \file
+/// \brief     PathId interface
+/// \copyright Copyright (c) Gustavo Goedert. All rights reserved.
+//==============================================================================================================================================================================
+#pragma once
+
+#include "lDefs.h"
+
+/// \cond
+#include <compare>
+#include <filesystem>
+#include <string>
+#include <string_view>
+/// \endcond
+
+/// Lumen namespace
+namespace Lumen
+{
+    /// PathId class, an interned normalized path, compared and hashed by its id
+    /// each normalized path is stored once in a global table for the whole run, with its parent, file name and extension found when interned
+    /// interning and reading are safe from any thread, and the strings of a path never move
+    class PathId
+    {
+    public:
+        /// id type
+        using Type = dword;
+
+        /// default constructor, the empty path
+        constexpr PathId() = default;
+
+        /// intern a path, spellings that normalize the same give the same id
+        [[nodiscard]] static PathId Intern(std::string_view path);
+
+        /// intern a path, spellings that normalize the same give the same id
+        [[nodiscard]] static PathId Intern(const std::filesystem::path &path);
+
+        /// intern a path, spellings that normalize the same give the same id
+        [[nodiscard]] static PathId Intern(const std::string &path) { return Intern(std::string_view(path)); }
+
+        /// intern a path, spellings that normalize the same give the same id
+        [[nodiscard]] static PathId Intern(const char *path) { return Intern(std::string_view(path)); }
+
+        /// number of interned paths
+        [[nodiscard]] static size_t Count();
+
+        /// get the id
+        [[nodiscard]] constexpr Type Value() const { return mValue; }
+
+        /// whether this is not the empty path
+        [[nodiscard]] constexpr bool Valid() const { return mValue != 0; }
+
+        /// get the normalized path, with forward slashes
+        [[nodiscard]] std::string_view String() const;
+
+        /// get the parent path, empty if it has none
+        [[nodiscard]] PathId Parent() const;
+
+        /// get the file name, the last element of the path
+        [[nodiscard]] std::string_view Filename() const;
+
+        /// get the file name without its extension
+        [[nodiscard]] std::string_view Stem() const;
+
+        /// get the extension of the file name with its dot, empty if it has none
+        [[nodiscard]] std::string_view Extension() const;
+
+        /// make a filesystem path
+        [[nodiscard]] std::filesystem::path Path() const;
+
+        /// equality
+        [[nodiscard]] constexpr bool operator==(const PathId &other) const = default;
+
+        /// ordering, by id and not by path
+        [[nodiscard]] constexpr auto operator<=>(const PathId &other) const = default;
+
+    private:
+        /// constructs a path id from its value
+        explicit constexpr PathId(Type value) : mValue(value) {}
+
+        /// id, zero is the empty path
+        Type mValue = 0;
+    };
+}
+
+/// hash of a path id, its value
+template<>
+struct std::hash<Lumen::PathId>
+{
+    size_t operator()(const Lumen::PathId &pathId) const noexcept
+    {
+        return pathId.Value();
+    }
+};
@@ -27,6 +27,9 @@ namespace Lumen
         /// deserialize
         void Deserialize(const Serialized::Type &in, bool packed) override;
 
+        /// every setter marks the component as changed
+        [[nodiscard]] bool TracksChanges() const override { return true; }
+
         /// render
         void Render();
 
@@ -15,6 +15,7 @@ namespace Lumen
     CLASS_PTR_DEF(Scene);
     CLASS_WEAK_PTR_DEF(Scene);
     CLASS_PTR_DEF(Application);
+    CLASS_WEAK_PTR_DEF(Entity);
 
     /// Scene class
     class Scene : public Asset
@@ -24,6 +25,18 @@ namespace Lumen
         OBJECT_TYPEINFO;
 
     public:
+#ifdef EDITOR
+        /// play mode snapshot of a scene
+        struct Snapshot
+        {
+            /// captured entities in the packed scene format
+            std::vector<byte> mData;
+
+            /// captured entity of every record, restored in place while it still exists
+            std::vector<EntityWeakPtr> mEntities;
+        };
+#endif
+
         /// destructor
         ~Scene() override;
 
@@ -51,6 +64,20 @@ namespace Lumen
         /// release scene
         void Release() override;
 
+        /// number of entities in the scene
+        [[nodiscard]] size_t EntityCount() const;
+
+        /// get entity by index, in scene order
+        [[nodiscard]] EntityWeakPtr GetEntity(size_t index) const;
+
+#ifdef EDITOR
+        /// capture a play mode snapshot
+        void CaptureSnapshot(Snapshot &out);
+
+        /// restore a play mode snapshot, only entities changed since the capture are deserialized and only missing ones are created
+        bool RestoreSnapshot(const Snapshot &in);
+#endif
+
     private:
         /// constructor
         explicit Scene(Lumen::Application &application, const std::filesystem::path &path);
@@ -7,8 +7,13 @@
 
 #include "lHash.h"
 #include "lUUID.h"
+#include "lMath.h"
+#include "lPathId.h"
 
 /// \cond
+#include <bit>
+#include <span>
+#include <tuple>
 #include <nlohmann/json.hpp>
 /// \endcond
 
@@ -25,79 +30,61 @@ namespace Lumen
         extern const std::string cUUIDToken;
 
         /// UUID token packed
-        extern const Hash cUUIDTokenPacked;
+        inline constexpr Hash cUUIDTokenPacked = HashString("UUID");
 
         /// type token
         extern const std::string cTypeToken;
 
         /// type token packed
-        extern const Hash cTypeTokenPacked;
+        inline constexpr Hash cTypeTokenPacked = HashString("Type");
 
         /// transform token
         extern const std::string cTransformToken;
 
         /// transform token packed
-        extern const Hash cTransformTokenPacked;
+        inline constexpr Hash cTransformTokenPacked = HashString("Transform");
 
         /// components token
         extern const std::string cComponentsToken;
 
         /// components token packed
-        extern const Hash cComponentsTokenPacked;
-
-        /// position token
-        extern const std::string cPositionToken;
-
-        /// position token packed
-        extern const Hash cPositionTokenPacked;
-
-        /// rotation token
-        extern const std::string cRotationToken;
-
-        /// rotation token packed
-        extern const Hash cRotationTokenPacked;
-
-        /// scale token
-        extern const std::string cScaleToken;
-
-        /// scale token packed
-        extern const Hash cScaleTokenPacked;
-
-        /// background color token
-        extern const std::string cBackgroundColorToken;
-
-        /// background color token packed
-        extern const Hash cBackgroundColorTokenPacked;
+        inline constexpr Hash cComponentsTokenPacked = HashString("Components");
 
         /// mesh type token
         extern const std::string cMeshTypeToken;
 
         /// mesh type token packed
-        extern const Hash cMeshTypeTokenPacked;
+        inline constexpr Hash cMeshTypeTokenPacked = HashString("Lumen::Mesh");
 
         /// material type token
         extern const std::string cMaterialTypeToken;
 
         /// material type token packed
-        extern const Hash cMaterialTypeTokenPacked;
+        inline constexpr Hash cMaterialTypeTokenPacked = HashString("Lumen::Material");
 
         /// properties token
         extern const std::string cPropertiesToken;
 
         /// properties token packed
-        extern const Hash cPropertiesTokenPacked;
+        inline constexpr Hash cPropertiesTokenPacked = HashString("Properties");
 
         /// texture type token
         extern const std::string cTextureTypeToken;
 
         /// texture type token packed
-        extern const Hash cTextureTypeTokenPacked;
+        inline constexpr Hash cTextureTypeTokenPacked = HashString("Lumen::Texture");
 
         /// shader type token
         extern const std::string cShaderTypeToken;
 
         /// shader type token packed
-        extern const Hash cShaderTypeTokenPacked;
+        inline constexpr Hash cShaderTypeTokenPacked = HashString("Lumen::Shader");
+
+        /// content hash token
+        extern const std::string cContentHashToken;
+
+        /// content hash token packed
+        inline constexpr Hash cContentHashTokenPacked = HashString("ContentHash");
 
         /// serialized value
         inline void SerializeValue(Type &out, bool packed, const std::string &key, const Hash &keyPacked, const Type &value)
@@ -193,5 +180,351 @@ namespace Lumen
             }
             return false;
         }
+
+        /// serialize floats, packed data is stored as a raw little-endian float block
+        void SerializeFloats(Type &out, bool packed, const std::string &key, const Hash &keyPacked, std::span<const float> values);
+
+        /// deserialize floats into a destination without allocating, accepts float blocks and number arrays
+        bool DeserializeFloats(const Type &value, std::span<float> values);
+
+        /// serialize vector3
+        inline void SerializeVector3(Type &out, bool packed, const std::string &key, const Hash &keyPacked, const Math::Vector3 &vector)
+        {
+            const float values[] = { vector.x, vector.y, vector.z };
+            SerializeFloats(out, packed, key, keyPacked, values);
+        }
+
+        /// deserialize vector3
+        inline bool DeserializeVector3(const Type &value, Math::Vector3 &vector)
+        {
+            float values[3];
+            if (!DeserializeFloats(value, values))
+            {
+                return false;
+            }
+            vector = Math::Vector3 { values };
+            return true;
+        }
+
+        /// serialize vector4
+        inline void SerializeVector4(Type &out, bool packed, const std::string &key, const Hash &keyPacked, const Math::Vector4 &vector)
+        {
+            const float values[] = { vector.x, vector.y, vector.z, vector.w };
+            SerializeFloats(out, packed, key, keyPacked, values);
+        }
+
+        /// deserialize vector4
+        inline bool DeserializeVector4(const Type &value, Math::Vector4 &vector)
+        {
+            float values[4];
+            if (!DeserializeFloats(value, values))
+            {
+                return false;
+            }
+            vector = Math::Vector4 { values };
+            return true;
+        }
+
+        /// serialize quaternion
+        inline void SerializeQuaternion(Type &out, bool packed, const std::string &key, const Hash &keyPacked, const Math::Quaternion &quaternion)
+        {
+            const float values[] = { quaternion.x, quaternion.y, quaternion.z, quaternion.w };
+            SerializeFloats(out, packed, key, keyPacked, values);
+        }
+
+        /// deserialize quaternion
+        inline bool DeserializeQuaternion(const Type &value, Math::Quaternion &quaternion)
+        {
+            float values[4];
+            if (!DeserializeFloats(value, values))
+            {
+                return false;
+            }
+            quaternion = Math::Quaternion { values };
+            return true;
+        }
+
+        /// serialize matrix44, row major
+        inline void SerializeMatrix44(Type &out, bool packed, const std::string &key, const Hash &keyPacked, const Math::Matrix44 &matrix)
+        {
+            SerializeFloats(out, packed, key, keyPacked, std::span<const float>(*matrix, 16));
+        }
+
+        /// deserialize matrix44, row major
+        inline bool DeserializeMatrix44(const Type &value, Math::Matrix44 &matrix)
+        {
+            float values[16];
+            if (!DeserializeFloats(value, values))
+            {
+                return false;
+            }
+            matrix = Math::Float44 { values };
+            return true;
+        }
+
+        /// Reader class, indexes the keys of a serialized object once so fields can be found without rescanning
+        class Reader
+        {
+            CLASS_NO_DEFAULT_CTOR(Reader);
+            CLASS_NO_COPY_MOVE(Reader);
+
+        public:
+            /// constructs a reader, packed data is indexed by key hash
+            explicit Reader(const Type &in, bool packed);
+
+            /// find a value, returns null if not found
+            [[nodiscard]] const Type *Find(const std::string &key, Hash keyPacked) const;
+
+            /// read a value
+            bool Read(const std::string &key, Hash keyPacked, Type &value) const;
+
+            /// read an UUID
+            bool ReadUUID(const std::string &key, Hash keyPacked, UUID &uuid) const;
+
+        private:
+            /// indexed field
+            struct Field
+            {
+                /// key hash
+                Hash mKey;
+
+                /// value
+                const Type *mValue;
+            };
+
+            /// number of fields indexed without allocating
+            static constexpr size_t cInlineFields = 8;
+
+            /// serialized data
+            const Type &mIn;
+
+            /// packed flag
+            bool mPacked;
+
+            /// inline field storage
+            std::array<Field, cInlineFields> mInlineFields;
+
+            /// field storage when the inline storage is not enough
+            std::vector<Field> mOverflowFields;
+
+            /// fields sorted by key hash
+            std::span<Field> mFields;
+        };
+
+        /// visit all fields of a serialized object once in stored order without indexing them, calls visitor(Hash keyPacked, const Type &value)
+        template<typename Visitor>
+        void VisitObject(const Type &in, bool packed, Visitor &&visitor)
+        {
+            if (packed)
+            {
+                if (in.is_array())
+                {
+                    for (size_t i = 1; i < in.size(); i += 2)
+                    {
+                        const auto &obj = in[i - 1];
+                        if (obj.is_number_unsigned())
+                        {
+                            visitor(obj.get<Hash>(), in[i]);
+                        }
+                    }
+                }
+            }
+            else if (in.is_object())
+            {
+                for (auto it = in.begin(); it != in.end(); ++it)
+                {
+                    const std::string &key = it.key();
+                    visitor(HashStringRange(key.c_str(), 0, key.size()), it.value());
+                }
+            }
+        }
+
+        /// serialized field descriptor, binds a key to a member of OWNER and its default value
+        template<typename OWNER, typename VALUE>
+        struct Field
+        {
+            /// owner type
+            using OwnerType = OWNER;
+
+            /// value type
+            using ValueType = VALUE;
+
+            /// key
+            std::string_view mName;
+
+            /// packed key
+            Hash mNamePacked;
+
+            /// member
+            VALUE OWNER::*mMember;
+
+            /// default value, not serialized
+            VALUE mDefault;
+        };
+
+        /// make a field descriptor, the packed key is hashed at compile time
+        template<typename OWNER, typename VALUE>
+        consteval Field<OWNER, VALUE> MakeField(std::string_view name, VALUE OWNER::*member, VALUE defaultValue)
+        {
+            return { name, HashStringRange(name.data(), 0, name.size()), member, defaultValue };
+        }
+
+        /// field value traits, float block types are plain floats that can be copied as raw memory
+        template<typename VALUE>
+        struct FieldTraits
+        {
+            /// number of floats, zero for types stored as serialized values
+            static constexpr size_t cFloatCount = 0;
+        };
+
+        /// vector3 field traits
+        template<>
+        struct FieldTraits<Math::Vector3>
+        {
+            /// number of floats
+            static constexpr size_t cFloatCount = 3;
+        };
+
+        /// vector4 field traits
+        template<>
+        struct FieldTraits<Math::Vector4>
+        {
+            /// number of floats
+            static constexpr size_t cFloatCount = 4;
+        };
+
+        /// quaternion field traits
+        template<>
+        struct FieldTraits<Math::Quaternion>
+        {
+            /// number of floats
+            static constexpr size_t cFloatCount = 4;
+        };
+
+        /// matrix44 field traits
+        template<>
+        struct FieldTraits<Math::Matrix44>
+        {
+            /// number of floats
+            static constexpr size_t cFloatCount = 16;
+        };
+
+        /// serialize one field, skipped if it holds the default value
+        template<typename OWNER, typename VALUE>
+        void SerializeField(Type &out, bool packed, const OWNER &owner, const Field<OWNER, VALUE> &field)
+        {
+            const VALUE &value = owner.*field.mMember;
+            constexpr size_t floatCount = FieldTraits<VALUE>::cFloatCount;
+            if constexpr (floatCount > 0)
+            {
+                static_assert(std::is_trivially_copyable_v<VALUE> && sizeof(VALUE) == floatCount * sizeof(float));
+                if (memcmp(&value, &field.mDefault, sizeof(VALUE)) == 0)
+                {
+                    return;
+                }
+                if (packed && std::endian::native == std::endian::little)
+                {
+                    // the little-endian float block is the value memory
+                    const byte *ptr = reinterpret_cast<const byte *>(&value);
+                    out.push_back(field.mNamePacked);
+                    out.push_back(Type::binary({ ptr, ptr + sizeof(VALUE) }));
+                }
+                else
+                {
+                    SerializeFloats(out, packed, std::string(field.mName), field.mNamePacked,
+                        std::span<const float>(reinterpret_cast<const float *>(&value), floatCount));
+                }
+            }
+            else
+            {
+                if (value == field.mDefault)
+                {
+                    return;
+                }
+                if constexpr (std::is_same_v<VALUE, PathId>)
+                {
+                    SerializeValue(out, packed, std::string(field.mName), field.mNamePacked, value.String());
+                }
+                else
+                {
+                    SerializeValue(out, packed, std::string(field.mName), field.mNamePacked, value);
+                }
+            }
+        }
+
+        /// deserialize one field, returns false if the data does not match the field type
+        template<typename OWNER, typename VALUE>
+        bool DeserializeField(const Type &in, OWNER &owner, const Field<OWNER, VALUE> &field)
+        {
+            VALUE &value = owner.*field.mMember;
+            constexpr size_t floatCount = FieldTraits<VALUE>::cFloatCount;
+            if constexpr (floatCount > 0)
+            {
+                if constexpr (std::endian::native == std::endian::little)
+                {
+                    // copy the float block straight into the member
+                    if (in.is_binary() && in.get_binary().size() == sizeof(VALUE))
+                    {
+                        memcpy(&value, in.get_binary().data(), sizeof(VALUE));
+                        return true;
+                    }
+                }
+                float values[floatCount];
+                if (!DeserializeFloats(in, values))
+                {
+                    return false;
+                }
+                memcpy(&value, values, sizeof(VALUE));
+                return true;
+            }
+            else if constexpr (std::is_same_v<VALUE, PathId>)
+            {
+                // paths are stored as their normalized string
+                if (!in.is_string())
+                {
+                    return false;
+                }
+                value = PathId::Intern(in.get_ref<const std::string &>());
+                return true;
+            }
+            else
+            {
+                try
+                {
+                    in.get_to(value);
+                }
+                catch (const std::exception &)
+                {
+                    return false;
+                }
+                return true;
+            }
+        }
+
+        /// serialize the fields of an owner described by a field table
+        template<typename OWNER, typename... FIELDS>
+        void SerializeFields(Type &out, bool packed, const OWNER &owner, const std::tuple<FIELDS...> &fields)
+        {
+            std::apply([&](const auto &...field) { (SerializeField(out, packed, owner, field), ...); }, fields);
+        }
+
+        /// deserialize the fields of an owner described by a field table, walking the data once against the table
+        /// fields not present are reset to their defaults, throws if a present field cannot be read
+        template<typename OWNER, typename... FIELDS>
+        void DeserializeFields(const Type &in, bool packed, OWNER &owner, const std::tuple<FIELDS...> &fields, std::string_view ownerName)
+        {
+            std::apply([&](const auto &...field) { ((owner.*field.mMember = field.mDefault), ...); }, fields);
+            VisitObject(in, packed, [&](Hash key, const Type &value)
+            {
+                auto read = [&](const auto &field)
+                {
+                    if (key == field.mNamePacked && !DeserializeField(value, owner, field))
+                    {
+                        throw std::runtime_error(std::format("Unable to read {}::{}", ownerName, field.mName));
+                    }
+                };
+                std::apply([&](const auto &...field) { (read(field), ...); }, fields);
+            });
+        }
     }
 }
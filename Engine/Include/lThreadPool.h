@@ -0,0 +1,42 @@
+//==============================================================================================================================================================================
+/// \file
+/// \brief     thread pool interface
+/// \copyright Copyright (c) Gustavo Goedert. All rights reserved.
+//==============================================================================================================================================================================
+#pragma once
+
+#include "lDefs.h"
+
+/// \cond
+#include <functional>
+/// \endcond
+
+/// Lumen namespace
+namespace Lumen
+{
+    /// ThreadPool namespace
+    namespace ThreadPool
+    {
+        /// task function type
+        using Task = std::function<void()>;
+
+        /// parallel for body function type, called with the index of the item
+        using ForBody = std::function<void(size_t index)>;
+
+        /// initialize thread pool namespace, zero threads uses the hardware concurrency minus the calling thread
+        void Initialize(size_t threadCount = 0);
+
+        /// shutdown thread pool namespace, pending tasks are finished first
+        void Shutdown();
+
+        /// get the number of worker threads, zero if not initialized
+        [[nodiscard]] size_t ThreadCount();
+
+        /// submit a task to run on a worker thread, runs immediately if not initialized
+        void Submit(Task &&task);
+
+        /// run body for every index in [0, count), the calling thread takes part and it returns when all are done
+        /// runs serially if not initialized, the first exception thrown by body is rethrown on the calling thread
+        void ParallelFor(size_t count, const ForBody &body);
+    }
+}
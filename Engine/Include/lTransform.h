@@ -7,6 +7,7 @@
 
 #include "lMath.h"
 #include "lSerializedData.h"
+#include "lPackedScene.h"
 #include "lObject.h"
 
 /// Lumen namespace
@@ -35,6 +36,12 @@ namespace Lumen
         /// deserialize
         void Deserialize(const Serialized::Type &in, bool packed);
 
+        /// serialize to a packed scene record
+        void Serialize(PackedScene::TransformRecord &out) const;
+
+        /// deserialize from a packed scene record
+        void Deserialize(const PackedScene::TransformRecord &in);
+
         /// get owning entity
         [[nodiscard]] EntityWeakPtr Entity() const;
 
@@ -74,6 +81,12 @@ namespace Lumen
         /// get world matrix
         void GetWorldMatrix(Math::Matrix44 &world) const;
 
+        /// check if the transform changed since a mark was last cleared
+        [[nodiscard]] bool Dirty(DirtyMark::Type mark) const;
+
+        /// clear changed marks, called by the consumers of changes
+        void ClearDirty(DirtyMark::Type marks);
+
     private:
         /// constructor
         explicit Transform(const EntityWeakPtr &entity);
@@ -0,0 +1,107 @@
+//==============================================================================================================================================================================
+/// \file
+/// \brief     packed archive builder entry point
+/// \copyright Copyright (c) Gustavo Goedert. All rights reserved.
+//==============================================================================================================================================================================
+
+#include "lPackedArchive.h"
+#include "lThreadPool.h"
+
+/// \cond
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+/// \endcond
+
+using namespace Lumen;
+
+/// read a whole file
+static bool ReadWholeFile(const std::filesystem::path &path, std::vector<byte> &data)
+{
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.is_open())
+    {
+        return false;
+    }
+    data.resize(static_cast<size_t>(file.tellg()));
+    file.seekg(0, std::ios::beg);
+    return static_cast<bool>(file.read(reinterpret_cast<char *>(data.data()), data.size()));
+}
+
+/// build an archive of every file under a folder, paths are stored relative to it
+static bool Pack(const std::filesystem::path &folder, const std::filesystem::path &archivePath, bool compress)
+{
+    // sorted so the same folder always builds the same archive
+    std::vector<std::filesystem::path> paths;
+    for (const auto &entry : std::filesystem::recursive_directory_iterator(folder))
+    {
+        if (entry.is_regular_file())
+        {
+            paths.push_back(entry.path());
+        }
+    }
+    std::sort(paths.begin(), paths.end());
+
+    PackedArchive::Writer writer;
+    size_t size = 0;
+    std::vector<byte> data;
+    for (const std::filesystem::path &path : paths)
+    {
+        if (!ReadWholeFile(path, data))
+        {
+            std::cerr << std::format("Unable to read {}\n", path.string());
+            return false;
+        }
+        writer.AddFile(path.lexically_relative(folder).generic_string(), data, compress);
+        size += data.size();
+    }
+
+    std::vector<byte> archive = writer.Finish();
+    if (archive.empty())
+    {
+        return false;
+    }
+    std::ofstream file(archivePath, std::ios::binary | std::ios::trunc);
+    if (!file.write(reinterpret_cast<const char *>(archive.data()), archive.size()))
+    {
+        std::cerr << std::format("Unable to write {}\n", archivePath.string());
+        return false;
+    }
+    std::cout << std::format("{} files, {} bytes, archive {} bytes\n", writer.FileCount(), size, archive.size());
+    return true;
+}
+
+/// packer entry point, usage: Packer <folder> <archive> [--compress]
+int main(int argc, char *argv[])
+{
+    bool compress = argc > 3 && std::string_view(argv[3]) == "--compress";
+    if (argc < 3 || argc > 4 || (argc == 4 && !compress) || !std::filesystem::is_directory(argv[1]))
+    {
+        std::cerr << "usage: Packer <folder> <archive> [--compress]\n";
+        return 1;
+    }
+
+    DebugLog::SetCallback([](DebugLog::LogLevel level, std::string_view message)
+    {
+        if (level == DebugLog::LogLevel::Error)
+        {
+            std::cerr << message << '\n';
+        }
+    });
+
+    // entries are compressed in parallel blocks
+    ThreadPool::Initialize();
+    int result = 0;
+    try
+    {
+        result = Pack(argv[1], argv[2], compress) ? 0 : 1;
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << std::format("Packer failed, {}\n", e.what());
+        result = 1;
+    }
+    ThreadPool::Shutdown();
+    return result;
+}